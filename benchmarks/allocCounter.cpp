@@ -0,0 +1,59 @@
+#include "allocCounter.hpp"
+
+#include <cstdlib>
+#include <new>
+
+// Global replacements that count every heap allocation in the process.
+
+namespace alpaca::bench {
+
+std::atomic<uint64_t> gAllocations{0};
+std::atomic<uint64_t> gAllocatedBytes{0};
+
+} // namespace alpaca::bench
+
+namespace {
+
+void *Allocate(std::size_t n) {
+  alpaca::bench::gAllocations.fetch_add(1, std::memory_order_relaxed);
+  alpaca::bench::gAllocatedBytes.fetch_add(n, std::memory_order_relaxed);
+  if (void *p = std::malloc(n ? n : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void *AllocateAligned(std::size_t n, std::align_val_t al) {
+  alpaca::bench::gAllocations.fetch_add(1, std::memory_order_relaxed);
+  alpaca::bench::gAllocatedBytes.fetch_add(n, std::memory_order_relaxed);
+  const auto a = static_cast<std::size_t>(al);
+  // aligned_alloc wants a size that is a multiple of the alignment.
+  if (void *p = std::aligned_alloc(a, (n + a - 1) / a * a)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+} // namespace
+
+void *operator new(std::size_t n) { return Allocate(n); }
+void *operator new[](std::size_t n) { return Allocate(n); }
+void *operator new(std::size_t n, std::align_val_t a) {
+  return AllocateAligned(n, a);
+}
+void *operator new[](std::size_t n, std::align_val_t a) {
+  return AllocateAligned(n, a);
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <print>
+#include <string>
+#include <string_view>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+namespace alpaca::bench {
+
+// Totals kept by the operator new replacements in allocCounter.cpp.
+extern std::atomic<uint64_t> gAllocations;
+extern std::atomic<uint64_t> gAllocatedBytes;
+
+struct AllocStats {
+  double allocsPerOp{};
+  double bytesPerOp{};
+};
+
+// Average heap traffic of one call to `f`, after a warm-up call so that
+// buffers the code keeps between calls are not counted.
+template <class F> AllocStats CountAllocs(F &f, std::size_t iterations = 200) {
+  f();
+  const auto n0 = gAllocations.load(std::memory_order_relaxed);
+  const auto b0 = gAllocatedBytes.load(std::memory_order_relaxed);
+  for (std::size_t i = 0; i < iterations; ++i) {
+    f();
+  }
+  const auto n = gAllocations.load(std::memory_order_relaxed) - n0;
+  const auto b = gAllocatedBytes.load(std::memory_order_relaxed) - b0;
+  return {static_cast<double>(n) / iterations,
+          static_cast<double>(b) / iterations};
+}
+
+// Prints the allocations per call of `f`, then times it as a Catch2
+// benchmark under the same name.
+template <class F> void Measure(std::string_view name, F f) {
+  const auto a = CountAllocs(f);
+  std::println("{:<48} {:>8.1f} allocs/op {:>10.0f} B/op", name,
+               a.allocsPerOp, a.bytesPerOp);
+  BENCHMARK(std::string(name)) { return f(); };
+}
+
+} // namespace alpaca::bench
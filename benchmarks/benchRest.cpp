@@ -0,0 +1,107 @@
+#include "allocCounter.hpp"
+#include "fixtures.hpp"
+
+#include <alpaca/models/marketdata/serialize.hpp>
+#include <alpaca/models/trading/orderTemplate.hpp>
+#include <alpaca/models/trading/serialize.hpp>
+#include <alpaca/utils/utils.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+#include <glaze/glaze.hpp>
+
+#include <string>
+#include <vector>
+
+namespace {
+
+using alpaca::bench::Measure;
+
+// Decodes `json` into a fresh `T`, as HttpClient::Request does.
+template <class T> auto ReadFresh(const std::string &json) {
+  return [&json] {
+    T out{};
+    return glz::read_json(out, json);
+  };
+}
+
+// Decodes `json` into the same `T` every time, as RequestInto does.
+template <class T> auto ReadReused(const std::string &json) {
+  return [&json, out = T{}]() mutable { return glz::read_json(out, json); };
+}
+
+alpaca::OrderRequestParam LimitOrder() {
+  alpaca::OrderRequestParam r{};
+  r.symbol = "AAPL";
+  r.amt = alpaca::Quantity{100};
+  r.side = alpaca::OrderSide::buy;
+  r.type = alpaca::OrderType::limit;
+  r.timeInForce = alpaca::OrderTimeInForce::day;
+  r.limitPrice = alpaca::Decimal::Parse("187.35");
+  r.clientOrderID = "mm-000001";
+  return r;
+}
+
+} // namespace
+
+TEST_CASE("glz::read REST responses", "[rest]") {
+  const auto bars = alpaca::bench::BarsJson(5, 390);
+  const auto order = alpaca::bench::OrderJson(1);
+  const auto orders = alpaca::bench::OrdersJson(100);
+  const auto account = alpaca::bench::AccountJson();
+  const auto positions = alpaca::bench::PositionsJson(50);
+
+  Measure("Bars 5x390", ReadFresh<alpaca::Bars>(bars));
+  Measure("Bars 5x390 (Timestamp)",
+          ReadFresh<alpaca::BarsT<alpaca::Timestamp>>(bars));
+  Measure("Bars 5x390 (reused)", ReadReused<alpaca::Bars>(bars));
+  Measure("OrderResponse", ReadFresh<alpaca::OrderResponse>(order));
+  Measure("OrderResponse x100",
+          ReadFresh<std::vector<alpaca::OrderResponse>>(orders));
+  Measure("OrderResponse x100 (reused)",
+          ReadReused<std::vector<alpaca::OrderResponse>>(orders));
+  Measure("Account", ReadFresh<alpaca::Account>(account));
+  Measure("Positions x50", ReadFresh<alpaca::Positions>(positions));
+  Measure("Positions x50 (reused)",
+          ReadReused<alpaca::Positions>(positions));
+}
+
+TEST_CASE("SubmitOrder body serialization", "[rest]") {
+  const auto req = LimitOrder();
+  Measure("glz::write_json OrderRequestParam", [&req] {
+    std::string body;
+    (void)glz::write_json(req, body);
+    return body.size();
+  });
+
+  std::string reused;
+  Measure("glz::write_json OrderRequestParam (reused)", [&] {
+    (void)glz::write_json(req, reused);
+    return reused.size();
+  });
+
+  auto tmpl = alpaca::OrderTemplate::Make(req);
+  REQUIRE(tmpl.has_value());
+  alpaca::OrderPatch patch;
+  patch.qty = *alpaca::Decimal::Parse("100");
+  patch.limitPrice = *alpaca::Decimal::Parse("187.35");
+  patch.clientOrderID = "mm-000001";
+  Measure("OrderTemplate::Render",
+          [&] { return tmpl->Render(patch).size(); });
+}
+
+TEST_CASE("QueryBuilder", "[rest]") {
+  const std::vector<std::string> symbols = {"AAPL", "MSFT", "NVDA", "AMZN",
+                                            "GOOGL"};
+  // The query GetBars builds for one page.
+  Measure("QueryBuilder bars page", [&] {
+    alpaca::utils::QueryBuilder qb;
+    qb.add("symbols", alpaca::utils::SymbolsEncode(symbols));
+    qb.add("timeframe", "1Min");
+    qb.add("start", "2024-01-02T14:30:00Z");
+    qb.add("end", "2024-01-02T21:00:00Z");
+    qb.add("limit", std::to_string(10000));
+    qb.add("feed", "sip");
+    qb.add("page_token", "QUFQTHxNfDIwMjQtMDEtMDJUMjA6MDA6MDBa");
+    return qb.q.size();
+  });
+}
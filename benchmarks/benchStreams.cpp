@@ -0,0 +1,110 @@
+#include "allocCounter.hpp"
+#include "fixtures.hpp"
+
+#include <alpaca/client/marketDataStream.hpp>
+#include <alpaca/client/tradeUpdateStream.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace {
+
+using alpaca::bench::Measure;
+
+struct BenchEnvironment {
+  std::string GetID() const { return "BENCH_KEY"; }
+  std::string GetSecret() const { return "BENCH_SECRET"; }
+  std::string GetStreamDataUrl(const std::string &feed) const {
+    return "wss://stream.bench/" + feed;
+  }
+  std::string GetTradeStreamUrl() const { return "wss://trade.bench/stream"; }
+};
+
+// Keeps the stream's callbacks so frames can be fed straight to OnMessage,
+// with no socket, thread or handshake in the measurement.
+struct FakeWebSocket {
+  std::shared_ptr<alpaca::WsCallbacks> cbs =
+      std::make_shared<alpaca::WsCallbacks>();
+
+  void Connect(const std::string & /*url*/, alpaca::WsCallbacks c) {
+    *cbs = std::move(c);
+  }
+  void Disconnect() {}
+  void Send(const std::string &) {}
+  void SendBinary(const std::string &) {}
+  void SetHeader(const std::string &, const std::string &) {}
+  bool IsConnected() const { return true; }
+};
+
+using MarketStream = alpaca::MarketDataStreamT<BenchEnvironment, FakeWebSocket>;
+using TradeStream = alpaca::TradeUpdateStreamT<BenchEnvironment, FakeWebSocket>;
+
+constexpr int kBatch = 100;
+
+// Feeds `frame` to a market-data stream wired to `cbs`, `kBatch` messages
+// per call.
+void MeasureFrame(const char *name, const std::string &frame,
+                  alpaca::MarketDataCallbacks cbs) {
+  FakeWebSocket ws;
+  auto in = ws.cbs;
+  MarketStream stream(BenchEnvironment{}, std::move(ws));
+  alpaca::MarketDataSubscription sub;
+  sub.trades = sub.quotes = sub.bars = {"*"};
+  stream.Connect(std::move(sub), std::move(cbs));
+  Measure(name, [&] { in->onMessage(frame); });
+}
+
+} // namespace
+
+TEST_CASE("MarketDataStream frames of 100 messages", "[stream]") {
+  const auto trades = alpaca::bench::MarketDataFrame('t', kBatch);
+  const auto quotes = alpaca::bench::MarketDataFrame('q', kBatch);
+  const auto bars = alpaca::bench::MarketDataFrame('b', kBatch);
+
+  // Volatile sinks keep the callbacks from being optimized away.
+  [[maybe_unused]] static volatile double sink;
+  alpaca::MarketDataCallbacks views;
+  views.onTradeView = [](const alpaca::StreamTradeView &t) { sink = t.price; };
+  views.onQuoteView = [](const alpaca::StreamQuoteView &q) {
+    sink = q.bidPrice;
+  };
+  views.onBarView = [](const alpaca::StreamBarView &b) { sink = b.close; };
+
+  alpaca::MarketDataCallbacks owned;
+  owned.onTrade = [](alpaca::StreamTrade t) { sink = t.price; };
+  owned.onQuote = [](alpaca::StreamQuote q) { sink = q.bidPrice; };
+  owned.onBar = [](alpaca::StreamBar b) { sink = b.close; };
+
+  MeasureFrame("trades x100 (views)", trades, views);
+  MeasureFrame("trades x100 (owned)", trades, owned);
+  MeasureFrame("quotes x100 (views)", quotes, views);
+  MeasureFrame("quotes x100 (owned)", quotes, owned);
+  MeasureFrame("bars x100 (views)", bars, views);
+  MeasureFrame("bars x100 (owned)", bars, owned);
+}
+
+TEST_CASE("TradeUpdateStream fill frame", "[stream]") {
+  const auto frame = alpaca::bench::TradeUpdateFrame(1);
+  [[maybe_unused]] static volatile std::size_t sink;
+
+  auto run = [&](const char *name, alpaca::TradeUpdateCallbacks cbs) {
+    FakeWebSocket ws;
+    auto in = ws.cbs;
+    TradeStream stream(BenchEnvironment{}, std::move(ws));
+    stream.Connect(std::move(cbs));
+    Measure(name, [&] { in->onMessage(frame); });
+  };
+
+  alpaca::TradeUpdateCallbacks full;
+  full.onUpdate = [](alpaca::TradeUpdate u) { sink = u.order.id.size(); };
+  run("trade_updates fill (onUpdate)", std::move(full));
+
+  alpaca::TradeUpdateCallbacks lean;
+  lean.onLeanUpdate = [](alpaca::LeanTradeUpdate u) {
+    sink = u.orderID.size();
+  };
+  run("trade_updates fill (onLeanUpdate)", std::move(lean));
+}
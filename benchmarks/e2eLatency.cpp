@@ -0,0 +1,361 @@
+// Round-trip latency of the SDK against MockAlpacaServer on localhost:
+//   rest   SubmitOrder, GetAllOrders and GetBars, request to decoded result
+//   ack    SubmitOrder call to the "new" trade update for its client order id
+//   data   market-data "t" timestamp to the view callback
+//   trade  trade-update "at" timestamp to the onLeanUpdate callback
+// followed by the clients' own Instrumentation histograms for the same run.
+//
+//   alpaca_e2e_bench [--duration s] [--rest-rate req/s] [--data-rate frames/s]
+//                    [--batch msgs/frame] [--trade-rate updates/s]
+//                    [--fixtures dir] [--certs dir] [--ws-port n]
+
+#include "fixtures.hpp"
+#include "mockServer.hpp"
+
+#include <alpaca/client/marketDataClient.hpp>
+#include <alpaca/client/marketDataStream.hpp>
+#include <alpaca/client/pooledHttpClient.hpp>
+#include <alpaca/client/tradeUpdateStream.hpp>
+#include <alpaca/client/tradingClient.hpp>
+#include <alpaca/utils/latency.hpp>
+
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <print>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifndef ALPACA_BENCH_CERT_DIR
+#define ALPACA_BENCH_CERT_DIR "benchmarks/certs"
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using std::chrono::nanoseconds;
+
+struct Options {
+  double duration{5};
+  double restRate{200};
+  double dataRate{1000};
+  int batch{10};
+  double tradeRate{500};
+  std::string fixtures;
+  std::string certs{ALPACA_BENCH_CERT_DIR};
+  // 0: any free port.
+  int wsPort{0};
+};
+
+// Points every client at the mock. "localhost" matches the certificate.
+struct MockEnvironment {
+  int restPort{};
+  int wsPort{};
+
+  std::string GetID() const { return "MOCK_KEY"; }
+  std::string GetSecret() const { return "MOCK_SECRET"; }
+  std::string GetBaseUrl() const {
+    return std::format("localhost:{}", restPort);
+  }
+  std::string GetDataUrl() const { return GetBaseUrl(); }
+  httplib::Headers GetAuthHeaders() const {
+    return {{"APCA-API-KEY-ID", GetID()},
+            {"APCA-API-SECRET-KEY", GetSecret()},
+            {"Accept", "application/json"}};
+  }
+  std::string GetTradeStreamUrl() const {
+    return std::format("wss://localhost:{}/stream", wsPort);
+  }
+  std::string GetStreamDataUrl(const std::string &feed) const {
+    return std::format("wss://localhost:{}/v2/{}", wsPort, feed);
+  }
+};
+
+using Http = alpaca::PooledHttpClient;
+using Trading = alpaca::TradingClientT<MockEnvironment, Http>;
+using MarketData = alpaca::MarketDataClientT<MockEnvironment, Http>;
+using DataStream = alpaca::MarketDataStreamT<MockEnvironment>;
+using TradeStream = alpaca::TradeUpdateStreamT<MockEnvironment>;
+
+// Prints one row of percentiles, in microseconds unless `scale` says
+// otherwise.
+void PrintRow(std::string_view name, const alpaca::HistogramSnapshot &s,
+              double scale = 1e3) {
+  auto at = [&](double q) { return s.Percentile(q) / scale; };
+  std::println("{:<36} {:>8} {:>9.1f} {:>9.1f} {:>9.1f} {:>9.1f} {:>9.1f}",
+               name, s.count, at(0.5), at(0.9), at(0.99), at(0.999),
+               s.max / scale);
+}
+
+// Latencies of one path, reported as percentiles.
+class Samples {
+public:
+  void Add(nanoseconds d) { hist_.Record(d); }
+
+  void Print(std::string_view name) const { PrintRow(name, hist_.Snapshot()); }
+
+private:
+  alpaca::HdrHistogram hist_;
+};
+
+nanoseconds SinceWire(std::chrono::sys_time<nanoseconds> sent) {
+  return std::chrono::system_clock::now() - sent;
+}
+
+// Calls `f(i)` `rate` times a second for `seconds`, on schedule rather than
+// back to back, so a slow call does not lower the offered load.
+void Paced(double rate, double seconds, const std::function<void(int)> &f) {
+  const auto period = nanoseconds(static_cast<int64_t>(1e9 / rate));
+  const auto n = static_cast<int>(rate * seconds);
+  const auto start = Clock::now();
+  for (int i = 0; i < n; ++i) {
+    std::this_thread::sleep_until(start + i * period);
+    f(i);
+  }
+}
+
+bool WaitFor(const std::function<bool()> &ready) {
+  const auto deadline = Clock::now() + std::chrono::seconds(5);
+  while (!ready()) {
+    if (Clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+std::optional<Options> ParseArgs(int argc, char **argv) {
+  Options o;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    const std::string_view key = argv[i];
+    const std::string_view val = argv[i + 1];
+    auto num = [&](auto &out) {
+      auto [p, ec] = std::from_chars(val.data(), val.data() + val.size(), out);
+      return ec == std::errc{} && p == val.data() + val.size() && out > 0;
+    };
+    bool ok = true;
+    if (key == "--duration") {
+      ok = num(o.duration);
+    } else if (key == "--rest-rate") {
+      ok = num(o.restRate);
+    } else if (key == "--data-rate") {
+      ok = num(o.dataRate);
+    } else if (key == "--batch") {
+      ok = num(o.batch);
+    } else if (key == "--trade-rate") {
+      ok = num(o.tradeRate);
+    } else if (key == "--ws-port") {
+      ok = num(o.wsPort);
+    } else if (key == "--fixtures") {
+      o.fixtures = val;
+    } else if (key == "--certs") {
+      o.certs = val;
+    } else {
+      ok = false;
+    }
+    if (!ok) {
+      std::println(stderr, "bad argument: {} {}", key, val);
+      return std::nullopt;
+    }
+  }
+  if (argc % 2 == 0) {
+    std::println(stderr, "missing value for {}", argv[argc - 1]);
+    return std::nullopt;
+  }
+  return o;
+}
+
+alpaca::OrderRequestParam LimitOrder(int i) {
+  alpaca::OrderRequestParam r{};
+  r.symbol = "AAPL";
+  r.amt = alpaca::Quantity{100};
+  r.side = alpaca::OrderSide::buy;
+  r.type = alpaca::OrderType::limit;
+  r.timeInForce = alpaca::OrderTimeInForce::day;
+  r.limitPrice = alpaca::Decimal::Parse("187.35");
+  r.clientOrderID = std::format("e2e-{}", i);
+  return r;
+}
+
+Http MakeHttp(const MockEnvironment &env, const std::string &ca,
+             alpaca::Instrumentation &in) {
+  Http http(env.GetBaseUrl(), env.GetAuthHeaders(), {.poolSize = 2});
+  http.SetCACertPath(ca);
+  http.SetInstrumentation(&in);
+  return http;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const auto opts = ParseArgs(argc, argv);
+  if (!opts) {
+    return 2;
+  }
+  const auto ca = opts->certs + "/cert.pem";
+
+  alpaca::bench::MockFixtures fixtures;
+  fixtures.order = alpaca::bench::OrderJson(1);
+  fixtures.orders = alpaca::bench::OrdersJson(50);
+  fixtures.bars = alpaca::bench::BarsJson(5, 390, "");
+  fixtures.dataFrames = {alpaca::bench::MarketDataFrame('t', opts->batch)};
+  fixtures.tradeUpdate = alpaca::bench::TradeUpdateFrame(1);
+  if (!opts->fixtures.empty()) {
+    alpaca::bench::LoadFixtures(opts->fixtures, fixtures);
+  }
+  if (fixtures.dataFrames.empty()) {
+    std::println(stderr, "no market-data frames to replay");
+    return 2;
+  }
+  const auto dataFrames = fixtures.dataFrames;
+  const auto tradeUpdate = fixtures.tradeUpdate;
+
+  alpaca::bench::MockAlpacaServer server(
+      std::move(fixtures), {.certPath = ca,
+                            .keyPath = opts->certs + "/key.pem",
+                            .wsPort = opts->wsPort});
+  if (auto started = server.Start(); !started) {
+    std::println(stderr, "mock server: {}", started.error());
+    return 1;
+  }
+  const MockEnvironment env{server.RestPort(), server.WsPort()};
+
+  Samples submit, listOrders, bars, ack, data, trade;
+  alpaca::Instrumentation in;
+  std::atomic<uint64_t> dataMsgs{0}, errors{0};
+
+  // Trade stream first, so it sees the acks of the REST phase.
+  std::mutex pendingMtx;
+  std::unordered_map<std::string, Clock::time_point> pending;
+  alpaca::TradeUpdateCallbacks tcbs;
+  tcbs.onLeanUpdate = [&](const alpaca::LeanTradeUpdate &u) {
+    if (u.event == alpaca::TradeUpdateEvent::new_order) {
+      std::lock_guard lock(pendingMtx);
+      if (auto it = pending.find(u.clientOrderID); it != pending.end()) {
+        ack.Add(Clock::now() - it->second);
+        pending.erase(it);
+      }
+    } else if (auto at = alpaca::utils::ParseRfc3339Nanos(u.at)) {
+      trade.Add(SinceWire(std::chrono::sys_time<nanoseconds>{
+          nanoseconds{*at}}));
+    }
+  };
+  tcbs.onError = [&](alpaca::APIError) { ++errors; };
+  alpaca::WebSocketClient tradeWs;
+  tradeWs.SetCACertPath(ca);
+  TradeStream tradeStream(env, std::move(tradeWs));
+  tradeStream.SetInstrumentation(&in);
+  tradeStream.Connect(tcbs);
+  if (!WaitFor([&] { return server.Ready(true) > 0; })) {
+    std::println(stderr, "trade stream did not start listening");
+    return 1;
+  }
+
+  // REST.
+  Trading trading(env, MakeHttp(env, ca, in));
+  MarketData market(env, MakeHttp(env, ca, in));
+  (void)trading.GetAllOrders();
+  (void)market.GetBars({.symbols = {"AAPL"}, .timeframe = "1Min"});
+
+  Paced(opts->restRate, opts->duration, [&](int i) {
+    const auto req = LimitOrder(i);
+    const auto t0 = Clock::now();
+    {
+      std::lock_guard lock(pendingMtx);
+      pending.emplace(*req.clientOrderID, t0);
+    }
+    if (trading.SubmitOrder(req)) {
+      submit.Add(Clock::now() - t0);
+    } else {
+      ++errors;
+    }
+  });
+  Paced(opts->restRate, opts->duration / 2, [&](int) {
+    const auto t0 = Clock::now();
+    if (trading.GetAllOrders()) {
+      listOrders.Add(Clock::now() - t0);
+    } else {
+      ++errors;
+    }
+  });
+  Paced(opts->restRate, opts->duration / 2, [&](int) {
+    const auto t0 = Clock::now();
+    alpaca::BarParams p;
+    p.symbols = {"AAPL", "MSFT", "NVDA", "AMZN", "GOOGL"};
+    p.timeframe = "1Min";
+    if (market.GetBars(p)) {
+      bars.Add(Clock::now() - t0);
+    } else {
+      ++errors;
+    }
+  });
+
+  // Market data.
+  alpaca::MarketDataCallbacks dcbs;
+  auto onView = [&](const auto &v) {
+    data.Add(SinceWire(v.time.time));
+    ++dataMsgs;
+  };
+  dcbs.onTradeView = onView;
+  dcbs.onQuoteView = onView;
+  dcbs.onBarView = onView;
+  dcbs.onError = [&](alpaca::APIError) { ++errors; };
+  alpaca::WebSocketClient dataWs;
+  dataWs.SetCACertPath(ca);
+  DataStream dataStream(env, std::move(dataWs));
+  dataStream.SetInstrumentation(&in);
+  alpaca::MarketDataSubscription sub;
+  sub.trades = {"*"};
+  dataStream.Connect(sub, dcbs);
+  if (!WaitFor([&] { return server.Ready(false) > 0; })) {
+    std::println(stderr, "data stream did not subscribe");
+    return 1;
+  }
+  Paced(opts->dataRate, opts->duration, [&](int i) {
+    auto frame = dataFrames[i % dataFrames.size()];
+    alpaca::bench::ReplaceStringField(frame, "t",
+                                      alpaca::bench::NowRfc3339());
+    server.PublishData(frame);
+  });
+
+  // Trade updates.
+  Paced(opts->tradeRate, opts->duration, [&](int) {
+    auto frame = tradeUpdate;
+    alpaca::bench::ReplaceStringField(frame, "at",
+                                      alpaca::bench::NowRfc3339());
+    server.PublishTradeUpdate(frame);
+  });
+
+  // Let the last frames drain before reading the results.
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  dataStream.Disconnect();
+  tradeStream.Disconnect();
+
+  std::println("{:<36} {:>8} {:>9} {:>9} {:>9} {:>9} {:>9}", "latency (us)",
+               "n", "p50", "p90", "p99", "p99.9", "max");
+  submit.Print("rest SubmitOrder");
+  listOrders.Print("rest GetAllOrders");
+  bars.Print("rest GetBars");
+  ack.Print("ack new_order");
+  data.Print("data tick->callback");
+  trade.Print("trade at->callback");
+  std::println("\nbreakdown (us; queue depth in messages)");
+  for (const auto &[name, snap] : in.Snapshot()) {
+    PrintRow(name, snap, name.starts_with("md.queue_depth") ? 1 : 1e3);
+  }
+  std::println("data messages {} of {}, errors {}", dataMsgs.load(),
+               static_cast<uint64_t>(opts->dataRate * opts->duration) *
+                   opts->batch,
+               errors.load());
+  server.Stop();
+  return errors.load() == 0 ? 0 : 1;
+}
@@ -0,0 +1,151 @@
+#pragma once
+#include <format>
+#include <string>
+#include <string_view>
+
+// Synthetic but realistically sized payloads, shaped like Alpaca responses.
+
+namespace alpaca::bench {
+
+inline constexpr std::string_view kSymbols[] = {"AAPL", "MSFT", "NVDA", "AMZN",
+                                                "GOOGL", "META", "TSLA", "SPY"};
+
+// A full /v2/orders element, every field present as the API sends it.
+inline std::string OrderJson(int i) {
+  return std::format(
+      R"({{"id":"61e69015-8549-4bfd-b9c3-01e75843f{:03}","client_order_id":)"
+      R"("eb9e2aaa-f71a-4f51-b5b4-52a6c565d{:03}",)"
+      R"("created_at":"2024-01-02T14:30:00.123456Z",)"
+      R"("updated_at":"2024-01-02T14:30:00.223456Z",)"
+      R"("submitted_at":"2024-01-02T14:30:00.123456Z","filled_at":null,)"
+      R"("expired_at":null,"canceled_at":null,"failed_at":null,)"
+      R"("replaced_at":null,"replaced_by":null,"replaces":null,)"
+      R"("asset_id":"b0b6dd9d-8b9b-48a9-ba46-b9d54906e415",)"
+      R"("symbol":"{}","asset_class":"us_equity","notional":null,)"
+      R"("qty":"{}","filled_qty":"0","filled_avg_price":null,)"
+      R"("order_class":"","order_type":"limit","type":"limit","side":"buy",)"
+      R"("time_in_force":"day","limit_price":"187.{:02}","stop_price":null,)"
+      R"("status":"new","extended_hours":false,"legs":null,)"
+      R"("trail_percent":null,"trail_price":null,"hwm":null,)"
+      R"("subtag":null,"source":null}})",
+      i % 1000, i % 1000, kSymbols[i % 8], 1 + i % 50, i % 100);
+}
+
+inline std::string OrdersJson(int n) {
+  std::string out = "[";
+  for (int i = 0; i < n; ++i) {
+    out += (i ? "," : "") + OrderJson(i);
+  }
+  return out + "]";
+}
+
+inline std::string AccountJson() {
+  return R"({"id":"904837e3-3b76-47ec-b432-046db621571b",)"
+         R"("admin_configurations":{},"user_configurations":null,)"
+         R"("account_number":"PA3EH4PVOC1H","status":"ACTIVE",)"
+         R"("crypto_status":"ACTIVE","options_approved_level":2,)"
+         R"("options_trading_level":2,"currency":"USD",)"
+         R"("buying_power":"398012.58","regt_buying_power":"199006.29",)"
+         R"("daytrading_buying_power":"398012.58",)"
+         R"("effective_buying_power":"398012.58",)"
+         R"("non_marginable_buying_power":"99503.14",)"
+         R"("options_buying_power":"99503.14","bod_dtbp":"398012.58",)"
+         R"("cash":"99503.14","accrued_fees":"0",)"
+         R"("portfolio_value":"100492.61","pattern_day_trader":false,)"
+         R"("trading_blocked":false,"transfers_blocked":false,)"
+         R"("account_blocked":false,"created_at":"2024-01-02T14:30:00Z",)"
+         R"("trade_suspended_by_user":false,"multiplier":"4",)"
+         R"("shorting_enabled":true,"equity":"100492.61",)"
+         R"("last_equity":"100201.40","long_market_value":"989.47",)"
+         R"("short_market_value":"0","position_market_value":"989.47",)"
+         R"("initial_margin":"494.74","maintenance_margin":"296.84",)"
+         R"("last_maintenance_margin":"295.21","sma":"100210.52",)"
+         R"("daytrade_count":0,"balance_asof":"2024-01-02",)"
+         R"("crypto_tier":1,"intraday_adjustments":"0",)"
+         R"("pending_reg_taf_fees":"0"})";
+}
+
+inline std::string PositionsJson(int n) {
+  std::string out = "[";
+  for (int i = 0; i < n; ++i) {
+    out += std::format(
+        R"({}{{"asset_id":"b0b6dd9d-8b9b-48a9-ba46-b9d54906e{:03}",)"
+        R"("symbol":"{}","exchange":"NASDAQ","asset_class":"us_equity",)"
+        R"("asset_marginable":true,"qty":"{}","avg_entry_price":"150.12",)"
+        R"("side":"long","market_value":"1551.20","cost_basis":"1501.20",)"
+        R"("unrealized_pl":"50.00","unrealized_plpc":"0.0333",)"
+        R"("unrealized_intraday_pl":"10.00",)"
+        R"("unrealized_intraday_plpc":"0.0066","current_price":"155.12",)"
+        R"("lastday_price":"154.00","change_today":"0.0073",)"
+        R"("qty_available":"{}"}})",
+        i ? "," : "", i % 1000, kSymbols[i % 8], 10 + i, 10 + i);
+  }
+  return out + "]";
+}
+
+// One page of minute bars: `perSymbol` bars for each of `symbols` tickers.
+// An empty `nextPageToken` marks the last page.
+inline std::string
+BarsJson(int symbols, int perSymbol,
+         std::string_view nextPageToken =
+             "QUFQTHxNfDIwMjQtMDEtMDJUMjA6MDA6MDBa") {
+  std::string out = R"({"bars":{)";
+  for (int s = 0; s < symbols; ++s) {
+    out += std::format(R"({}"{}{}":[)", s ? "," : "", kSymbols[s % 8], s);
+    for (int i = 0; i < perSymbol; ++i) {
+      out += std::format(
+          R"({}{{"c":187.{:02},"h":187.9,"l":186.95,"n":{},"o":187.1,)"
+          R"("t":"2024-01-02T{:02}:{:02}:00Z","v":{},"vw":187.412}})",
+          i ? "," : "", i % 100, 100 + i, 14 + i / 60 % 10, i % 60,
+          12000 + i);
+    }
+    out += "]";
+  }
+  if (nextPageToken.empty()) {
+    return out + R"(},"next_page_token":null})";
+  }
+  return out + std::format(R"(}},"next_page_token":"{}"}})", nextPageToken);
+}
+
+// A market-data frame batching `n` messages of type `T` ("t", "q", "b").
+inline std::string MarketDataFrame(char type, int n) {
+  std::string out = "[";
+  for (int i = 0; i < n; ++i) {
+    const auto sym = kSymbols[i % 8];
+    const auto sep = i ? "," : "";
+    switch (type) {
+    case 't':
+      out += std::format(
+          R"({}{{"T":"t","S":"{}","i":{},"x":"V","p":187.{:02},"s":{},)"
+          R"("c":["@","I"],"z":"C","t":"2024-01-02T14:30:00.{:09}Z"}})",
+          sep, sym, 52983525029461 + i, i % 100, 1 + i % 300, i * 1000);
+      break;
+    case 'q':
+      out += std::format(
+          R"({}{{"T":"q","S":"{}","bx":"V","bp":187.{:02},"bs":{},)"
+          R"("ax":"Q","ap":187.{:02},"as":{},"c":["R"],"z":"C",)"
+          R"("t":"2024-01-02T14:30:00.{:09}Z"}})",
+          sep, sym, i % 100, 1 + i % 9, (i + 1) % 100, 1 + i % 7, i * 1000);
+      break;
+    default:
+      out += std::format(
+          R"({}{{"T":"b","S":"{}","o":187.1,"h":187.9,"l":186.95,)"
+          R"("c":187.{:02},"v":{},"n":{},"vw":187.412,)"
+          R"("t":"2024-01-02T14:{:02}:00Z"}})",
+          sep, sym, i % 100, 12000 + i, 100 + i, i % 60);
+      break;
+    }
+  }
+  return out + "]";
+}
+
+inline std::string TradeUpdateFrame(int i) {
+  return R"({"stream":"trade_updates","data":{"event":"fill",)"
+         R"("execution_id":"2bfa1c54-41b6-4d23-a8b9-f1e2c7d5a001",)"
+         R"("at":"2024-01-02T14:30:00.323456Z","price":"187.35",)"
+         R"("qty":"10","position_qty":"110","timestamp":)"
+         R"("2024-01-02T14:30:00.323456Z","order":)" +
+         OrderJson(i) + "}}";
+}
+
+} // namespace alpaca::bench
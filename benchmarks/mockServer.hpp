@@ -0,0 +1,370 @@
+#pragma once
+#include <httplib.h>
+#include <ixwebsocket/IXWebSocketServer.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstddef>
+#include <expected>
+#include <format>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// A local stand-in for the Alpaca REST and streaming endpoints, for latency
+// measurements that need no network and no account. TLS is real, with the
+// self-signed certificate in benchmarks/certs, so handshakes and record
+// encryption cost what they cost against the live service.
+
+namespace alpaca::bench {
+
+// What the mock serves. LoadFixtures() replaces any of them with a recorded
+// file.
+struct MockFixtures {
+  // POST /v2/orders response; client_order_id and the times are rewritten
+  // per request.
+  std::string order;
+  // GET /v2/orders response.
+  std::string orders;
+  // GET /v2/stocks/bars response; should be a last page (null token).
+  std::string bars;
+  // Market-data frames the harness replays, "t" restamped on send.
+  std::vector<std::string> dataFrames;
+  // trade_updates frame the harness replays, "at" restamped on send.
+  std::string tradeUpdate;
+};
+
+// Reads order.json, orders.json, bars.json, data_frames.jsonl (one frame per
+// line) and trade_update.json from `dir`; files that are missing leave the
+// field as it was.
+inline void LoadFixtures(const std::string &dir, MockFixtures &f) {
+  auto read = [&](const char *name, std::string &out) {
+    std::ifstream in(dir + "/" + name, std::ios::binary);
+    if (in) {
+      std::ostringstream ss;
+      ss << in.rdbuf();
+      out = std::move(ss).str();
+    }
+  };
+  read("order.json", f.order);
+  read("orders.json", f.orders);
+  read("bars.json", f.bars);
+  read("trade_update.json", f.tradeUpdate);
+  if (std::ifstream in(dir + "/data_frames.jsonl"); in) {
+    f.dataFrames.clear();
+    for (std::string line; std::getline(in, line);) {
+      if (!line.empty()) {
+        f.dataFrames.push_back(std::move(line));
+      }
+    }
+  }
+}
+
+// Now, as the RFC 3339 nanosecond string the streams carry.
+inline std::string NowRfc3339() {
+  return std::format("{:%FT%T}Z",
+                     std::chrono::floor<std::chrono::nanoseconds>(
+                         std::chrono::system_clock::now()));
+}
+
+// Sets every `"key":"..."` string field in `json` to `value`.
+inline void ReplaceStringField(std::string &json, std::string_view key,
+                               std::string_view value) {
+  const auto needle = std::format(R"("{}":")", key);
+  for (auto pos = json.find(needle); pos != std::string::npos;
+       pos = json.find(needle, pos)) {
+    const auto begin = pos + needle.size();
+    const auto end = json.find('"', begin);
+    if (end == std::string::npos) {
+      return;
+    }
+    json.replace(begin, end - begin, value);
+    pos = begin + value.size() + 1;
+  }
+}
+
+// The first `"key":"..."` string field of `json`.
+inline std::optional<std::string> StringField(std::string_view json,
+                                              std::string_view key) {
+  const auto needle = std::format(R"("{}":")", key);
+  const auto pos = json.find(needle);
+  if (pos == std::string_view::npos) {
+    return std::nullopt;
+  }
+  const auto begin = pos + needle.size();
+  const auto end = json.find('"', begin);
+  if (end == std::string_view::npos) {
+    return std::nullopt;
+  }
+  return std::string(json.substr(begin, end - begin));
+}
+
+// A port on `host` (IPv4) that was free a moment ago, picked by the kernel;
+// 0 if none could be had. ix::WebSocketServer cannot report the port it
+// bound to 0, so the caller binds this one and retries if it was taken in
+// between.
+inline int EphemeralPort(const std::string &host) {
+  const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return 0;
+  }
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = 0;
+  socklen_t len = sizeof(addr);
+  int port = 0;
+  if (::inet_pton(AF_INET, host.c_str(), &addr.sin_addr) == 1 &&
+      ::bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0 &&
+      ::getsockname(fd, reinterpret_cast<sockaddr *>(&addr), &len) == 0) {
+    port = ntohs(addr.sin_port);
+  }
+  ::close(fd);
+  return port;
+}
+
+struct MockServerConfig {
+  std::string certPath;
+  std::string keyPath;
+  std::string host{"127.0.0.1"};
+  // REST always listens on an ephemeral port, and so does the WebSocket
+  // server when this is 0; see RestPort() and WsPort().
+  int wsPort{0};
+};
+
+// REST: POST and GET /v2/orders, GET /v2/stocks/bars.
+// WebSocket, one port for both streams: /stream speaks the trade-update
+// protocol, any other path the market-data one. Both answer auth and
+// listen/subscribe as Alpaca does and accept any key.
+//
+// A submitted order is acknowledged over REST and, to every listening
+// trade-stream connection, with a "new" trade update for the same
+// client_order_id.
+class MockAlpacaServer {
+public:
+  MockAlpacaServer(MockFixtures fixtures, MockServerConfig cfg)
+      : fixtures_(std::move(fixtures)), cfg_(std::move(cfg)) {}
+
+  MockAlpacaServer(const MockAlpacaServer &) = delete;
+  MockAlpacaServer &operator=(const MockAlpacaServer &) = delete;
+
+  ~MockAlpacaServer() { Stop(); }
+
+  std::expected<void, std::string> Start() {
+    rest_ = std::make_unique<httplib::SSLServer>(cfg_.certPath.c_str(),
+                                                 cfg_.keyPath.c_str());
+    if (!rest_->is_valid()) {
+      return std::unexpected("cannot load " + cfg_.certPath + " / " +
+                             cfg_.keyPath);
+    }
+    Route();
+    restPort_ = rest_->bind_to_any_port(cfg_.host);
+    if (restPort_ <= 0) {
+      return std::unexpected("cannot bind the REST port");
+    }
+    restThread_ = std::thread([this] { rest_->listen_after_bind(); });
+    rest_->wait_until_ready();
+
+    // An ephemeral port can be taken by someone else between EphemeralPort()
+    // and listen(); a fixed one is tried once.
+    const int attempts = cfg_.wsPort == 0 ? 8 : 1;
+    std::string err;
+    for (int i = 0; i < attempts; ++i) {
+      wsPort_ = cfg_.wsPort != 0 ? cfg_.wsPort : EphemeralPort(cfg_.host);
+      if (wsPort_ == 0) {
+        err = "no free port";
+        continue;
+      }
+      ws_ = MakeWsServer(wsPort_);
+      auto [ok, why] = ws_->listen();
+      if (ok) {
+        ws_->start();
+        return {};
+      }
+      err = why;
+      ws_.reset();
+    }
+    return std::unexpected("cannot listen for WebSockets: " + err);
+  }
+
+  void Stop() {
+    if (ws_) {
+      ws_->stop();
+      ws_.reset();
+    }
+    if (rest_) {
+      rest_->stop();
+      if (restThread_.joinable()) {
+        restThread_.join();
+      }
+      rest_.reset();
+    }
+  }
+
+  int RestPort() const noexcept { return restPort_; }
+  // Valid once Start() succeeded.
+  int WsPort() const noexcept { return wsPort_; }
+
+  // Sends `frame` to every subscribed market-data connection; returns how
+  // many there were.
+  std::size_t PublishData(const std::string &frame) {
+    return Publish(Kind::Data, frame);
+  }
+
+  // Sends `frame` to every listening trade-update connection.
+  std::size_t PublishTradeUpdate(const std::string &frame) {
+    return Publish(Kind::Trade, frame);
+  }
+
+  // Connections that have subscribed (data) or are listening (trade).
+  std::size_t Ready(bool trade) const {
+    std::lock_guard lock(mtx_);
+    std::size_t n = 0;
+    for (const auto &[id, c] : conns_) {
+      n += c.ready && (c.kind == Kind::Trade) == trade;
+    }
+    return n;
+  }
+
+private:
+  enum class Kind { Data, Trade };
+
+  struct Connection {
+    ix::WebSocket *ws{};
+    Kind kind{Kind::Data};
+    bool ready{false};
+  };
+
+  std::unique_ptr<ix::WebSocketServer> MakeWsServer(int port) {
+    auto server = std::make_unique<ix::WebSocketServer>(port, cfg_.host);
+    ix::SocketTLSOptions tls;
+    tls.tls = true;
+    tls.certFile = cfg_.certPath;
+    tls.keyFile = cfg_.keyPath;
+    tls.caFile = "NONE";
+    server->setTLSOptions(tls);
+    server->setOnClientMessageCallback(
+        [this](std::shared_ptr<ix::ConnectionState> state, ix::WebSocket &ws,
+               const ix::WebSocketMessagePtr &msg) {
+          OnWsMessage(state->getId(), ws, msg);
+        });
+    return server;
+  }
+
+  void Route() {
+    rest_->Post("/v2/orders", [this](const httplib::Request &req,
+                                     httplib::Response &res) {
+      auto order = fixtures_.order;
+      if (auto id = StringField(req.body, "client_order_id")) {
+        ReplaceStringField(order, "client_order_id", *id);
+      }
+      const auto now = NowRfc3339();
+      for (const auto *key : {"created_at", "updated_at", "submitted_at"}) {
+        ReplaceStringField(order, key, now);
+      }
+      PublishTradeUpdate(std::format(
+          R"({{"stream":"trade_updates","data":{{"event":"new",)"
+          R"("at":"{}","timestamp":"{}","order":{}}}}})",
+          now, now, order));
+      res.set_content(std::move(order), "application/json");
+    });
+    rest_->Get("/v2/orders",
+               [this](const httplib::Request &, httplib::Response &res) {
+                 res.set_content(fixtures_.orders, "application/json");
+               });
+    rest_->Get("/v2/stocks/bars",
+               [this](const httplib::Request &, httplib::Response &res) {
+                 res.set_content(fixtures_.bars, "application/json");
+               });
+  }
+
+  void OnWsMessage(const std::string &id, ix::WebSocket &ws,
+                   const ix::WebSocketMessagePtr &msg) {
+    std::lock_guard lock(mtx_);
+    switch (msg->type) {
+    case ix::WebSocketMessageType::Open: {
+      const bool trade = msg->openInfo.uri == "/stream";
+      conns_[id] = Connection{&ws, trade ? Kind::Trade : Kind::Data};
+      if (!trade) {
+        ws.sendText(R"([{"T":"success","msg":"connected"}])");
+      }
+      break;
+    }
+    case ix::WebSocketMessageType::Message:
+      if (auto it = conns_.find(id); it != conns_.end()) {
+        Reply(it->second, msg->str);
+      }
+      break;
+    case ix::WebSocketMessageType::Close:
+      conns_.erase(id);
+      break;
+    default:
+      break;
+    }
+  }
+
+  // Answers the handshake messages of either protocol. Called with mtx_
+  // held.
+  static void Reply(Connection &c, std::string req) {
+    const bool auth = req.find(R"("action":"auth")") != std::string::npos;
+    if (c.kind == Kind::Trade) {
+      if (auth) {
+        c.ws->sendText(R"({"stream":"authorization","data":)"
+                       R"({"status":"authorized","action":"authenticate"}})");
+      } else if (req.find(R"("action":"listen")") != std::string::npos) {
+        c.ready = true;
+        c.ws->sendText(
+            R"({"stream":"listening","data":{"streams":["trade_updates"]}})");
+      }
+      return;
+    }
+    if (auth) {
+      c.ws->sendText(R"([{"T":"success","msg":"authenticated"}])");
+      return;
+    }
+    // Confirm exactly what was asked for.
+    constexpr std::string_view kSubscribe = R"("action":"subscribe")";
+    if (const auto pos = req.find(kSubscribe); pos != std::string::npos) {
+      req.replace(pos, kSubscribe.size(), R"("T":"subscription")");
+      c.ready = true;
+      c.ws->sendText("[" + req + "]");
+    }
+  }
+
+  std::size_t Publish(Kind kind, const std::string &frame) {
+    std::lock_guard lock(mtx_);
+    std::size_t n = 0;
+    for (auto &[id, c] : conns_) {
+      if (c.kind == kind && c.ready) {
+        c.ws->sendText(frame);
+        ++n;
+      }
+    }
+    return n;
+  }
+
+  const MockFixtures fixtures_;
+  const MockServerConfig cfg_;
+
+  std::unique_ptr<httplib::SSLServer> rest_;
+  std::thread restThread_;
+  int restPort_{0};
+  int wsPort_{0};
+
+  std::unique_ptr<ix::WebSocketServer> ws_;
+  mutable std::mutex mtx_;
+  std::map<std::string, Connection> conns_;
+};
+
+} // namespace alpaca::bench
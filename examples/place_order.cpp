@@ -19,7 +19,11 @@ int main(int argc, char **argv) {
 
   const std::string symbol = argv[1];
   const std::string side_s = argv[2];
-  const long double qty = std::stold(argv[3]);
+  const auto qty = Decimal::Parse(argv[3]);
+  if (!qty) {
+    std::println("Invalid quantity '{}'.", argv[3]);
+    return 2;
+  }
 
   OrderSide side{};
   if (side_s == "buy")
@@ -33,7 +37,7 @@ int main(int argc, char **argv) {
 
   OrderRequestParam r{};
   r.symbol = symbol;
-  r.amt = Quantity{qty};
+  r.amt = Quantity{*qty};
   r.side = side;
   r.type = OrderType::market;
   r.timeInForce = OrderTimeInForce::day;
@@ -44,7 +48,7 @@ int main(int argc, char **argv) {
   if (!has_yes_flag(argc, argv)) {
     std::println("Dry-run (no order sent). Add --yes to submit.");
     std::println("Would submit: symbol={} side={} qty={}", r.symbol,
-                 ToString(r.side).value_or("?"), qty);
+                 ToString(r.side).value_or("?"), *qty);
     return 0;
   }
 
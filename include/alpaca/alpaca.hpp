@@ -1,5 +1,10 @@
 #pragma once
+#include <alpaca/client/accountStateCache.hpp>
+#include <alpaca/client/asyncExecutor.hpp>
 #include <alpaca/client/marketDataClient.hpp>
 #include <alpaca/client/marketDataStream.hpp>
+#include <alpaca/client/orderStateCache.hpp>
+#include <alpaca/client/requestScheduler.hpp>
+#include <alpaca/client/shardedMarketDataStream.hpp>
 #include <alpaca/client/tradingClient.hpp>
 #include <alpaca/client/tradeUpdateStream.hpp>
@@ -0,0 +1,366 @@
+#pragma once
+#include <alpaca/client/httpClient.hpp>
+#include <alpaca/models/common/decimal.hpp>
+#include <alpaca/models/streaming/tradeupdate.hpp>
+#include <alpaca/models/trading/account.hpp>
+#include <alpaca/models/trading/position.hpp>
+#include <alpaca/utils/seqLock.hpp>
+#include <alpaca/utils/symbolTable.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+namespace alpaca {
+
+// The account totals pre-trade checks read on every order.
+struct AccountFunds {
+  Decimal cash{};
+  Decimal buyingPower{};
+  uint64_t fillsSinceReconcile{};
+};
+
+// The per-symbol part of a position pre-trade checks read; zero when flat.
+struct PositionSize {
+  Decimal qty{};
+  Decimal avgEntryPrice{};
+};
+
+// One immutable picture of the account. `account` and the market fields of
+// each position (marketValue, unrealizedPL, currentPrice, ...) are as of the
+// last reconcile; qty, avgEntryPrice, costBasis, side, cash and buyingPower
+// also include every fill applied since.
+struct AccountState {
+  std::shared_ptr<const Account> account;
+  Decimal cash{};
+  Decimal buyingPower{};
+  // Positions are immutable and shared between snapshots.
+  std::unordered_map<std::string, std::shared_ptr<const Position>,
+                     SymbolHash, std::equal_to<>>
+      positions;
+  std::chrono::system_clock::time_point reconciledAt{};
+  uint64_t fillsSinceReconcile{};
+
+  const Position *Find(std::string_view symbol) const {
+    auto it = positions.find(symbol);
+    return it == positions.end() ? nullptr : it->second.get();
+  }
+
+  // Signed position size; zero when flat.
+  Decimal Qty(std::string_view symbol) const {
+    const auto *p = Find(symbol);
+    return p ? p->qty : Decimal{};
+  }
+};
+
+// Positions, cash and buying power kept in memory for pre-trade checks.
+// Reconcile() loads them over REST; Apply() moves them with each fill from
+// the trade-update stream; ReconcileEvery() repeats the REST load on a
+// background thread to correct drift.
+//
+// Funds() and Size() are the hot-path reads: each is a seqlock copy that
+// takes no lock and never waits for a writer, and reads a consistent value
+// of its own (not across symbols). Snapshot() returns the full picture with
+// every Position; it takes the writer lock briefly and rebuilds the map of
+// shared positions after each change, so it is for reporting rather than
+// per-order checks.
+//
+// A fill replaces the node of its own position only; cash and buying power
+// move by the fill notional, which is exact for cash and an estimate for
+// margin buying power until the next reconcile.
+class AccountStateCache {
+public:
+  using StatePtr = std::shared_ptr<const AccountState>;
+
+  // Symbols with an id below `maxSymbols` in `symbols` have a lock-free
+  // Size(); the rest are only in Snapshot().
+  explicit AccountStateCache(std::size_t maxSymbols = std::size_t{1} << 14,
+                             SymbolTable &symbols = SymbolTable::Global())
+      : symbols_(&symbols), maxSymbols_(maxSymbols),
+        sizes_(std::make_unique<SeqLock<PositionSize>[]>(maxSymbols)) {}
+
+  AccountStateCache(const AccountStateCache &) = delete;
+  AccountStateCache &operator=(const AccountStateCache &) = delete;
+
+  ~AccountStateCache() { StopReconcile(); }
+
+  AccountFunds Funds() const noexcept { return funds_.Load(); }
+
+  // Position in the symbol `id` of Symbols(); nullopt when `id` is at or
+  // above maxSymbols.
+  std::optional<PositionSize> Size(SymbolId id) const noexcept {
+    if (id >= maxSymbols_) {
+      return std::nullopt;
+    }
+    return sizes_[id].Load();
+  }
+
+  SymbolTable &Symbols() const noexcept { return *symbols_; }
+
+  StatePtr Snapshot() const {
+    std::lock_guard lock(writeMtx_);
+    if (!snapshot_) {
+      auto s = std::make_shared<AccountState>();
+      const auto funds = funds_.Load();
+      s->account = account_;
+      s->cash = funds.cash;
+      s->buyingPower = funds.buyingPower;
+      s->fillsSinceReconcile = funds.fillsSinceReconcile;
+      s->positions = positions_;
+      s->reconciledAt = reconciledAt_;
+      snapshot_ = std::move(s);
+    }
+    return snapshot_;
+  }
+
+  // Replaces the state with GetAccount() and GetAllOpenPositions() from
+  // `trading` (a TradingClientT). Fills that arrive while the requests are
+  // in flight are replayed on top, except those the REST position already
+  // includes: a symbol's fills up to the last one whose position_qty equals
+  // the REST qty. Cash and buying power may miss them until the next
+  // reconcile. A racing fill without position_qty cannot be placed before
+  // or after the REST read, so it is not replayed and is counted in
+  // UnreplayedFills(); Alpaca sends position_qty with every fill.
+  template <class Client>
+  std::expected<std::monostate, APIError> Reconcile(Client &trading) {
+    std::lock_guard reconciling(reconcileMtx_);
+    {
+      std::lock_guard lock(writeMtx_);
+      journal_.clear();
+      journaling_ = true;
+    }
+    auto account = trading.GetAccount();
+    auto positions = account ? trading.GetAllOpenPositions()
+                             : std::expected<Positions, APIError>{};
+    std::lock_guard lock(writeMtx_);
+    journaling_ = false;
+    if (!account) {
+      return std::unexpected(account.error());
+    }
+    if (!positions) {
+      return std::unexpected(positions.error());
+    }
+
+    PositionMap next;
+    for (auto &p : *positions) {
+      auto symbol = p.symbol;
+      next.insert_or_assign(std::move(symbol),
+                            std::make_shared<const Position>(std::move(p)));
+    }
+    for (const auto &[symbol, p] : positions_) {
+      if (!next.contains(symbol)) {
+        PublishSize(symbol, {});
+      }
+    }
+    positions_ = std::move(next);
+    for (const auto &[symbol, p] : positions_) {
+      PublishSize(symbol, {p->qty, p->avgEntryPrice});
+    }
+    // Per symbol, the index of the first fill REST does not include.
+    std::unordered_map<std::string_view, std::size_t, SymbolHash,
+                       std::equal_to<>>
+        replayFrom;
+    for (std::size_t i = 0; i < journal_.size(); ++i) {
+      const auto &fill = journal_[i];
+      if (fill.positionQty && *fill.positionQty == Qty(fill.symbol)) {
+        replayFrom.insert_or_assign(fill.symbol, i + 1);
+      }
+    }
+    for (std::size_t i = 0; i < journal_.size(); ++i) {
+      const auto &fill = journal_[i];
+      if (!fill.positionQty) {
+        unreplayed_.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+      auto from = replayFrom.find(fill.symbol);
+      if (from == replayFrom.end() || i >= from->second) {
+        ApplyFill(fill, nullptr);
+      }
+    }
+    journal_.clear();
+
+    funds_.Store({account->cash, account->buying_power, 0});
+    account_ = std::make_shared<const Account>(std::move(*account));
+    reconciledAt_ = std::chrono::system_clock::now();
+    snapshot_.reset();
+    return std::monostate{};
+  }
+
+  // Applies one trade-update event; only fill and partial_fill change the
+  // state. Returns whether it did.
+  bool Apply(const TradeUpdate &update) {
+    if ((update.event != TradeUpdateEvent::fill &&
+         update.event != TradeUpdateEvent::partial_fill) ||
+        !update.price || !update.qty || !update.order.symbol) {
+      return false;
+    }
+    Fill fill{*update.order.symbol, update.order.side, *update.price,
+              *update.qty, update.positionQty};
+
+    std::lock_guard lock(writeMtx_);
+    if (journaling_) {
+      journal_.push_back(fill);
+    }
+    auto funds = funds_.Load();
+    ApplyFill(fill, &funds);
+    ++funds.fillsSinceReconcile;
+    funds_.Store(funds);
+    snapshot_.reset();
+    return true;
+  }
+
+  // Fills without position_qty that raced a reconcile and were left out of
+  // its result; the next reconcile picks them up.
+  uint64_t UnreplayedFills() const noexcept {
+    return unreplayed_.load(std::memory_order_relaxed);
+  }
+
+  // Calls Reconcile(trading) every `interval` on a background thread until
+  // StopReconcile() or destruction. `trading` must outlive the cache.
+  // Failures go to `onError`; the previous state stays in place.
+  template <class Client>
+  void ReconcileEvery(Client &trading, std::chrono::milliseconds interval,
+                      std::function<void(APIError)> onError = {}) {
+    StopReconcile();
+    std::lock_guard lock(workerMtx_);
+    stop_ = false;
+    worker_ = std::thread([this, &trading, interval,
+                           onError = std::move(onError)] {
+      std::unique_lock lock(workerMtx_);
+      while (!cv_.wait_for(lock, interval, [this] { return stop_; })) {
+        lock.unlock();
+        auto r = Reconcile(trading);
+        if (!r && onError) {
+          onError(r.error());
+        }
+        lock.lock();
+      }
+    });
+  }
+
+  void StopReconcile() {
+    {
+      std::lock_guard lock(workerMtx_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    if (worker_.joinable()) {
+      worker_.join();
+    }
+  }
+
+private:
+  using PositionMap =
+      std::unordered_map<std::string, std::shared_ptr<const Position>,
+                         SymbolHash, std::equal_to<>>;
+
+  struct Fill {
+    std::string symbol;
+    OrderSide side;
+    Decimal price;
+    Decimal qty;
+    std::optional<Decimal> positionQty;
+  };
+
+  static Decimal Abs(Decimal d) noexcept { return d < Decimal{} ? -d : d; }
+
+  // Called with writeMtx_ held, as are the helpers below.
+  Decimal Qty(std::string_view symbol) const {
+    auto it = positions_.find(symbol);
+    return it == positions_.end() ? Decimal{} : it->second->qty;
+  }
+
+  void PublishSize(std::string_view symbol, const PositionSize &size) {
+    const auto id = symbols_->Intern(symbol);
+    if (id < maxSymbols_) {
+      sizes_[id].Store(size);
+    }
+  }
+
+  // Moves one position by a fill, and `funds` with it when given, and
+  // publishes a new node for that position only. position_qty, when the
+  // server sent it, is the new size.
+  void ApplyFill(const Fill &f, AccountFunds *funds) {
+    const auto delta = f.side == OrderSide::buy ? f.qty : -f.qty;
+    auto it = positions_.find(f.symbol);
+    Position p;
+    if (it != positions_.end()) {
+      p = *it->second;
+    } else {
+      p.symbol = f.symbol;
+    }
+    const auto before = p.qty;
+    const auto after = f.positionQty ? *f.positionQty : before + delta;
+
+    const auto zero = Decimal{};
+    const bool adds = before == zero || (before < zero) == (delta < zero);
+    if (adds) {
+      const auto size = Abs(before) + Abs(delta);
+      p.avgEntryPrice =
+          (Abs(before) * p.avgEntryPrice + Abs(delta) * f.price) / size;
+    } else if (Abs(delta) > Abs(before)) {
+      // Flipped through flat: the remainder opened at the fill price.
+      p.avgEntryPrice = f.price;
+    }
+
+    if (funds) {
+      const auto notional = f.qty * f.price;
+      funds->cash += f.side == OrderSide::buy ? -notional : notional;
+      funds->buyingPower +=
+          Abs(after) > Abs(before) ? -notional : notional;
+    }
+
+    if (after == zero) {
+      if (it != positions_.end()) {
+        positions_.erase(it);
+      }
+      PublishSize(f.symbol, {});
+      return;
+    }
+    p.qty = after;
+    p.qtyAvailable = after;
+    p.side = after < zero ? "short" : "long";
+    p.costBasis = after * p.avgEntryPrice;
+    PublishSize(f.symbol, {p.qty, p.avgEntryPrice});
+    auto node = std::make_shared<const Position>(std::move(p));
+    if (it != positions_.end()) {
+      it->second = std::move(node);
+    } else {
+      positions_.emplace(f.symbol, std::move(node));
+    }
+  }
+
+  SymbolTable *symbols_;
+  const std::size_t maxSymbols_;
+  std::unique_ptr<SeqLock<PositionSize>[]> sizes_;
+  SeqLock<AccountFunds> funds_;
+
+  std::mutex reconcileMtx_;
+  mutable std::mutex writeMtx_;
+  std::shared_ptr<const Account> account_;
+  PositionMap positions_;
+  std::chrono::system_clock::time_point reconciledAt_{};
+  mutable StatePtr snapshot_;
+  bool journaling_{false};
+  std::vector<Fill> journal_;
+  std::atomic<uint64_t> unreplayed_{0};
+
+  std::mutex workerMtx_;
+  std::condition_variable cv_;
+  bool stop_{true};
+  std::thread worker_;
+};
+
+} // namespace alpaca
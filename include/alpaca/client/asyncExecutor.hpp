@@ -0,0 +1,86 @@
+#pragma once
+#include <alpaca/client/httpClient.hpp>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <expected>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace alpaca {
+
+template <class T> using AsyncResult = std::future<std::expected<T, APIError>>;
+
+// Small fixed-size I/O pool. Client calls submitted here run concurrently, so
+// independent round-trips overlap instead of adding up. Real overlap needs a
+// transport that allows concurrent requests (PooledHttpClient); HttpClient
+// stays correct but serializes on its single connection.
+class AsyncExecutor {
+public:
+  explicit AsyncExecutor(std::size_t threads = 4) {
+    if (threads == 0) {
+      threads = 1;
+    }
+    workers_.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i) {
+      workers_.emplace_back([this] { Run(); });
+    }
+  }
+
+  AsyncExecutor(const AsyncExecutor &) = delete;
+  AsyncExecutor &operator=(const AsyncExecutor &) = delete;
+
+  // Drains already-submitted work before joining.
+  ~AsyncExecutor() {
+    {
+      std::lock_guard lock(mtx_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+  }
+
+  template <class F>
+  std::future<std::invoke_result_t<std::decay_t<F> &>> Submit(F &&f) {
+    using R = std::invoke_result_t<std::decay_t<F> &>;
+    std::packaged_task<R()> task(std::forward<F>(f));
+    auto fut = task.get_future();
+    {
+      std::lock_guard lock(mtx_);
+      tasks_.emplace_back(std::move(task));
+    }
+    cv_.notify_one();
+    return fut;
+  }
+
+  std::size_t Size() const noexcept { return workers_.size(); }
+
+private:
+  void Run() {
+    while (true) {
+      std::move_only_function<void()> task;
+      {
+        std::unique_lock lock(mtx_);
+        cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+        if (tasks_.empty()) {
+          return;
+        }
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+      }
+      task();
+    }
+  }
+
+  std::mutex mtx_;
+  std::condition_variable cv_;
+  std::deque<std::move_only_function<void()>> tasks_;
+  bool stop_{false};
+  // Declared last so workers are joined before the queue is destroyed.
+  std::vector<std::jthread> workers_;
+};
+
+} // namespace alpaca
@@ -1,13 +1,27 @@
 #pragma once
 #include <alpaca/client/environment.hpp>
+#include <alpaca/utils/latency.hpp>
+#include <alpaca/utils/symbolTable.hpp>
 #include <alpaca/utils/utils.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
 #include <expected>
 #include <format>
+#include <functional>
 #include <glaze/glaze.hpp>
 #include <httplib.h>
+#include <memory>
 #include <optional>
 #include <print>
+#include <shared_mutex>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <variant>
 
 namespace alpaca {
 
@@ -43,107 +57,423 @@ enum class Req {
   PATCH,
 };
 
-class HttpClient {
+// Invoked with every response the transport receives (any status), before it
+// is decoded. Used by layers that track server-side state such as rate limits.
+// The body of a GET response is not included; see detail::ResponseBuffer.
+// An observer must not issue a GET on the calling thread: that would overwrite
+// the buffer the response being observed is about to be decoded from.
+using ResponseObserver = std::function<void(const httplib::Response &)>;
+
+namespace detail {
+
+inline std::string to_string(httplib::Error e) noexcept {
+  switch (e) {
+  case httplib::Error::Success:
+    return "Success";
+  case httplib::Error::Unknown:
+    return "Unknown";
+  case httplib::Error::Connection:
+    return "Connection";
+  case httplib::Error::BindIPAddress:
+    return "BindIPAddress";
+  case httplib::Error::Read:
+    return "Read";
+  case httplib::Error::Write:
+    return "Write";
+  case httplib::Error::ExceedRedirectCount:
+    return "ExceedRedirectCount";
+  case httplib::Error::Canceled:
+    return "Canceled";
+  case httplib::Error::SSLConnection:
+    return "SSLConnection";
+  case httplib::Error::SSLLoadingCerts:
+    return "SSLLoadingCerts";
+  case httplib::Error::SSLServerVerification:
+    return "SSLServerVerification";
+  default:
+    return std::format("Error({})", static_cast<int>(e));
+  }
+}
+
+struct HostPort {
+  std::string host;
+  int port{443};
+};
+
+// Splits "host" or "host:port", so a base URL can name a local server such
+// as the benchmark mock. The port defaults to 443.
+inline HostPort SplitHostPort(std::string_view s) {
+  const auto colon = s.rfind(':');
+  if (colon == std::string_view::npos || colon + 1 == s.size()) {
+    return {std::string(s)};
+  }
+  int port = 0;
+  const auto *end = s.data() + s.size();
+  auto [ptr, ec] = std::from_chars(s.data() + colon + 1, end, port);
+  if (ec != std::errc{} || ptr != end) {
+    return {std::string(s)};
+  }
+  return {std::string(s.substr(0, colon)), port};
+}
+
+// Per-thread buffer that GET response bodies are read into. It keeps its
+// capacity between requests, so a polling loop does not allocate a fresh
+// body string for every response.
+inline std::string &ResponseBuffer() noexcept {
+  thread_local std::string buf;
+  return buf;
+}
+
+// Capacity ResponseBuffer() may keep once a response has been decoded. A
+// single large reply (a full order history, say) would otherwise pin its
+// memory on that thread for good.
+inline constexpr std::size_t kResponseBufferCap = 1 << 20;
+
+// Called after the body in `sink` has been decoded.
+inline void TrimResponseBuffer(std::string *sink) noexcept {
+  if (sink && sink->capacity() > kResponseBufferCap) {
+    sink->clear();
+    sink->shrink_to_fit();
+  }
+}
+
+// Where the body of a `type` request ends up: ResponseBuffer() for GET, the
+// httplib response otherwise.
+inline std::string *BodySink(Req type) noexcept {
+  return type == Req::GET ? &ResponseBuffer() : nullptr;
+}
+
+// Issues one request on an already-established client (httplib::SSLClient,
+// or a stand-in with the same methods). Shared by every transport so they
+// agree on argument validation and method dispatch. With a `sink`, a GET body
+// is streamed into it instead of the response, and `firstByte`, when given,
+// is set as its first bytes arrive.
+template <class Client>
+std::expected<httplib::Result, APIError>
+Send(Client &cli, const httplib::Headers &headers, Req type,
+     const std::string &path, std::optional<std::string_view> body,
+     const std::optional<std::string> &content_type,
+     std::string *sink = nullptr,
+     std::chrono::steady_clock::time_point *firstByte = nullptr) noexcept {
+  if (!cli.is_valid()) {
+    return std::unexpected(APIError{
+        ErrorCode::InvalidClient,
+        "SSLClient is not valid (bad host/port or SSL init failed)."});
+  }
+
+  switch (type) {
+  case Req::GET:
+    if (sink) {
+      sink->clear();
+      return cli.Get(path, headers,
+                     [sink, firstByte](const char *data, std::size_t len) {
+                       if (firstByte && sink->empty()) {
+                         *firstByte = std::chrono::steady_clock::now();
+                       }
+                       sink->append(data, len);
+                       return true;
+                     });
+    }
+    return cli.Get(path, headers);
+  case Req::POST:
+    if (!body || !content_type) {
+      return std::unexpected(APIError{ErrorCode::IllArgument,
+                                      "POST requires body and content_type"});
+    }
+    return cli.Post(path, headers, body->data(), body->size(), *content_type);
+  case Req::DELETE:
+    return cli.Delete(path, headers);
+  case Req::PATCH:
+    if (!body || !content_type) {
+      return std::unexpected(APIError{ErrorCode::IllArgument,
+                                      "PATCH requires body and content_type"});
+    }
+    return cli.Patch(path, headers, body->data(), body->size(),
+                     *content_type);
+  }
+
+  return std::unexpected(APIError{ErrorCode::IllArgument, "Unknown Req"});
+}
+
+// Maps a transport result onto the SDK error model and decodes the body
+// (`sink` if Send() streamed it there) into `out`. Decoding into an existing
+// object reuses its vectors' and strings' capacity.
+template <typename T>
+std::expected<std::monostate, APIError>
+DecodeInto(const httplib::Result &resp, const std::string *sink,
+           T &out) noexcept {
+  if (!resp) {
+    return std::unexpected(
+        APIError{ErrorCode::Transport, to_string(resp.error())});
+  }
+
+  const std::string &body = sink ? *sink : resp->body;
+  if (!utils::IsSuccess(resp->status)) {
+    return std::unexpected(APIError{ErrorCode::HTTPCode, body, resp->status});
+  }
+
+  if (body.empty()) {
+    out = T{};
+    return std::monostate{};
+  }
+
+  auto error = glz::read_json(out, body);
+  if (error) {
+    return std::unexpected(APIError{ErrorCode::JSONParsing,
+                                    glz::format_error(error, body),
+                                    resp->status});
+  }
+
+  return std::monostate{};
+}
+
+template <typename T>
+std::expected<T, APIError> Decode(const httplib::Result &resp,
+                                  const std::string *sink = nullptr) noexcept {
+  T obj;
+  if (auto r = DecodeInto(resp, sink, obj); !r) {
+    return std::unexpected(std::move(r.error()));
+  }
+  return obj;
+}
+
+inline std::string_view MethodName(Req type) noexcept {
+  switch (type) {
+  case Req::GET:
+    return "GET";
+  case Req::POST:
+    return "POST";
+  case Req::DELETE:
+    return "DELETE";
+  case Req::PATCH:
+    return "PATCH";
+  }
+  return "?";
+}
+
+// Collections addressed by symbol, as in "/v2/positions/AAPL".
+inline constexpr std::array<std::string_view, 2> kSymbolCollections{
+    "/positions", "/assets"};
+
+// Writes "GET /v2/orders/:id" for "/v2/orders/<uuid>?nested=true" and
+// "DELETE /v2/positions/:symbol" for "/v2/positions/AAPL" into `out`: the
+// query is dropped and ids and symbols are folded, so each endpoint gets one
+// set of histograms.
+inline void EndpointName(std::string &out, Req type, std::string_view path) {
+  path = path.substr(0, path.find('?'));
+  out.assign(MethodName(type));
+  out.push_back(' ');
+  std::string_view parent;
+  while (!path.empty()) {
+    const auto next = path.find('/', 1);
+    const auto seg = path.substr(0, next);
+    const bool id = seg.size() > 32 && seg.find('-') != std::string_view::npos;
+    const bool symbol = std::ranges::find(kSymbolCollections, parent) !=
+                        kSymbolCollections.end();
+    out.append(id ? "/:id" : symbol ? "/:symbol" : seg);
+    parent = seg;
+    path.remove_prefix(seg.size());
+  }
+}
+
+inline std::string EndpointName(Req type, std::string_view path) {
+  std::string out;
+  EndpointName(out, type, path);
+  return out;
+}
+
+// The per-endpoint histograms one client records into, resolved once. The
+// endpoint name is folded into a per-thread buffer that keeps its capacity,
+// so after the first request to an endpoint, finding its histograms takes a
+// shared lock and a hash lookup but no allocation.
+class EndpointMetrics {
+public:
+  enum Metric { kRequest, kRequestCold, kFirstByte, kParse, kScheduleWait };
+
+  class Endpoint {
+  public:
+    Endpoint(Instrumentation &in, std::string name)
+        : in_(&in), name_(std::move(name)) {}
+
+    // Created in the registry on first use.
+    HdrHistogram &Get(Metric m) {
+      auto &slot = hists_[m];
+      if (auto *h = slot.load(std::memory_order_acquire)) {
+        return *h;
+      }
+      auto &h = in_->Histogram(std::format("{} {}", kNames[m], name_));
+      slot.store(&h, std::memory_order_release);
+      return h;
+    }
+
+  private:
+    static constexpr std::string_view kNames[] = {
+        "http.request", "http.request_cold", "http.first_byte", "http.parse",
+        "http.schedule_wait"};
+
+    Instrumentation *in_;
+    std::string name_;
+    std::array<std::atomic<HdrHistogram *>, std::size(kNames)> hists_{};
+  };
+
+  explicit EndpointMetrics(Instrumentation &in) noexcept : in_(&in) {}
+
+  Endpoint &Find(Req type, std::string_view path) {
+    thread_local std::string name;
+    EndpointName(name, type, path);
+    {
+      std::shared_lock lock(mtx_);
+      if (auto it = endpoints_.find(name); it != endpoints_.end()) {
+        return it->second;
+      }
+    }
+    std::unique_lock lock(mtx_);
+    return endpoints_.try_emplace(name, *in_, name).first->second;
+  }
+
 private:
-  static std::string to_string(httplib::Error e) noexcept {
-    switch (e) {
-    case httplib::Error::Success:
-      return "Success";
-    case httplib::Error::Unknown:
-      return "Unknown";
-    case httplib::Error::Connection:
-      return "Connection";
-    case httplib::Error::BindIPAddress:
-      return "BindIPAddress";
-    case httplib::Error::Read:
-      return "Read";
-    case httplib::Error::Write:
-      return "Write";
-    case httplib::Error::ExceedRedirectCount:
-      return "ExceedRedirectCount";
-    case httplib::Error::Canceled:
-      return "Canceled";
-    case httplib::Error::SSLConnection:
-      return "SSLConnection";
-    case httplib::Error::SSLLoadingCerts:
-      return "SSLLoadingCerts";
-    case httplib::Error::SSLServerVerification:
-      return "SSLServerVerification";
-    default:
-      return std::format("Error({})", static_cast<int>(e));
+  Instrumentation *in_;
+  std::shared_mutex mtx_;
+  std::unordered_map<std::string, Endpoint, SymbolHash, std::equal_to<>>
+      endpoints_;
+};
+
+// Phases of one request for EndpointMetrics; does nothing without one.
+// Records, under "<metric> <method> <path>":
+//   http.request       send to response received, on a reused connection
+//   http.request_cold  the same when a connection (TCP and TLS) was opened
+//   http.first_byte    send to the first body bytes (GET only)
+//   http.parse         JSON decoding of the body
+class RequestTiming {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit RequestTiming(EndpointMetrics *in) noexcept : in_(in) {}
+
+  template <class Client> void Start(const Client &cli) noexcept {
+    if (in_) {
+      cold_ = !cli.is_socket_open();
+      start_ = Clock::now();
+    }
+  }
+
+  Clock::time_point *FirstByte() noexcept {
+    return in_ ? &firstByte_ : nullptr;
+  }
+
+  void Received() noexcept {
+    if (in_) {
+      received_ = Clock::now();
+    }
+  }
+
+  void Parsed(Req type, std::string_view path) {
+    if (!in_) {
+      return;
+    }
+    const auto parsed = Clock::now();
+    auto &endpoint = in_->Find(type, path);
+    endpoint.Get(cold_ ? EndpointMetrics::kRequestCold
+                       : EndpointMetrics::kRequest)
+        .Record(received_ - start_);
+    if (firstByte_ != Clock::time_point{}) {
+      endpoint.Get(EndpointMetrics::kFirstByte).Record(firstByte_ - start_);
     }
+    endpoint.Get(EndpointMetrics::kParse).Record(parsed - received_);
   }
 
+private:
+  EndpointMetrics *in_;
+  bool cold_{false};
+  Clock::time_point start_{};
+  Clock::time_point firstByte_{};
+  Clock::time_point received_{};
+};
+
+} // namespace detail
+
+class HttpClient {
 public:
   explicit HttpClient(const std::string &host,
                       const httplib::Headers &headers) noexcept
-      : cli_(host), headers_(headers) {}
+      : HttpClient(detail::SplitHostPort(host), headers) {}
 
   template <typename T>
   std::expected<T, APIError>
   Request(Req type, const std::string &path,
-          std::optional<std::string> body = std::nullopt,
+          std::optional<std::string_view> body = std::nullopt,
           std::optional<std::string> content_type = std::nullopt) noexcept {
-    if (!cli_.is_valid()) {
-      return std::unexpected(APIError{
-          ErrorCode::InvalidClient,
-          "SSLClient is not valid (bad host/port or SSL init failed)."});
-    }
-
-    httplib::Result resp;
-    switch (type) {
-    case Req::GET:
-      resp = cli_.Get(path, headers_);
-      break;
-    case Req::POST:
-      if (!body || !content_type) {
-        return std::unexpected(
-            alpaca::APIError{alpaca::ErrorCode::IllArgument,
-                             "POST requires body and content_type"});
-      }
-      resp = cli_.Post(path, headers_, *body, *content_type);
-      break;
-    case Req::DELETE:
-      resp = cli_.Delete(path, headers_);
-      break;
-    case Req::PATCH:
-      if (!body || !content_type) {
-        return std::unexpected(
-            alpaca::APIError{alpaca::ErrorCode::IllArgument,
-                             "PATCH requires body and content_type"});
-      }
-      resp = cli_.Patch(path, headers_, *body, *content_type);
-      break;
-    }
-
+    auto *sink = detail::BodySink(type);
+    detail::RequestTiming timing(metrics_.get());
+    auto resp = Exchange(type, path, body, content_type, sink, timing);
     if (!resp) {
-      return std::unexpected(
-          APIError{ErrorCode::Transport, to_string(resp.error())});
+      return std::unexpected(resp.error());
     }
+    auto out = detail::Decode<T>(*resp, sink);
+    detail::TrimResponseBuffer(sink);
+    timing.Parsed(type, path);
+    return out;
+  }
 
-    if (!utils::IsSuccess(resp->status)) {
-      return std::unexpected(
-          APIError{ErrorCode::HTTPCode, resp->body, resp->status});
+  // Like Request<T>, but decodes into `out` so a caller polling the same
+  // endpoint keeps reusing its vectors and strings. Fields absent from the
+  // response keep their previous values (Alpaca sends every field, with null
+  // for empty ones). `out` is unspecified after an error.
+  template <typename T>
+  std::expected<std::monostate, APIError>
+  RequestInto(T &out, Req type, const std::string &path,
+              std::optional<std::string_view> body = std::nullopt,
+              std::optional<std::string> content_type = std::nullopt) noexcept {
+    auto *sink = detail::BodySink(type);
+    detail::RequestTiming timing(metrics_.get());
+    auto resp = Exchange(type, path, body, content_type, sink, timing);
+    if (!resp) {
+      return std::unexpected(resp.error());
     }
+    auto done = detail::DecodeInto(*resp, sink, out);
+    detail::TrimResponseBuffer(sink);
+    timing.Parsed(type, path);
+    return done;
+  }
 
-    if (resp->body.empty()) {
-      return T{};
-    }
+  void SetResponseObserver(ResponseObserver observer) noexcept {
+    observer_ = std::move(observer);
+  }
 
-    T obj;
-    auto error = glz::read_json(obj, resp->body);
-    if (error) {
-      return std::unexpected(APIError{ErrorCode::JSONParsing,
-                                      glz::format_error(error, resp->body),
-                                      resp->status});
-    }
+  // Trusts the certificates in `path` (PEM) instead of the system store,
+  // e.g. the self-signed one of a local test server.
+  void SetCACertPath(const std::string &path) { cli_.set_ca_cert_path(path); }
 
-    return obj;
+  // Records the phases of every request into `in` (see RequestTiming);
+  // null turns it off. `in` must outlive the client. Call before the first
+  // request.
+  void SetInstrumentation(Instrumentation *in) {
+    metrics_ = in ? std::make_unique<detail::EndpointMetrics>(*in) : nullptr;
   }
 
 private:
+  HttpClient(detail::HostPort hp, const httplib::Headers &headers) noexcept
+      : cli_(hp.host, hp.port), headers_(headers) {}
+
+  std::expected<httplib::Result, APIError>
+  Exchange(Req type, const std::string &path,
+           std::optional<std::string_view> body,
+           const std::optional<std::string> &content_type, std::string *sink,
+           detail::RequestTiming &timing) {
+    timing.Start(cli_);
+    auto resp = detail::Send(cli_, headers_, type, path, body, content_type,
+                             sink, timing.FirstByte());
+    timing.Received();
+    if (resp && observer_ && *resp) {
+      observer_(**resp);
+    }
+    return resp;
+  }
+
   httplib::SSLClient cli_;
   const httplib::Headers headers_;
+  ResponseObserver observer_;
+  std::unique_ptr<detail::EndpointMetrics> metrics_;
 };
 
 }; // namespace alpaca
@@ -1,17 +1,28 @@
 #pragma once
 #include <alpaca/client/environment.hpp>
 #include <alpaca/client/httpClient.hpp>
+#include <alpaca/client/pooledHttpClient.hpp>
 #include <alpaca/models/marketdata/serialize.hpp>
 #include <alpaca/utils/utils.hpp>
+#include <algorithm>
+#include <atomic>
+#include <exception>
 #include <glaze/glaze.hpp>
+#include <iterator>
+#include <map>
 #include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_set>
+#include <vector>
 
 namespace alpaca {
 
 template <class Env = Environment, class Http = HttpClient>
 class MarketDataClientT {
 private:
-  std::expected<Bars, APIError> GetBarsPimpl(const BarParams &p) noexcept {
+  template <class Page>
+  std::expected<Page, APIError> GetBarsPimpl(const BarParams &p) noexcept {
     const auto limit =
         p.limit ? std::make_optional(std::to_string(*p.limit)) : std::nullopt;
 
@@ -28,57 +39,288 @@ private:
     qb.add("page_token", p.page_token);
     qb.add("sort", ToString(p.sort));
     const std::string query = BARS_ENDPOINT + qb.q;
-    return cli_.template Request<Bars>(Req::GET, query);
+    return cli_.template Request<Page>(Req::GET, query);
   }
 
-public:
-  explicit MarketDataClientT(const Env &env) noexcept
-      : env_(env), cli_(env_.GetDataUrl(), env_.GetAuthHeaders()) {}
-
-  MarketDataClientT(const Env &env, Http cli) noexcept
-      : env_(env), cli_(std::move(cli)) {}
-
-  std::expected<Bars, APIError> GetBars(const BarParams &p) noexcept {
-    std::map<std::string, std::vector<Bar>> barsBySymbol;
-    std::optional<std::string> page;
+  static std::optional<APIError>
+  ValidateBarParams(const BarParams &p) noexcept {
+    if (p.symbols.empty()) {
+      return APIError{ErrorCode::IllArgument, "Empty symbol"};
+    }
+    if (p.timeframe.empty()) {
+      return APIError{ErrorCode::IllArgument, "Empty timeframe"};
+    }
+    if (p.limit && *p.limit <= 0) {
+      return APIError{ErrorCode::IllArgument, "Limit must be positive"};
+    }
+    return std::nullopt;
+  }
 
+  // Walks next_page_token for one request, handing every page to `onPage`.
+  // A callback returning bool stops the walk by returning false.
+  template <class Page, class F>
+  std::expected<std::monostate, APIError> PaginateBars(BarParams params,
+                                                       F &&onPage) noexcept {
     std::unordered_set<std::string> seen;
-    auto params = p;
-
     while (true) {
-      params.page_token = page;
-      auto resp = GetBarsPimpl(params);
+      auto resp = GetBarsPimpl<Page>(params);
       if (!resp) {
         return std::unexpected(resp.error());
       }
 
-      for (auto &[sym, bars] : resp->bars) {
-        auto &dst = barsBySymbol[sym];
-        dst.insert(dst.end(), bars.begin(), bars.end());
+      auto next = std::move(resp->next_page_token);
+      if constexpr (std::is_same_v<std::invoke_result_t<F &, Page &&>, bool>) {
+        if (!onPage(std::move(*resp))) {
+          return std::monostate{};
+        }
+      } else {
+        onPage(std::move(*resp));
       }
 
-      if (!resp->next_page_token || resp->next_page_token->empty()) {
-        break;
+      if (!next || next->empty()) {
+        return std::monostate{};
       }
 
-      if (!seen.insert(resp->next_page_token.value()).second) {
+      if (!seen.insert(*next).second) {
         return std::unexpected(APIError{
             ErrorCode::Unknown, "Pagination error: next_page_token repeated"});
       }
 
-      page = resp->next_page_token;
+      params.page_token = std::move(next);
+    }
+  }
+
+  template <class Time>
+  static void AppendBars(std::map<std::string, std::vector<BarT<Time>>> &dst,
+                         BarsT<Time> &&page) {
+    for (auto &[sym, bars] : page.bars) {
+      auto &out = dst[sym];
+      if (out.empty()) {
+        out = std::move(bars);
+      } else {
+        out.insert(out.end(), std::make_move_iterator(bars.begin()),
+                   std::make_move_iterator(bars.end()));
+      }
+    }
+  }
+
+  // Symbol-chunk major, time-slice minor, with slices in the requested sort
+  // order, so concatenating shard results in index order keeps every symbol's
+  // bars ordered.
+  static std::expected<std::vector<BarParams>, APIError>
+  MakeBarShards(const BarParams &p, const BarShardOptions &o) {
+    std::vector<std::pair<std::string, std::string>> slices;
+    if (o.timeSlices <= 1) {
+      slices.emplace_back(p.start, p.end);
+    } else {
+      const auto start = utils::FromIsoz(p.start);
+      const auto end = utils::FromIsoz(p.end);
+      if (!start || !end || *end <= *start) {
+        return std::unexpected(APIError{
+            ErrorCode::IllArgument,
+            "Time sharding requires start < end in YYYY-MM-DD[THH:MM:SSZ]"});
+      }
+      // Stay in seconds::rep; mixing in long long would change the
+      // time_point type where rep is long.
+      using Rep = std::chrono::seconds::rep;
+      const auto step = (*end - *start) / static_cast<Rep>(o.timeSlices);
+      for (std::size_t i = 0; i < o.timeSlices; ++i) {
+        const auto from = *start + step * static_cast<Rep>(i);
+        // Bounds are inclusive; stop one second short of the next slice.
+        const auto to = i + 1 == o.timeSlices
+                            ? *end
+                            : from + step - std::chrono::seconds{1};
+        if (to >= from) {
+          slices.emplace_back(utils::ToIsoz(from), utils::ToIsoz(to));
+        }
+      }
+      if (p.sort == BarSort::Desc) {
+        std::reverse(slices.begin(), slices.end());
+      }
     }
 
-    return Bars{barsBySymbol};
+    const auto chunk =
+        o.symbolsPerShard == 0 ? p.symbols.size() : o.symbolsPerShard;
+    std::vector<BarParams> shards;
+    for (std::size_t i = 0; i < p.symbols.size(); i += chunk) {
+      const auto last = std::min(p.symbols.size(), i + chunk);
+      for (const auto &[from, to] : slices) {
+        auto &s = shards.emplace_back(p);
+        s.symbols.assign(p.symbols.begin() + i, p.symbols.begin() + last);
+        s.start = from;
+        s.end = to;
+        s.page_token = std::nullopt;
+      }
+    }
+    return shards;
   }
 
-  std::expected<LatestBars, APIError>
+  // GetBarsSharded on validated params. Throws if a thread, shard or result
+  // map cannot be created.
+  template <class Time>
+  std::expected<BarsT<Time>, APIError>
+  ShardedBars(const BarParams &p, const BarShardOptions &o) {
+    auto shards = MakeBarShards(p, o);
+    if (!shards) {
+      return std::unexpected(shards.error());
+    }
+
+    const auto n = shards->size();
+    std::vector<std::map<std::string, std::vector<BarT<Time>>>> results(n);
+    std::vector<std::optional<APIError>> errors(n);
+    std::atomic<std::size_t> next{0};
+    std::atomic<bool> failed{false};
+
+    auto worker = [&] {
+      for (auto i = next++; i < n && !failed; i = next++) {
+        auto done = PaginateBars<BarsT<Time>>(
+            (*shards)[i], [&](BarsT<Time> &&page) {
+              AppendBars(results[i], std::move(page));
+            });
+        if (!done) {
+          errors[i] = std::move(done.error());
+          failed = true;
+        }
+      }
+    };
+
+    {
+      const auto parallel = std::clamp<std::size_t>(o.maxParallel, 1, n);
+      std::vector<std::jthread> pool;
+      pool.reserve(parallel - 1);
+      for (std::size_t t = 1; t < parallel; ++t) {
+        pool.emplace_back(worker);
+      }
+      worker();
+    }
+
+    for (auto &e : errors) {
+      if (e) {
+        return std::unexpected(std::move(*e));
+      }
+    }
+
+    // Size every symbol once, then move shard vectors in without regrowth.
+    std::map<std::string, std::size_t> sizes;
+    for (const auto &r : results) {
+      for (const auto &[sym, bars] : r) {
+        sizes[sym] += bars.size();
+      }
+    }
+
+    BarsT<Time> out;
+    for (const auto &[sym, size] : sizes) {
+      out.bars[sym].reserve(size);
+    }
+    for (auto &r : results) {
+      for (auto &[sym, bars] : r) {
+        auto &dst = out.bars[sym];
+        dst.insert(dst.end(), std::make_move_iterator(bars.begin()),
+                   std::make_move_iterator(bars.end()));
+      }
+    }
+    return out;
+  }
+
+public:
+  explicit MarketDataClientT(const Env &env) noexcept
+      : env_(env), cli_(env_.GetDataUrl(), env_.GetAuthHeaders()) {}
+
+  MarketDataClientT(const Env &env, Http cli) noexcept
+      : env_(env), cli_(std::move(cli)) {}
+
+  // Runs `f(*this)` on `ex` and returns a future of its result, e.g.
+  //   auto fut = cli.Async(io, [p](auto &c) { return c.GetLatestBar(p); });
+  template <class Executor, class F> auto Async(Executor &ex, F &&f) {
+    return ex.Submit(
+        [this, f = std::forward<F>(f)]() mutable { return f(*this); });
+  }
+
+  // `Time` selects the bar timestamp type: std::string, or Timestamp for
+  // timestamps decoded at the wire.
+  template <class Time = std::string>
+  std::expected<BarsT<Time>, APIError> GetBars(const BarParams &p) noexcept {
+    if (auto err = ValidateBarParams(p)) {
+      return std::unexpected(*err);
+    }
+
+    std::map<std::string, std::vector<BarT<Time>>> barsBySymbol;
+    auto done = PaginateBars<BarsT<Time>>(p, [&](BarsT<Time> &&page) {
+      AppendBars(barsBySymbol, std::move(page));
+    });
+    if (!done) {
+      return std::unexpected(done.error());
+    }
+
+    return BarsT<Time>{std::move(barsBySymbol)};
+  }
+
+  // Same request as GetBars, decoded into one column-oriented BarSeries per
+  // symbol (epoch-ns timestamps, no per-bar allocation).
+  std::expected<BarSeriesMap, APIError>
+  GetBarSeries(const BarParams &p) noexcept {
+    if (auto err = ValidateBarParams(p)) {
+      return std::unexpected(*err);
+    }
+
+    BarSeriesMap series;
+    auto done = PaginateBars<BarSeriesPage>(p, [&](BarSeriesPage &&page) {
+      for (auto &[sym, cols] : page.bars) {
+        series[sym].append(std::move(cols));
+      }
+    });
+    if (!done) {
+      return std::unexpected(done.error());
+    }
+
+    return series;
+  }
+
+  // Same request and pagination as GetBars, but each page is handed to
+  // `onPage` as soon as it is decoded instead of being accumulated, so peak
+  // memory is one page. `onPage` takes `Page &&` (Bars or BarSeriesPage) and
+  // returns void, or bool where false stops fetching further pages. A
+  // symbol's bars may span several consecutive pages.
+  template <class Page = Bars, class F>
+  std::expected<std::monostate, APIError> ForEachBarPage(const BarParams &p,
+                                                         F &&onPage) noexcept {
+    if (auto err = ValidateBarParams(p)) {
+      return std::unexpected(*err);
+    }
+    return PaginateBars<Page>(p, std::forward<F>(onPage));
+  }
+
+  // Splits the request into symbol/time shards and paginates up to
+  // o.maxParallel of them at once. The result is identical to GetBars.
+  // Concurrent shards share the transport, so Http must be safe to call from
+  // several threads (HttpClient serializes, PooledHttpClient overlaps).
+  template <class Time = std::string>
+  std::expected<BarsT<Time>, APIError>
+  GetBarsSharded(const BarParams &p, const BarShardOptions &o = {}) noexcept {
+    if (auto err = ValidateBarParams(p)) {
+      return std::unexpected(*err);
+    }
+    try {
+      return ShardedBars<Time>(p, o);
+    } catch (const std::exception &e) {
+      return std::unexpected(
+          APIError{ErrorCode::Unknown,
+                   std::string("Cannot shard the request: ") + e.what()});
+    }
+  }
+
+  template <class Time = std::string>
+  std::expected<LatestBarsT<Time>, APIError>
   GetLatestBar(const LatestBarParam &p) noexcept {
+    if (p.symbols.empty()) {
+      return std::unexpected(APIError{ErrorCode::IllArgument, "Empty symbol"});
+    }
+
     utils::QueryBuilder qb;
     qb.add("symbols", utils::SymbolsEncode(p.symbols));
     qb.add("feed", ToString(p.feed));
     const std::string query = LATEST_BARS_ENDPOINT + qb.q;
-    return cli_.template Request<LatestBars>(Req::GET, query);
+    return cli_.template Request<LatestBarsT<Time>>(Req::GET, query);
   }
 
 private:
@@ -90,5 +332,6 @@ private:
 };
 
 using MarketDataClient = MarketDataClientT<Environment, HttpClient>;
+using PooledMarketDataClient = MarketDataClientT<Environment, PooledHttpClient>;
 
 }; // namespace alpaca
@@ -1,11 +1,27 @@
 #pragma once
 #include <alpaca/client/environment.hpp>
+#include <alpaca/client/reconnect.hpp>
 #include <alpaca/client/websocketClient.hpp>
+#include <alpaca/models/streaming/marketDataDecoder.hpp>
 #include <alpaca/models/streaming/marketdata.hpp>
-#include <alpaca/models/streaming/serialize.hpp>
+#include <alpaca/models/streaming/msgpack.hpp>
+#include <alpaca/utils/conflationTable.hpp>
+#include <alpaca/utils/latency.hpp>
+#include <alpaca/utils/ringBuffer.hpp>
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <cstddef>
 #include <format>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <variant>
 #include <vector>
 
 namespace alpaca {
@@ -16,101 +32,579 @@ public:
   explicit MarketDataStreamT(const Env &env, Ws ws = Ws{})
       : env_(env), ws_(std::move(ws)) {}
 
-  void Connect(MarketDataSubscription sub, MarketDataCallbacks cbs) {
-    sub_ = std::move(sub);
+  // Closes the socket while the members its callbacks touch still exist;
+  // ws_ itself is destroyed after them.
+  ~MarketDataStreamT() { Disconnect(); }
+
+  // Interns symbols into `table` instead of SymbolTable::Global(). Call
+  // before Connect.
+  void UseSymbolTable(SymbolTable &table) { symbols_ = SymbolCache(table); }
+
+  SymbolTable &Symbols() const noexcept { return symbols_.Table(); }
+
+  // Asks the server for msgpack (binary) frames instead of JSON; control
+  // messages are sent in the same encoding. Call before Connect.
+  void SetEncoding(StreamEncoding encoding) { encoding_ = encoding; }
+
+  // Reconnects after an unexpected close, replaying auth and the current
+  // subscription. On by default.
+  void SetReconnectPolicy(ReconnectPolicy policy) {
+    reconnector_.SetPolicy(policy);
+  }
+
+  ReconnectStats GetReconnectStats() const { return reconnector_.Stats(); }
+
+  // Records into `in`, for each message type (trade, quote, bar):
+  //   md.decode <type>    parsing the message out of its frame
+  //   md.callback <type>  the callbacks, or under Queued/Conflated delivery
+  //                       the hand-off to the queue
+  //   md.queue_depth      events queued after each hand-off
+  // and, for the subscription's feed:
+  //   md.lag.exchange <feed>  message timestamp to receipt, on the wall
+  //                           clock (clock skew with the exchange shows)
+  //   md.lag.callback <feed>  receipt to the callbacks, or to Poll/Drain
+  //                           under Queued/Conflated delivery
+  // plus "ws.handle md" when Ws supports it. Null turns it off. Call before
+  // Connect.
+  void SetInstrumentation(Instrumentation *in) {
+    instr_ = in;
+    probes_ = {};
+    if (in) {
+      for (std::size_t i = 0; i < kKindNames.size(); ++i) {
+        probes_.decode[i] =
+            &in->Histogram(std::format("md.decode {}", kKindNames[i]));
+        probes_.callback[i] =
+            &in->Histogram(std::format("md.callback {}", kKindNames[i]));
+      }
+      probes_.queueDepth = &in->Histogram("md.queue_depth");
+    }
+    if constexpr (requires { ws_.SetInstrumentation(in, "md"); }) {
+      ws_.SetInstrumentation(in, "md");
+    }
+  }
+
+  void Connect(MarketDataSubscription sub, MarketDataCallbacks cbs,
+               MarketDataDelivery delivery = {}) {
+    std::string feed;
+    {
+      std::lock_guard lock(subMtx_);
+      sub_ = std::move(sub);
+      confirmed_ = {};
+      // Subscribed symbols get their ids up front, so per-symbol arrays can
+      // be sized to Symbols().Size() before the first event.
+      for (auto list : kSubscriptionLists) {
+        for (const auto &sym : sub_.*list) {
+          symbols_.Intern(sym);
+        }
+      }
+      feed = sub_.feed;
+    }
     cbs_ = std::move(cbs);
+    delivery_ = delivery;
+    // A consumer may be in Poll/Drain, so the ring and the conflation table
+    // are never replaced: the first Connect that needs one creates it, and
+    // later ones keep it with its capacity and any events still in it.
+    if (delivery_.mode != DeliveryMode::Inline && !queueStore_) {
+      queueStore_ =
+          std::make_unique<RingBuffer<MarketDataEvent>>(delivery_.capacity);
+      queue_.store(queueStore_.get(), std::memory_order_release);
+    }
+    if (delivery_.mode == DeliveryMode::Conflated && !latestStore_) {
+      latestStore_ = std::make_unique<ConflationTable<QuoteEvent>>(
+          delivery_.maxSymbols);
+      latest_.store(latestStore_.get(), std::memory_order_release);
+    }
+    stopping_ = false;
     state_ = State::Connecting;
+    if (instr_) {
+      probes_.exchangeLag =
+          &instr_->Histogram(std::format("md.lag.exchange {}", feed));
+      probes_.callbackLag =
+          &instr_->Histogram(std::format("md.lag.callback {}", feed));
+    }
 
-    std::string url = env_.GetStreamDataUrl(sub_.feed);
+    url_ = env_.GetStreamDataUrl(feed);
+    if (encoding_ == StreamEncoding::Msgpack) {
+      ws_.SetHeader("Content-Type", "application/msgpack");
+    }
+    reconnector_.Arm();
+    ws_.Connect(url_, MakeWsCallbacks());
+  }
+
+  void Disconnect() {
+    // Releases a socket thread waiting on a full ring.
+    stopping_ = true;
+    reconnector_.Cancel();
+    ws_.Disconnect();
+  }
+
+  bool IsConnected() const { return ws_.IsConnected(); }
+
+  // Adds the symbols of `add` that are not subscribed yet (its feed is
+  // ignored) and, on a live connection, sends a subscribe for just those.
+  // They are also part of every later resubscription. False when there was
+  // nothing new.
+  bool Subscribe(const MarketDataSubscription &add) {
+    std::lock_guard lock(subMtx_);
+    MarketDataSubscription delta;
+    for (auto list : kSubscriptionLists) {
+      for (const auto &sym : add.*list) {
+        if (std::ranges::find(sub_.*list, sym) == (sub_.*list).end()) {
+          (sub_.*list).push_back(sym);
+          (delta.*list).push_back(sym);
+          Symbols().Intern(sym);
+        }
+      }
+    }
+    return SendDelta("subscribe", delta);
+  }
 
+  // Drops the symbols of `remove` that are subscribed and, on a live
+  // connection, sends an unsubscribe for just those. False when none were.
+  bool Unsubscribe(const MarketDataSubscription &remove) {
+    std::lock_guard lock(subMtx_);
+    MarketDataSubscription delta;
+    for (auto list : kSubscriptionLists) {
+      for (const auto &sym : remove.*list) {
+        if (std::erase(sub_.*list, sym) > 0) {
+          (delta.*list).push_back(sym);
+        }
+      }
+    }
+    return SendDelta("unsubscribe", delta);
+  }
+
+  // Frames received so far, and when the last one arrived. A connected
+  // stream whose last frame is old has gone quiet.
+  uint64_t FramesReceived() const noexcept {
+    return frames_.load(std::memory_order_relaxed);
+  }
+
+  std::chrono::steady_clock::time_point LastFrameTime() const noexcept {
+    return std::chrono::steady_clock::time_point{
+        std::chrono::steady_clock::duration{
+            lastFrame_.load(std::memory_order_relaxed)}};
+  }
+
+  // The set this stream asks for, including changes not yet confirmed.
+  MarketDataSubscription Subscription() const {
+    std::lock_guard lock(subMtx_);
+    return sub_;
+  }
+
+  // The set the server last confirmed with a "subscription" message.
+  MarketDataSubscription ConfirmedSubscription() const {
+    std::lock_guard lock(subMtx_);
+    return confirmed_;
+  }
+
+  // Consumer side of DeliveryMode::Queued/Conflated; call from one thread
+  // only, once Connect has set up queued delivery. Polling may go on across
+  // later Connects. Queued events come out in arrival order, followed by
+  // conflated quotes in the order their symbols became dirty.
+
+  // Next event, if any.
+  std::optional<MarketDataEvent> Poll() {
+    MarketDataEvent e;
+    if (!Next(e)) {
+      return std::nullopt;
+    }
+    return e;
+  }
+
+  // Hands up to `max` events to `f` and returns how many there were.
+  template <class F>
+  std::size_t Drain(F &&f,
+                    std::size_t max = std::numeric_limits<std::size_t>::max()) {
+    std::size_t n = 0;
+    MarketDataEvent e;
+    while (n < max && Next(e)) {
+      f(e);
+      ++n;
+    }
+    return n;
+  }
+
+  DeliveryStats Stats() const noexcept {
+    DeliveryStats st;
+    st.enqueued = enqueued_.load(std::memory_order_relaxed);
+    st.dropped = dropped_.load(std::memory_order_relaxed);
+    st.blocked = blocked_.load(std::memory_order_relaxed);
+    if (const auto *ring = Ring()) {
+      st.queued = ring->Size();
+    }
+    if (const auto *latest = Latest()) {
+      st.coalesced = latest->Coalesced();
+      st.queued += latest->Dirty();
+    }
+    return st;
+  }
+
+private:
+  enum class State { Disconnected, Connecting, Authenticated, Subscribed };
+
+  enum Kind : std::size_t { kTrade, kQuote, kBar };
+  static constexpr std::array<std::string_view, 3> kKindNames{"trade", "quote",
+                                                              "bar"};
+
+  // Histograms of SetInstrumentation; all null when it is off. `mark` is
+  // where the decoding of the next message started and is socket thread
+  // only; callbackLag is also recorded by the consumer.
+  struct Probes {
+    std::array<HdrHistogram *, 3> decode{};
+    std::array<HdrHistogram *, 3> callback{};
+    HdrHistogram *queueDepth{};
+    HdrHistogram *exchangeLag{};
+    HdrHistogram *callbackLag{};
+    std::chrono::steady_clock::time_point mark{};
+  };
+
+  WsCallbacks MakeWsCallbacks() {
     WsCallbacks wsCbs;
-    wsCbs.onMessage = [this](const std::string &raw) { OnMessage(raw); };
+    // A Ws that does not stamp frames gets them stamped here.
+    wsCbs.onMessage = [this](const std::string &raw) {
+      Reconnector::CallbackScope scope(reconnector_);
+      OnMessage(raw, ReceiveTime::Now());
+    };
+    wsCbs.onTimedMessage = [this](const std::string &raw,
+                                  const ReceiveTime &received) {
+      Reconnector::CallbackScope scope(reconnector_);
+      OnMessage(raw, received);
+    };
     wsCbs.onClose = [this]() {
+      Reconnector::CallbackScope scope(reconnector_);
       state_ = State::Disconnected;
       if (cbs_.onDisconnected)
         cbs_.onDisconnected();
+      ScheduleReconnect();
     };
     wsCbs.onError = [this](const std::string &reason) {
+      Reconnector::CallbackScope scope(reconnector_);
       if (cbs_.onError)
         cbs_.onError(APIError{ErrorCode::Connection, reason});
+      if (!ws_.IsConnected())
+        ScheduleReconnect();
     };
-    ws_.Connect(url, std::move(wsCbs));
+    return wsCbs;
+  }
+
+  // Reports through onError, once, when the policy's attempts run out.
+  void ScheduleReconnect() {
+    if (reconnector_.Stats().gaveUp) {
+      return;
+    }
+    const bool scheduled = reconnector_.Schedule([this] {
+      state_ = State::Connecting;
+      ws_.Connect(url_, MakeWsCallbacks());
+      // Disconnect() ran in a socket callback meanwhile and did not wait.
+      if (reconnector_.Cancelled()) {
+        ws_.Disconnect();
+      }
+    });
+    if (!scheduled && reconnector_.Stats().gaveUp && cbs_.onError)
+      cbs_.onError(
+          APIError{ErrorCode::Connection, "Reconnect attempts exhausted"});
   }
 
-  void Disconnect() { ws_.Disconnect(); }
+  // Handler for DecodeMarketDataFrame; views point into the frame, so they
+  // are delivered before OnMessage returns.
+  struct Dispatch {
+    MarketDataStreamT &s;
 
-  bool IsConnected() const { return ws_.IsConnected(); }
+    void OnControl(const StreamControlView &c) {
+      s.OnControl(c);
+      if (s.probes_.decode[kTrade]) {
+        s.probes_.mark = std::chrono::steady_clock::now();
+      }
+    }
+    void OnTrade(StreamTradeView &v) {
+      s.Stamp(v);
+      s.Timed(kTrade, [&] { s.OnTrade(v); });
+    }
+    void OnQuote(StreamQuoteView &v) {
+      s.Stamp(v);
+      s.Timed(kQuote, [&] { s.OnQuote(v); });
+    }
+    void OnBar(StreamBarView &v) {
+      s.Stamp(v);
+      s.Timed(kBar, [&] { s.OnBar(v); });
+    }
+  };
 
-private:
-  enum class State { Disconnected, Connecting, Authenticated, Subscribed };
+  // Fills in what the decoder does not know: the symbol id and when the
+  // frame arrived.
+  template <class View> void Stamp(View &v) {
+    v.symbolId = symbols_.Intern(v.symbol);
+    v.received = received_;
+    if (probes_.exchangeLag && v.time != Timestamp{}) {
+      probes_.exchangeLag->Record(received_.wall - v.time.time);
+    }
+  }
+
+  // Receive to delivery of an event that arrived at `received`.
+  void RecordCallbackLag(const ReceiveTime &received) {
+    if (probes_.callbackLag) {
+      probes_.callbackLag->Record(std::chrono::steady_clock::now() -
+                                  received.mono);
+    }
+  }
 
-  void OnMessage(const std::string &raw) {
-    std::vector<MarketDataMsgWire> msgs;
-    auto err = glz::read<glz::opts{.error_on_unknown_keys = false}>(msgs, raw);
+  // Runs `deliver` for a decoded message of `kind`, recording the decode
+  // time since the mark and the delivery time when instrumented.
+  template <class F> void Timed(Kind kind, F &&deliver) {
+    if (!probes_.decode[kind]) {
+      deliver();
+      return;
+    }
+    const auto decoded = std::chrono::steady_clock::now();
+    probes_.decode[kind]->Record(decoded - probes_.mark);
+    deliver();
+    probes_.mark = std::chrono::steady_clock::now();
+    probes_.callback[kind]->Record(probes_.mark - decoded);
+  }
+
+  void OnMessage(const std::string &raw, const ReceiveTime &received) {
+    frames_.fetch_add(1, std::memory_order_relaxed);
+    lastFrame_.store(received.mono.time_since_epoch().count(),
+                     std::memory_order_relaxed);
+    received_ = received;
+    probes_.mark = received.mono;
+    auto err = encoding_ == StreamEncoding::Msgpack
+                   ? DecodeMarketDataMsgpack(raw, Dispatch{*this})
+                   : DecodeMarketDataFrame(raw, Dispatch{*this});
     if (err) {
+      if (cbs_.onError)
+        cbs_.onError(APIError{ErrorCode::JSONParsing, std::move(*err)});
+    }
+  }
+
+  void OnControl(const StreamControlView &c) {
+    if (c.type == "success") {
+      if (c.msg == "connected") {
+        SendAuth();
+      } else if (c.msg == "authenticated") {
+        state_ = State::Authenticated;
+        if (cbs_.onConnected)
+          cbs_.onConnected();
+        SendSubscribe();
+      }
+    } else if (c.type == "subscription") {
+      OnSubscription(c);
+      state_ = State::Subscribed;
+      if (auto gap = reconnector_.Restored(); gap && cbs_.onReconnected)
+        cbs_.onReconnected(*gap);
+    } else if (c.type == "error") {
       if (cbs_.onError)
         cbs_.onError(
-            APIError{ErrorCode::JSONParsing, glz::format_error(err, raw)});
-      return;
+            APIError{ErrorCode::Connection, std::string(c.msg), c.code});
     }
+  }
 
-    for (auto &wire : msgs) {
-      if (wire.type == "success") {
-        if (wire.msg == "connected") {
-          SendAuth();
-        } else if (wire.msg == "authenticated") {
-          state_ = State::Authenticated;
-          if (cbs_.onConnected)
-            cbs_.onConnected();
-          SendSubscribe();
-        }
-      } else if (wire.type == "subscription") {
-        state_ = State::Subscribed;
-      } else if (wire.type == "error") {
-        if (cbs_.onError)
-          cbs_.onError(APIError{ErrorCode::Connection, wire.msg, wire.code});
-      } else if (wire.type == "t") {
-        if (cbs_.onTrade) {
-          StreamTrade t;
-          t.symbol = wire.symbol;
-          t.timestamp = wire.timestamp;
-          t.price = wire.price;
-          t.size = wire.tradeSize;
-          t.exchange = wire.exchange;
-          t.tape = wire.tape;
-          cbs_.onTrade(std::move(t));
-        }
-      } else if (wire.type == "q") {
-        if (cbs_.onQuote) {
-          StreamQuote q;
-          q.symbol = wire.symbol;
-          q.timestamp = wire.timestamp;
-          q.askPrice = wire.askPrice;
-          q.bidPrice = wire.bidPrice;
-          q.askSize = wire.askSize;
-          q.bidSize = wire.bidSize;
-          cbs_.onQuote(std::move(q));
+  bool Queued() const noexcept {
+    return delivery_.mode != DeliveryMode::Inline;
+  }
+
+  // Null until a Connect first needs them; set once and kept from then on.
+  RingBuffer<MarketDataEvent> *Ring() const noexcept {
+    return queue_.load(std::memory_order_acquire);
+  }
+
+  ConflationTable<QuoteEvent> *Latest() const noexcept {
+    return latest_.load(std::memory_order_acquire);
+  }
+
+  bool Next(MarketDataEvent &e) {
+    if (auto *ring = Ring(); ring && ring->TryPop(e)) {
+      if (probes_.callbackLag) {
+        std::visit([&](const auto &x) { RecordCallbackLag(x.received); }, e);
+      }
+      return true;
+    }
+    SymbolId id;
+    QuoteEvent q;
+    uint32_t coalesced;
+    if (auto *latest = Latest(); latest && latest->TryTake(id, q, coalesced)) {
+      q.coalesced = coalesced;
+      RecordCallbackLag(q.received);
+      e = q;
+      return true;
+    }
+    return false;
+  }
+
+  void Enqueue(const MarketDataEvent &e) {
+    auto *ring = Ring();
+    if (ring->TryPush(e)) {
+      enqueued_.fetch_add(1, std::memory_order_relaxed);
+      RecordDepth();
+      return;
+    }
+    switch (delivery_.overflow) {
+    case OverflowPolicy::DropNewest:
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    case OverflowPolicy::DropOldest: {
+      MarketDataEvent evicted;
+      while (!ring->TryPush(e)) {
+        if (ring->TryPop(evicted)) {
+          dropped_.fetch_add(1, std::memory_order_relaxed);
         }
-      } else if (wire.type == "b") {
-        if (cbs_.onBar) {
-          StreamBar b;
-          b.symbol = wire.symbol;
-          b.timestamp = wire.timestamp;
-          b.open = wire.barOpen;
-          b.high = wire.barHigh;
-          b.low = wire.barLow;
-          b.close = wire.barClose;
-          b.vwap = wire.barVwap;
-          b.volume = wire.barVolume;
-          b.numTrades = wire.barNumTrades;
-          cbs_.onBar(std::move(b));
+      }
+      break;
+    }
+    case OverflowPolicy::Block:
+      blocked_.fetch_add(1, std::memory_order_relaxed);
+      while (!ring->TryPush(e)) {
+        if (stopping_) {
+          dropped_.fetch_add(1, std::memory_order_relaxed);
+          return;
         }
+        std::this_thread::yield();
       }
-      // Unknown T values are silently ignored
+      break;
+    }
+    enqueued_.fetch_add(1, std::memory_order_relaxed);
+    RecordDepth();
+  }
+
+  void RecordDepth() {
+    if (probes_.queueDepth) {
+      probes_.queueDepth->Record(Ring()->Size());
     }
   }
 
+  void OnTrade(const StreamTradeView &v) {
+    if (Queued()) {
+      Enqueue(TradeEvent{v.symbolId, v.time, v.received, v.price, v.size});
+      return;
+    }
+    RecordCallbackLag(v.received);
+    if (cbs_.onTradeView)
+      cbs_.onTradeView(v);
+    if (cbs_.onTrade) {
+      StreamTrade t;
+      t.symbol = v.symbol;
+      t.timestamp = TimestampText(v.timestamp, v.time);
+      t.exchange = v.exchange;
+      t.tape = v.tape;
+      t.price = v.price;
+      t.size = v.size;
+      t.time = v.time;
+      t.symbolId = v.symbolId;
+      t.received = v.received;
+      cbs_.onTrade(std::move(t));
+    }
+  }
+
+  void OnQuote(const StreamQuoteView &v) {
+    if (Queued()) {
+      const QuoteEvent e{v.symbolId, v.time,    v.received, v.askPrice,
+                         v.bidPrice, v.askSize, v.bidSize};
+      if (delivery_.mode != DeliveryMode::Conflated) {
+        Enqueue(e);
+      } else if (Latest()->Put(v.symbolId, e)) {
+        enqueued_.fetch_add(1, std::memory_order_relaxed);
+      } else {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+      }
+      return;
+    }
+    RecordCallbackLag(v.received);
+    if (cbs_.onQuoteView)
+      cbs_.onQuoteView(v);
+    if (cbs_.onQuote) {
+      StreamQuote q;
+      q.symbol = v.symbol;
+      q.timestamp = TimestampText(v.timestamp, v.time);
+      q.askPrice = v.askPrice;
+      q.bidPrice = v.bidPrice;
+      q.askSize = v.askSize;
+      q.bidSize = v.bidSize;
+      q.time = v.time;
+      q.symbolId = v.symbolId;
+      q.received = v.received;
+      cbs_.onQuote(std::move(q));
+    }
+  }
+
+  void OnBar(const StreamBarView &v) {
+    if (Queued()) {
+      Enqueue(BarEvent{v.symbolId, v.time, v.received, v.open, v.high, v.low,
+                       v.close, v.vwap, v.volume, v.numTrades});
+      return;
+    }
+    RecordCallbackLag(v.received);
+    if (cbs_.onBarView)
+      cbs_.onBarView(v);
+    if (cbs_.onBar) {
+      StreamBar b;
+      b.symbol = v.symbol;
+      b.timestamp = TimestampText(v.timestamp, v.time);
+      b.open = v.open;
+      b.high = v.high;
+      b.low = v.low;
+      b.close = v.close;
+      b.vwap = v.vwap;
+      b.volume = v.volume;
+      b.numTrades = v.numTrades;
+      b.time = v.time;
+      b.symbolId = v.symbolId;
+      b.received = v.received;
+      cbs_.onBar(std::move(b));
+    }
+  }
+
+  // Msgpack frames carry no timestamp text; owning events get it rendered.
+  std::string TimestampText(std::string_view raw, const Timestamp &t) const {
+    if (raw.empty() && encoding_ == StreamEncoding::Msgpack) {
+      return t.ToString();
+    }
+    return std::string(raw);
+  }
+
+  void OnSubscription(const StreamControlView &c) {
+    auto read = [&](std::string_view raw, std::vector<std::string> &out) {
+      if (raw.empty()) {
+        return true;
+      }
+      return c.encoding == StreamEncoding::Msgpack
+                 ? detail::ReadMsgpackStringList(raw, out)
+                 : detail::ReadStringList(raw, out);
+    };
+    MarketDataSubscription confirmed;
+    if (!read(c.trades, confirmed.trades) ||
+        !read(c.quotes, confirmed.quotes) || !read(c.bars, confirmed.bars)) {
+      if (cbs_.onError)
+        cbs_.onError(APIError{ErrorCode::JSONParsing,
+                              "Malformed subscription message"});
+      return;
+    }
+    std::lock_guard lock(subMtx_);
+    confirmed.feed = sub_.feed;
+    confirmed_ = std::move(confirmed);
+  }
+
+  // Before authentication the change rides along with the initial
+  // subscribe instead. Called with subMtx_ held, which keeps it ordered
+  // after that subscribe.
+  bool SendDelta(std::string_view action,
+                 const MarketDataSubscription &delta) {
+    if (delta.trades.empty() && delta.quotes.empty() && delta.bars.empty()) {
+      return false;
+    }
+    const auto st = state_.load();
+    if (st == State::Authenticated || st == State::Subscribed) {
+      SendAction(action, delta);
+    }
+    return true;
+  }
+
   void SendAuth() {
+    if (encoding_ == StreamEncoding::Msgpack) {
+      ws_.SendBinary(
+          detail::EncodeMsgpackAuth(env_.GetID(), env_.GetSecret()));
+      return;
+    }
     std::string msg =
         std::format(R"({{"action":"auth","key":"{}","secret":"{}"}})",
                     env_.GetID(), env_.GetSecret());
@@ -118,10 +612,20 @@ private:
   }
 
   void SendSubscribe() {
+    std::lock_guard lock(subMtx_);
+    SendAction("subscribe", sub_);
+  }
+
+  void SendAction(std::string_view action,
+                  const MarketDataSubscription &lists) {
+    if (encoding_ == StreamEncoding::Msgpack) {
+      ws_.SendBinary(detail::EncodeMsgpackAction(action, lists));
+      return;
+    }
     ws_.Send(std::format(
-        R"({{"action":"subscribe","trades":{},"quotes":{},"bars":{}}})",
-        FormatList(sub_.trades), FormatList(sub_.quotes),
-        FormatList(sub_.bars)));
+        R"({{"action":"{}","trades":{},"quotes":{},"bars":{}}})", action,
+        FormatList(lists.trades), FormatList(lists.quotes),
+        FormatList(lists.bars)));
   }
 
   static std::string FormatList(const std::vector<std::string> &syms) {
@@ -138,10 +642,34 @@ private:
   }
 
   Env env_;
+  // Outlives ws_, whose shutdown may still report a close.
+  Reconnector reconnector_;
   Ws ws_;
+  std::string url_;
+  StreamEncoding encoding_{StreamEncoding::Json};
+  mutable std::mutex subMtx_;
   MarketDataSubscription sub_;
+  MarketDataSubscription confirmed_;
   MarketDataCallbacks cbs_;
+  SymbolCache symbols_;
+  MarketDataDelivery delivery_;
+  std::unique_ptr<RingBuffer<MarketDataEvent>> queueStore_;
+  std::unique_ptr<ConflationTable<QuoteEvent>> latestStore_;
+  // The two above, published for Stats() and the consumer, which run on
+  // other threads than Connect.
+  std::atomic<RingBuffer<MarketDataEvent> *> queue_{nullptr};
+  std::atomic<ConflationTable<QuoteEvent> *> latest_{nullptr};
+  std::atomic<bool> stopping_{false};
+  std::atomic<uint64_t> enqueued_{0};
+  std::atomic<uint64_t> dropped_{0};
+  std::atomic<uint64_t> blocked_{0};
+  std::atomic<uint64_t> frames_{0};
+  std::atomic<std::chrono::steady_clock::rep> lastFrame_{0};
   std::atomic<State> state_{State::Disconnected};
+  // The frame being decoded. Socket thread only.
+  ReceiveTime received_{};
+  Instrumentation *instr_{nullptr};
+  Probes probes_;
 };
 
 using MarketDataStream = MarketDataStreamT<Environment, WebSocketClient>;
@@ -0,0 +1,263 @@
+#pragma once
+#include <alpaca/client/httpClient.hpp>
+#include <alpaca/models/streaming/tradeupdate.hpp>
+#include <alpaca/models/trading/order.hpp>
+#include <alpaca/utils/symbolTable.hpp>
+#include <alpaca/utils/utils.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <expected>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace alpaca {
+
+// In-memory view of the account's orders, kept current by the trade-update
+// stream instead of polling GetAllOrders. Seed() loads the open orders over
+// REST; Apply() folds in every TradeUpdate. Lookups by id or client order id
+// are hash-map hits under a shared lock.
+//
+// Entries are immutable: an update replaces the shared_ptr, so a pointer a
+// reader holds stays a consistent picture of the order at one point in
+// time. Orders that reach a final status are kept for lookups until
+// `retainClosed` newer ones have closed.
+//
+// Typical wiring: route onUpdate to Apply(), call Seed() once the stream is
+// listening, and again from onReconnected to recover the gap.
+class OrderStateCache {
+public:
+  using OrderPtr = std::shared_ptr<const OrderResponse>;
+
+  explicit OrderStateCache(std::size_t retainClosed = 1024)
+      : retainClosed_(retainClosed) {}
+
+  OrderStateCache(const OrderStateCache &) = delete;
+  OrderStateCache &operator=(const OrderStateCache &) = delete;
+
+  // filled, canceled, expired, replaced and rejected orders see no further
+  // updates.
+  static bool IsClosed(std::string_view status) noexcept {
+    return status == "filled" || status == "canceled" ||
+           status == "expired" || status == "replaced" ||
+           status == "rejected";
+  }
+
+  // Loads the open orders from `trading` (a TradingClientT) and merges them
+  // in, a page at a time in submission order until a short page. Cached
+  // orders that are open here but not on the server closed while nobody was
+  // listening; they are fetched individually to learn how. Entries the
+  // stream updated more recently than the REST response are kept. Returns
+  // the number of open orders afterwards.
+  //
+  // A failed page leaves the cache as it was. A failed GetOrderByID does
+  // not stop the others: every order that could be fetched is merged, and
+  // the first error is returned; the orders it missed stay open until the
+  // next Seed().
+  template <class Client>
+  std::expected<std::size_t, APIError> Seed(Client &trading) {
+    auto open = ListOpen(trading);
+    if (!open) {
+      return std::unexpected(open.error());
+    }
+
+    std::vector<std::string> missing;
+    {
+      std::unordered_map<std::string_view, bool, SymbolHash, std::equal_to<>>
+          listed;
+      for (const auto &o : *open) {
+        listed.emplace(o.id, true);
+      }
+      std::shared_lock lock(mtx_);
+      for (const auto &[id, o] : byID_) {
+        if (!IsClosed(o->status) && !listed.contains(id)) {
+          missing.push_back(id);
+        }
+      }
+    }
+
+    {
+      std::unique_lock lock(mtx_);
+      for (auto &o : *open) {
+        Merge(std::move(o), false);
+      }
+    }
+
+    std::optional<APIError> error;
+    for (const auto &id : missing) {
+      auto o = trading.GetOrderByID(id);
+      if (!o) {
+        if (!error) {
+          error = std::move(o.error());
+        }
+        continue;
+      }
+      std::unique_lock lock(mtx_);
+      Merge(std::move(*o), false);
+    }
+    if (error) {
+      return std::unexpected(std::move(*error));
+    }
+    return OpenCount();
+  }
+
+  // Applies one event from the trade-update stream.
+  void Apply(const TradeUpdate &update) { Upsert(update.order); }
+
+  // Records an order known from elsewhere, e.g. the SubmitOrder response,
+  // so it can be found before the stream reports it.
+  void Upsert(OrderResponse order) {
+    std::unique_lock lock(mtx_);
+    Merge(std::move(order), true);
+  }
+
+  OrderPtr Find(std::string_view id) const {
+    std::shared_lock lock(mtx_);
+    auto it = byID_.find(id);
+    return it == byID_.end() ? nullptr : it->second;
+  }
+
+  OrderPtr FindByClientID(std::string_view clientOrderID) const {
+    std::shared_lock lock(mtx_);
+    auto it = byClientID_.find(clientOrderID);
+    return it == byClientID_.end() ? nullptr : it->second;
+  }
+
+  // Orders not yet in a final status, as of a single instant.
+  std::vector<OrderPtr> Open() const {
+    std::shared_lock lock(mtx_);
+    std::vector<OrderPtr> out;
+    out.reserve(open_);
+    for (const auto &[id, o] : byID_) {
+      if (!IsClosed(o->status)) {
+        out.push_back(o);
+      }
+    }
+    return out;
+  }
+
+  // Every cached order, open and retained closed ones.
+  std::vector<OrderPtr> Snapshot() const {
+    std::shared_lock lock(mtx_);
+    std::vector<OrderPtr> out;
+    out.reserve(byID_.size());
+    for (const auto &[id, o] : byID_) {
+      out.push_back(o);
+    }
+    return out;
+  }
+
+  std::size_t OpenCount() const {
+    std::shared_lock lock(mtx_);
+    return open_;
+  }
+
+  std::size_t Size() const {
+    std::shared_lock lock(mtx_);
+    return byID_.size();
+  }
+
+private:
+  static constexpr uint32_t kMaxOrdersPerPage = 500;
+
+  // Every open order, oldest first. Each page starts after the submission
+  // time of the previous page's last order; `after` is exclusive, so orders
+  // submitted in the same nanosecond across a page boundary can be missed.
+  template <class Client>
+  std::expected<std::vector<OrderResponse>, APIError>
+  ListOpen(Client &trading) {
+    OrderListParam p;
+    p.status = OrderStatus::open;
+    p.limit = kMaxOrdersPerPage;
+    p.direction = OrderDirection::asc;
+    std::vector<OrderResponse> out;
+    for (;;) {
+      auto page = trading.GetAllOrders(p);
+      if (!page) {
+        return std::unexpected(page.error());
+      }
+      const bool full = page->size() >= kMaxOrdersPerPage;
+      std::string last = page->empty() ? "" : page->back().submittedAt;
+      out.insert(out.end(), std::make_move_iterator(page->begin()),
+                 std::make_move_iterator(page->end()));
+      // Without a newer cursor the next page would repeat this one.
+      if (!full || last.empty() || p.after == last) {
+        return out;
+      }
+      p.after = std::move(last);
+    }
+  }
+
+  // Stores `order` unless the cached entry is newer. On equal timestamps
+  // the stream wins over REST. Called with mtx_ held exclusively.
+  void Merge(OrderResponse &&order, bool fromStream) {
+    auto it = byID_.find(order.id);
+    const bool wasOpen = it != byID_.end() && !IsClosed(it->second->status);
+    if (it != byID_.end()) {
+      const auto have = utils::ParseRfc3339Nanos(it->second->updatedAt);
+      const auto got = utils::ParseRfc3339Nanos(order.updatedAt);
+      if (have && got && (*got < *have || (*got == *have && !fromStream))) {
+        return;
+      }
+      if (it->second->clientOrderID != order.clientOrderID) {
+        EraseClientID(*it->second);
+      }
+    }
+
+    const bool isOpen = !IsClosed(order.status);
+    auto ptr = std::make_shared<const OrderResponse>(std::move(order));
+    if (!ptr->clientOrderID.empty()) {
+      byClientID_.insert_or_assign(ptr->clientOrderID, ptr);
+    }
+    const bool known = it != byID_.end();
+    if (known) {
+      it->second = ptr;
+    } else {
+      byID_.emplace(ptr->id, ptr);
+    }
+
+    open_ += isOpen;
+    open_ -= wasOpen;
+    if (!isOpen && (wasOpen || !known)) {
+      closed_.push_back(ptr->id);
+      Evict();
+    }
+  }
+
+  void EraseClientID(const OrderResponse &o) {
+    auto it = byClientID_.find(o.clientOrderID);
+    if (it != byClientID_.end() && it->second->id == o.id) {
+      byClientID_.erase(it);
+    }
+  }
+
+  void Evict() {
+    while (closed_.size() > retainClosed_) {
+      auto it = byID_.find(closed_.front());
+      if (it != byID_.end()) {
+        EraseClientID(*it->second);
+        byID_.erase(it);
+      }
+      closed_.pop_front();
+    }
+  }
+
+  mutable std::shared_mutex mtx_;
+  std::unordered_map<std::string, OrderPtr, SymbolHash, std::equal_to<>> byID_;
+  std::unordered_map<std::string, OrderPtr, SymbolHash, std::equal_to<>>
+      byClientID_;
+  // Closed order ids, oldest first, for eviction.
+  std::deque<std::string> closed_;
+  std::size_t open_{0};
+  const std::size_t retainClosed_;
+};
+
+} // namespace alpaca
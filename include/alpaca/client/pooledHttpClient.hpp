@@ -0,0 +1,252 @@
+#pragma once
+#include <alpaca/client/httpClient.hpp>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <expected>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+namespace alpaca {
+
+struct HttpPoolConfig {
+  // Keep-alive connections kept warm between requests.
+  std::size_t poolSize{4};
+  // Connections idle for longer than this are discarded instead of reused,
+  // since the server has most likely closed them already.
+  std::chrono::milliseconds idleTimeout{std::chrono::seconds{50}};
+  // Upper bound on concurrent requests. Requests above poolSize get a
+  // short-lived connection that is closed once the response is read.
+  std::size_t maxInFlight{4};
+};
+
+// Drop-in replacement for HttpClient that checks out one keep-alive
+// connection per request, so concurrent callers do not serialize on a single
+// socket and do not pay a TLS handshake after every server-side close.
+// Usable as the `Http` parameter of TradingClientT / MarketDataClientT.
+// `Conn` is the connection type; tests substitute one that needs no network.
+template <class Conn = httplib::SSLClient> class PooledHttpClientT {
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Connection {
+    std::unique_ptr<Conn> cli;
+    Clock::time_point lastUsed;
+  };
+
+  struct Pool {
+    detail::HostPort host;
+    std::string caCertPath;
+    httplib::Headers headers;
+    HttpPoolConfig cfg;
+    ResponseObserver observer;
+    std::unique_ptr<detail::EndpointMetrics> metrics;
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::vector<Connection> idle;
+    std::size_t inFlight{0};
+  };
+
+  std::unique_ptr<Conn> MakeConnection() const {
+    const auto &[host, port] = pool_->host;
+    auto cli = std::make_unique<Conn>(host, port);
+    cli->set_keep_alive(true);
+    if (!pool_->caCertPath.empty()) {
+      cli->set_ca_cert_path(pool_->caCertPath);
+    }
+    return cli;
+  }
+
+  // Failing to build a new connection (allocation, TLS context setup) is
+  // reported as a Connection error and gives the in-flight slot back.
+  std::expected<std::unique_ptr<Conn>, APIError> Checkout() noexcept {
+    bool counted = false;
+    try {
+      std::unique_lock lock(pool_->mtx);
+      pool_->cv.wait(
+          lock, [&] { return pool_->inFlight < pool_->cfg.maxInFlight; });
+      ++pool_->inFlight;
+      counted = true;
+
+      // LIFO: the most recently used connection is the most likely to be
+      // alive.
+      const auto now = Clock::now();
+      while (!pool_->idle.empty()) {
+        auto conn = std::move(pool_->idle.back());
+        pool_->idle.pop_back();
+        if (now - conn.lastUsed < pool_->cfg.idleTimeout) {
+          return std::move(conn.cli);
+        }
+      }
+
+      lock.unlock();
+      return MakeConnection();
+    } catch (const std::exception &e) {
+      if (counted) {
+        Checkin(nullptr, false);
+      }
+      return std::unexpected(APIError{
+          ErrorCode::Connection,
+          std::string("Cannot open a connection: ") + e.what()});
+    }
+  }
+
+  std::expected<httplib::Result, APIError>
+  Exchange(Req type, const std::string &path,
+           std::optional<std::string_view> body,
+           const std::optional<std::string> &content_type, std::string *sink,
+           detail::RequestTiming &timing) {
+    auto cli = Checkout();
+    if (!cli) {
+      return std::unexpected(std::move(cli.error()));
+    }
+    timing.Start(**cli);
+    auto resp = detail::Send(**cli, pool_->headers, type, path, body,
+                             content_type, sink, timing.FirstByte());
+    timing.Received();
+    // A transport failure leaves the socket in an unknown state; drop it.
+    Checkin(std::move(*cli), resp && *resp);
+    if (resp && pool_->observer && *resp) {
+      pool_->observer(**resp);
+    }
+    return resp;
+  }
+
+  void Checkin(std::unique_ptr<Conn> cli, bool reusable) {
+    {
+      std::lock_guard lock(pool_->mtx);
+      if (cli && reusable && pool_->idle.size() < pool_->cfg.poolSize) {
+        pool_->idle.push_back(Connection{std::move(cli), Clock::now()});
+      }
+      --pool_->inFlight;
+    }
+    pool_->cv.notify_one();
+  }
+
+public:
+  explicit PooledHttpClientT(const std::string &host,
+                            const httplib::Headers &headers,
+                            HttpPoolConfig cfg = {}) noexcept
+      : pool_(std::make_unique<Pool>()) {
+    pool_->host = detail::SplitHostPort(host);
+    pool_->headers = headers;
+    pool_->cfg = cfg;
+    if (pool_->cfg.maxInFlight == 0) {
+      pool_->cfg.maxInFlight = 1;
+    }
+    pool_->idle.reserve(pool_->cfg.poolSize);
+  }
+
+  // Opens poolSize connections up front by issuing `path` on each of them, so
+  // the TLS handshakes happen before the first latency-sensitive request.
+  std::expected<std::size_t, APIError>
+  Warm(const std::string &path) noexcept {
+    std::vector<std::unique_ptr<Conn>> conns;
+    std::optional<APIError> error;
+    const auto n = std::min(pool_->cfg.poolSize, pool_->cfg.maxInFlight);
+    for (std::size_t i = 0; i < n; ++i) {
+      auto cli = Checkout();
+      if (!cli) {
+        error = std::move(cli.error());
+        break;
+      }
+      conns.push_back(std::move(*cli));
+    }
+
+    std::size_t warmed = 0;
+    for (auto &cli : conns) {
+      auto resp = detail::Send(*cli, pool_->headers, Req::GET, path,
+                               std::nullopt, std::nullopt);
+      const bool ok = resp && *resp;
+      if (ok) {
+        ++warmed;
+      } else if (!error) {
+        error = resp ? APIError{ErrorCode::Transport,
+                                detail::to_string(resp->error())}
+                     : resp.error();
+      }
+      Checkin(std::move(cli), ok);
+    }
+
+    if (warmed == 0 && error) {
+      return std::unexpected(*error);
+    }
+    return warmed;
+  }
+
+  template <typename T>
+  std::expected<T, APIError>
+  Request(Req type, const std::string &path,
+          std::optional<std::string_view> body = std::nullopt,
+          std::optional<std::string> content_type = std::nullopt) noexcept {
+    auto *sink = detail::BodySink(type);
+    detail::RequestTiming timing(pool_->metrics.get());
+    auto resp = Exchange(type, path, body, content_type, sink, timing);
+    if (!resp) {
+      return std::unexpected(resp.error());
+    }
+    auto out = detail::Decode<T>(*resp, sink);
+    detail::TrimResponseBuffer(sink);
+    timing.Parsed(type, path);
+    return out;
+  }
+
+  // Same contract as HttpClient::RequestInto.
+  template <typename T>
+  std::expected<std::monostate, APIError>
+  RequestInto(T &out, Req type, const std::string &path,
+              std::optional<std::string_view> body = std::nullopt,
+              std::optional<std::string> content_type = std::nullopt) noexcept {
+    auto *sink = detail::BodySink(type);
+    detail::RequestTiming timing(pool_->metrics.get());
+    auto resp = Exchange(type, path, body, content_type, sink, timing);
+    if (!resp) {
+      return std::unexpected(resp.error());
+    }
+    auto done = detail::DecodeInto(*resp, sink, out);
+    detail::TrimResponseBuffer(sink);
+    timing.Parsed(type, path);
+    return done;
+  }
+
+  // Must be set before requests are issued; the observer itself may be called
+  // from several threads at once.
+  void SetResponseObserver(ResponseObserver observer) noexcept {
+    pool_->observer = std::move(observer);
+  }
+
+  // Same as HttpClient::SetInstrumentation; call before the first request.
+  // A request that had to open its connection counts as cold.
+  void SetInstrumentation(Instrumentation *in) {
+    pool_->metrics =
+        in ? std::make_unique<detail::EndpointMetrics>(*in) : nullptr;
+  }
+
+  // Same as HttpClient::SetCACertPath; call before the first request.
+  void SetCACertPath(const std::string &path) { pool_->caCertPath = path; }
+
+  std::size_t IdleConnections() const {
+    std::lock_guard lock(pool_->mtx);
+    return pool_->idle.size();
+  }
+
+  std::size_t InFlight() const {
+    std::lock_guard lock(pool_->mtx);
+    return pool_->inFlight;
+  }
+
+private:
+  std::unique_ptr<Pool> pool_;
+};
+
+using PooledHttpClient = PooledHttpClientT<>;
+
+} // namespace alpaca
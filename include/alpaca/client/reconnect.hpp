@@ -0,0 +1,238 @@
+#pragma once
+#include <alpaca/utils/backoff.hpp>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace alpaca {
+
+struct ReconnectPolicy {
+  bool enabled{true};
+  // Consecutive failed attempts before giving up; 0 retries forever.
+  int maxAttempts{0};
+  std::chrono::milliseconds baseBackoff{250};
+  std::chrono::milliseconds maxBackoff{30000};
+};
+
+// One outage, from the moment the connection was lost until the stream was
+// authenticated and subscribed again. Events in [down, up] were missed; fill
+// them from REST (bars, open orders) if they matter.
+struct ReconnectGap {
+  std::chrono::system_clock::time_point down;
+  std::chrono::system_clock::time_point up;
+  std::chrono::nanoseconds duration{};
+  int attempts{};
+};
+
+struct ReconnectStats {
+  uint64_t disconnects{};
+  uint64_t reconnects{};
+  // Attempts that did not lead to a working connection.
+  uint64_t failedAttempts{};
+  std::chrono::nanoseconds lastGap{};
+  std::chrono::nanoseconds maxGap{};
+  std::chrono::nanoseconds totalGap{};
+  // maxAttempts ran out and reconnecting stopped; cleared by the next Arm().
+  bool gaveUp{};
+};
+
+// Schedules reconnect attempts for a stream with jittered exponential
+// backoff and keeps outage statistics. Attempts run on a worker thread
+// owned by the Reconnector, never on the socket's own thread, so they are
+// free to stop and restart the socket.
+class Reconnector {
+private:
+  using Clock = std::chrono::steady_clock;
+
+public:
+  explicit Reconnector(ReconnectPolicy policy = {}) : policy_(policy) {}
+
+  Reconnector(const Reconnector &) = delete;
+  Reconnector &operator=(const Reconnector &) = delete;
+
+  ~Reconnector() {
+    {
+      std::lock_guard lock(mtx_);
+      shutdown_ = true;
+      pending_ = nullptr;
+    }
+    cv_.notify_all();
+    if (worker_.joinable()) {
+      worker_.join();
+    }
+  }
+
+  void SetPolicy(ReconnectPolicy policy) {
+    std::lock_guard lock(mtx_);
+    policy_ = policy;
+  }
+
+  // The connection dropped or an attempt failed: starts an outage if none is
+  // open and queues `attempt` to run after the next backoff delay. Does
+  // nothing while an attempt is already queued. False when reconnecting is
+  // disabled, cancelled or out of attempts; only the last sets
+  // Stats().gaveUp.
+  bool Schedule(std::function<void()> attempt) {
+    std::lock_guard lock(mtx_);
+    if (!policy_.enabled || cancelled_ || shutdown_ || stats_.gaveUp) {
+      return false;
+    }
+    if (!down_) {
+      down_ = Outage{std::chrono::system_clock::now(), Clock::now()};
+      ++stats_.disconnects;
+    }
+    if (pending_) {
+      return true;
+    }
+    if (attempts_ > 0) {
+      ++stats_.failedAttempts;
+    }
+    if (policy_.maxAttempts > 0 && attempts_ >= policy_.maxAttempts) {
+      stats_.gaveUp = true;
+      return false;
+    }
+    due_ = Clock::now() +
+           detail::BackoffDelay(attempts_, policy_.baseBackoff,
+                                policy_.maxBackoff);
+    ++attempts_;
+    pending_ = std::move(attempt);
+    if (!worker_.joinable()) {
+      worker_ = std::thread([this] { Run(); });
+    }
+    cv_.notify_all();
+    return true;
+  }
+
+  // The stream is live again. Closes the open outage, if any, and returns
+  // it; the next outage starts from the base delay.
+  std::optional<ReconnectGap> Restored() {
+    std::lock_guard lock(mtx_);
+    if (!down_) {
+      return std::nullopt;
+    }
+    ReconnectGap gap;
+    gap.down = down_->wall;
+    gap.up = std::chrono::system_clock::now();
+    gap.duration = Clock::now() - down_->steady;
+    gap.attempts = attempts_;
+    down_.reset();
+    attempts_ = 0;
+
+    ++stats_.reconnects;
+    stats_.lastGap = gap.duration;
+    stats_.maxGap = std::max(stats_.maxGap, gap.duration);
+    stats_.totalGap += gap.duration;
+    return gap;
+  }
+
+  // The caller closed the stream on purpose: drops the queued attempt and
+  // waits for a running one to finish. Schedule() is refused until the
+  // next Arm().
+  //
+  // Called from a socket callback (see CallbackScope) it does not wait: the
+  // running attempt may be stopping that socket and so joining the calling
+  // thread. The attempt then sees Cancelled() once it returns and must undo
+  // its connection itself.
+  void Cancel() {
+    std::unique_lock lock(mtx_);
+    cancelled_ = true;
+    pending_ = nullptr;
+    down_.reset();
+    attempts_ = 0;
+    if (Current() != this) {
+      cv_.wait(lock, [this] { return !running_; });
+    }
+  }
+
+  // Cancel() was called and no Arm() since.
+  bool Cancelled() const {
+    std::lock_guard lock(mtx_);
+    return cancelled_;
+  }
+
+  // Marks the calling thread, for its lifetime, as running a callback of
+  // the socket this Reconnector restarts.
+  class CallbackScope {
+  public:
+    explicit CallbackScope(const Reconnector &r) noexcept
+        : prev_(Current()) {
+      Current() = &r;
+    }
+    ~CallbackScope() { Current() = prev_; }
+
+    CallbackScope(const CallbackScope &) = delete;
+    CallbackScope &operator=(const CallbackScope &) = delete;
+
+  private:
+    const Reconnector *prev_;
+  };
+
+  // Allows Schedule() again after Cancel() or giving up; called when the
+  // caller connects.
+  void Arm() {
+    std::lock_guard lock(mtx_);
+    cancelled_ = false;
+    if (stats_.gaveUp) {
+      stats_.gaveUp = false;
+      attempts_ = 0;
+    }
+  }
+
+  ReconnectStats Stats() const {
+    std::lock_guard lock(mtx_);
+    return stats_;
+  }
+
+private:
+  static const Reconnector *&Current() noexcept {
+    thread_local const Reconnector *current = nullptr;
+    return current;
+  }
+
+  struct Outage {
+    std::chrono::system_clock::time_point wall;
+    Clock::time_point steady;
+  };
+
+  void Run() {
+    std::unique_lock lock(mtx_);
+    while (!shutdown_) {
+      if (!pending_) {
+        cv_.wait(lock);
+        continue;
+      }
+      if (Clock::now() < due_) {
+        cv_.wait_until(lock, due_);
+        continue;
+      }
+      auto attempt = std::move(pending_);
+      pending_ = nullptr;
+      running_ = true;
+      lock.unlock();
+      attempt();
+      lock.lock();
+      running_ = false;
+      cv_.notify_all();
+    }
+  }
+
+  mutable std::mutex mtx_;
+  std::condition_variable cv_;
+  ReconnectPolicy policy_;
+  std::function<void()> pending_;
+  Clock::time_point due_{};
+  std::optional<Outage> down_;
+  int attempts_{0};
+  bool running_{false};
+  bool cancelled_{false};
+  bool shutdown_{false};
+  ReconnectStats stats_;
+  std::thread worker_;
+};
+
+} // namespace alpaca
@@ -0,0 +1,350 @@
+#pragma once
+#include <alpaca/client/httpClient.hpp>
+#include <alpaca/utils/backoff.hpp>
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <expected>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <variant>
+
+namespace alpaca {
+
+enum class RequestPriority {
+  Low,    // market-data reads, backfills
+  Normal, // trading reads (account, positions, order lookups)
+  High,   // order submission, replacement and cancellation
+};
+
+// RequestScheduler replaces a requestsPerMinute that is not positive, and a
+// burst of 0, with the defaults; either would never admit a request.
+struct RateLimitConfig {
+  // Token bucket refill rate; Alpaca's default budget is 200 requests/minute.
+  double requestsPerMinute{200.0};
+  // Bucket capacity.
+  std::size_t burst{200};
+  // Tokens only High priority requests may spend, so cancels still go out
+  // after a backfill has drained the budget.
+  std::size_t reservedForHigh{20};
+  // Retries after a 429 (any method) or a 5xx (GET/DELETE only).
+  int maxRetries{3};
+  std::chrono::milliseconds baseBackoff{250};
+  std::chrono::milliseconds maxBackoff{8000};
+};
+
+inline RequestPriority ClassifyRequest(Req type,
+                                       std::string_view path) noexcept {
+  const bool orders = path.starts_with("/v2/orders") ||
+                      path.starts_with("/v2/positions");
+  if (orders && type != Req::GET) {
+    return RequestPriority::High;
+  }
+  if (path.starts_with("/v2/stocks") || path.starts_with("/v1beta")) {
+    return RequestPriority::Low;
+  }
+  return RequestPriority::Normal;
+}
+
+// Token bucket shared by every request of one client. Tracks the server's view
+// of the budget from X-RateLimit-* headers and lets waiters through strictly by
+// priority.
+class RequestScheduler {
+private:
+  using Clock = std::chrono::steady_clock;
+
+  void Refill(Clock::time_point now) {
+    const std::chrono::duration<double> dt = now - lastRefill_;
+    lastRefill_ = now;
+    tokens_ = std::min(static_cast<double>(cfg_.burst),
+                       tokens_ + dt.count() * cfg_.requestsPerMinute / 60.0);
+  }
+
+  bool HigherWaiting(RequestPriority p) const {
+    for (auto q = static_cast<std::size_t>(p) + 1; q < waiting_.size(); ++q) {
+      if (waiting_[q] > 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  double Floor(RequestPriority p) const {
+    if (p == RequestPriority::High) {
+      return 0.0;
+    }
+    return static_cast<double>(
+        std::min(cfg_.reservedForHigh, cfg_.burst - 1));
+  }
+
+  static RateLimitConfig Validated(RateLimitConfig cfg) noexcept {
+    // Also catches NaN.
+    if (!(cfg.requestsPerMinute > 0.0)) {
+      cfg.requestsPerMinute = RateLimitConfig{}.requestsPerMinute;
+    }
+    if (cfg.burst == 0) {
+      cfg.burst = RateLimitConfig{}.burst;
+    }
+    return cfg;
+  }
+
+public:
+  explicit RequestScheduler(RateLimitConfig cfg = {}) noexcept
+      : cfg_(Validated(cfg)), tokens_(static_cast<double>(cfg_.burst)),
+        lastRefill_(Clock::now()) {}
+
+  // Blocks until the bucket has a token this priority may spend, the server
+  // is not asking us to back off, and no higher priority request is waiting.
+  void Acquire(RequestPriority p) {
+    const auto idx = static_cast<std::size_t>(p);
+    std::unique_lock lock(mtx_);
+    ++waiting_[idx];
+    while (true) {
+      const auto now = Clock::now();
+      Refill(now);
+      if (now >= pausedUntil_ && !HigherWaiting(p) &&
+          tokens_ >= Floor(p) + 1.0) {
+        break;
+      }
+
+      if (now < pausedUntil_) {
+        cv_.wait_until(lock, pausedUntil_);
+      } else if (HigherWaiting(p)) {
+        // Woken by notify_all once the higher priority request gets through.
+        cv_.wait(lock);
+      } else {
+        const std::chrono::duration<double> refill{
+            (Floor(p) + 1.0 - tokens_) * 60.0 / cfg_.requestsPerMinute};
+        cv_.wait_until(
+            lock, now + std::chrono::duration_cast<Clock::duration>(refill));
+      }
+    }
+    --waiting_[idx];
+    tokens_ -= 1.0;
+    lock.unlock();
+    cv_.notify_all();
+  }
+
+  // Reconciles the local bucket with the server's remaining budget.
+  void Observe(int status, std::optional<long long> remaining,
+               std::optional<long long> resetEpochSeconds) {
+    {
+      std::lock_guard lock(mtx_);
+      const auto now = Clock::now();
+      Refill(now);
+
+      std::optional<Clock::time_point> reset;
+      if (resetEpochSeconds) {
+        const auto wall = std::chrono::sys_seconds{
+            std::chrono::seconds{*resetEpochSeconds}};
+        const auto delta = std::max(wall - std::chrono::system_clock::now(),
+                                    std::chrono::system_clock::duration{});
+        reset = now + std::chrono::duration_cast<Clock::duration>(delta);
+      }
+
+      if (remaining) {
+        tokens_ = std::min(tokens_, static_cast<double>(*remaining));
+        if (*remaining <= 0 && reset) {
+          pausedUntil_ = std::max(pausedUntil_, *reset);
+        }
+      }
+      if (status == 429 && reset) {
+        pausedUntil_ = std::max(pausedUntil_, *reset);
+      }
+    }
+    cv_.notify_all();
+  }
+
+  void Observe(const httplib::Response &resp) {
+    auto header = [&](const char *key) -> std::optional<long long> {
+      if (!resp.has_header(key)) {
+        return std::nullopt;
+      }
+      const auto v = resp.get_header_value(key);
+      long long out{};
+      auto [ptr, ec] = std::from_chars(v.data(), v.data() + v.size(), out);
+      if (ec != std::errc{}) {
+        return std::nullopt;
+      }
+      return out;
+    };
+    Observe(resp.status, header("X-RateLimit-Remaining"),
+            header("X-RateLimit-Reset"));
+  }
+
+  // Holds every request back for `d`, e.g. after a 429 without reset header.
+  void PauseFor(std::chrono::milliseconds d) {
+    {
+      std::lock_guard lock(mtx_);
+      pausedUntil_ = std::max(pausedUntil_, Clock::now() + d);
+    }
+    cv_.notify_all();
+  }
+
+  std::chrono::milliseconds BackoffDelay(int attempt) const {
+    return detail::BackoffDelay(attempt, cfg_.baseBackoff, cfg_.maxBackoff);
+  }
+
+  double Tokens() {
+    std::lock_guard lock(mtx_);
+    Refill(Clock::now());
+    return tokens_;
+  }
+
+  const RateLimitConfig &Config() const noexcept { return cfg_; }
+
+private:
+  RateLimitConfig cfg_;
+  std::mutex mtx_;
+  std::condition_variable cv_;
+  double tokens_;
+  Clock::time_point lastRefill_;
+  Clock::time_point pausedUntil_{};
+  std::array<std::size_t, 3> waiting_{};
+};
+
+// Wraps any transport with the same Request<T> shape and puts a
+// RequestScheduler in front of it. Usable as the `Http` parameter of
+// TradingClientT / MarketDataClientT.
+template <class Http = HttpClient> class ScheduledHttpClientT {
+private:
+  static bool ShouldRetry(Req type, const APIError &e) noexcept {
+    if (e.code != ErrorCode::HTTPCode || !e.status) {
+      return false;
+    }
+    if (*e.status == 429) {
+      return true;
+    }
+    // A 5xx on POST/PATCH may still have been applied; never resend those.
+    return *e.status >= 500 && (type == Req::GET || type == Req::DELETE);
+  }
+
+  void Hook() {
+    if constexpr (requires(Http &h) {
+                    h.SetResponseObserver(ResponseObserver{});
+                  }) {
+      inner_.SetResponseObserver(
+          [s = sched_.get()](const httplib::Response &r) { s->Observe(r); });
+    }
+  }
+
+public:
+  explicit ScheduledHttpClientT(const std::string &host,
+                                const httplib::Headers &headers,
+                                RateLimitConfig cfg = {})
+      : inner_(host, headers),
+        sched_(std::make_unique<RequestScheduler>(cfg)) {
+    Hook();
+  }
+
+  ScheduledHttpClientT(Http inner, RateLimitConfig cfg)
+      : inner_(std::move(inner)),
+        sched_(std::make_unique<RequestScheduler>(cfg)) {
+    Hook();
+  }
+
+  // Blocks until the scheduler admits the request and any retries are done.
+  // Never throws, so the noexcept TradingClientT / MarketDataClientT methods
+  // can call it; a failure to schedule is returned as an Unknown error.
+  template <typename T>
+  std::expected<T, APIError>
+  Request(Req type, const std::string &path,
+          std::optional<std::string_view> body = std::nullopt,
+          std::optional<std::string> content_type = std::nullopt) noexcept {
+    return Scheduled(type, path, [&] {
+      return inner_.template Request<T>(type, path, body, content_type);
+    });
+  }
+
+  // Requires Http::RequestInto (HttpClient, PooledHttpClient).
+  template <typename T>
+  std::expected<std::monostate, APIError>
+  RequestInto(T &out, Req type, const std::string &path,
+              std::optional<std::string_view> body = std::nullopt,
+              std::optional<std::string> content_type = std::nullopt) noexcept {
+    return Scheduled(type, path, [&] {
+      return inner_.RequestInto(out, type, path, body, content_type);
+    });
+  }
+
+  // Passes `in` on to the inner transport and also records, once per
+  // request, "http.schedule_wait <method> <path>": the time it spent waiting
+  // for the scheduler, summed over its attempts and including the backoff
+  // between them. Call before the first request.
+  void SetInstrumentation(Instrumentation *in) {
+    metrics_ = in ? std::make_unique<detail::EndpointMetrics>(*in) : nullptr;
+    inner_.SetInstrumentation(in);
+  }
+
+  RequestScheduler &Scheduler() noexcept { return *sched_; }
+  Http &Inner() noexcept { return inner_; }
+
+private:
+  // Runs `send` once the scheduler admits it, retrying 429s and safe 5xxs;
+  // anything thrown on the way becomes an error result.
+  template <class F>
+  auto Scheduled(Req type, const std::string &path, F &&send) noexcept
+      -> decltype(send()) {
+    try {
+      return Attempts(type, path, send);
+    } catch (const std::exception &e) {
+      return std::unexpected(
+          APIError{ErrorCode::Unknown,
+                   std::string("Cannot schedule the request: ") + e.what()});
+    }
+  }
+
+  template <class F>
+  auto Attempts(Req type, const std::string &path, F &send)
+      -> decltype(send()) {
+    using Clock = std::chrono::steady_clock;
+    const auto priority = ClassifyRequest(type, path);
+    // Everything outside send() is time spent waiting on the scheduler.
+    const auto queued = metrics_ ? Clock::now() : Clock::time_point{};
+    Clock::duration sending{};
+    for (int attempt = 0;; ++attempt) {
+      sched_->Acquire(priority);
+      const auto sent = metrics_ ? Clock::now() : Clock::time_point{};
+      auto resp = send();
+      const bool done = resp || attempt >= sched_->Config().maxRetries ||
+                        !ShouldRetry(type, resp.error());
+      if (metrics_) {
+        const auto now = Clock::now();
+        sending += now - sent;
+        if (done) {
+          metrics_->Find(type, path)
+              .Get(detail::EndpointMetrics::kScheduleWait)
+              .Record(now - queued - sending);
+        }
+      }
+      if (done) {
+        return resp;
+      }
+
+      const auto delay = sched_->BackoffDelay(attempt);
+      if (*resp.error().status == 429) {
+        // The whole budget is exhausted, not just this request's.
+        sched_->PauseFor(delay);
+      } else {
+        std::this_thread::sleep_for(delay);
+      }
+    }
+  }
+
+  Http inner_;
+  std::unique_ptr<RequestScheduler> sched_;
+  std::unique_ptr<detail::EndpointMetrics> metrics_;
+};
+
+using ScheduledHttpClient = ScheduledHttpClientT<HttpClient>;
+
+} // namespace alpaca
@@ -0,0 +1,374 @@
+#pragma once
+#include <alpaca/client/environment.hpp>
+#include <alpaca/client/marketDataStream.hpp>
+#include <alpaca/client/websocketClient.hpp>
+#include <alpaca/models/streaming/marketdata.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace alpaca {
+
+struct ShardHealth {
+  // Distinct symbols routed to the shard.
+  std::size_t symbols{};
+  bool connected{};
+  uint64_t frames{};
+  std::chrono::steady_clock::time_point lastFrame{};
+  DeliveryStats delivery;
+  ReconnectStats reconnects;
+  // The server refused the shard's connection; see kConnectionLimitExceeded.
+  bool refused{};
+};
+
+// Spreads one subscription over up to `maxConnections` market-data
+// connections, each decoded on its own socket thread. A symbol lives on a
+// single shard for all of its channels (so its events stay in order) and
+// new symbols go to the least loaded shard. All shards intern into the same
+// SymbolTable, so ids agree across them.
+//
+// With queued or conflated delivery, Poll()/Drain() merge the shards' rings
+// for one consumer thread. With inline delivery the callbacks are shared by
+// every shard and may run concurrently on different socket threads.
+//
+// Alpaca limits concurrent market-data connections per account (one on most
+// plans). When the server refuses a shard for that reason, the shard stops
+// reconnecting and its symbols move to the shards that are up, and no
+// further shard is opened until the next Connect. A refused shard that was
+// the only one up keeps retrying with its symbols instead.
+template <class Env = Environment, class Ws = WebSocketClient>
+class ShardedMarketDataStreamT {
+public:
+  using Stream = MarketDataStreamT<Env, Ws>;
+
+  ShardedMarketDataStreamT(
+      const Env &env, std::size_t maxConnections,
+      std::function<Ws(std::size_t shard)> makeWs = [](std::size_t) {
+        return Ws{};
+      })
+      : shards_(std::max<std::size_t>(maxConnections, 1)) {
+    for (std::size_t i = 0; i < shards_.size(); ++i) {
+      shards_[i].stream = std::make_unique<Stream>(env, makeWs(i));
+    }
+  }
+
+  // Shards intern into `table` instead of SymbolTable::Global(). Call before
+  // Connect.
+  void UseSymbolTable(SymbolTable &table) {
+    for (auto &s : shards_) {
+      s.stream->UseSymbolTable(table);
+    }
+  }
+
+  SymbolTable &Symbols() const noexcept {
+    return shards_.front().stream->Symbols();
+  }
+
+  void SetReconnectPolicy(ReconnectPolicy policy) {
+    std::lock_guard lock(mtx_);
+    policy_ = policy;
+    for (auto &s : shards_) {
+      s.stream->SetReconnectPolicy(policy);
+    }
+  }
+
+  // Same as MarketDataStreamT::SetInstrumentation; shards record into the
+  // same histograms, so each covers the whole feed. Call before Connect.
+  void SetInstrumentation(Instrumentation *in) {
+    for (auto &s : shards_) {
+      s.stream->SetInstrumentation(in);
+    }
+  }
+
+  // Partitions `sub` and connects every shard that received symbols; the
+  // others connect once Subscribe() routes something to them. After
+  // Disconnect it starts over: shards the server refused are tried again.
+  void Connect(MarketDataSubscription sub, MarketDataCallbacks cbs,
+               MarketDataDelivery delivery = {}) {
+    std::lock_guard lock(mtx_);
+    feed_ = sub.feed;
+    cbs_ = std::move(cbs);
+    delivery_ = delivery;
+    owner_.clear();
+    capped_ = false;
+    for (auto &s : shards_) {
+      s.symbols = 0;
+      s.refused = false;
+      // Refuse() turned reconnecting off.
+      s.stream->SetReconnectPolicy(policy_);
+    }
+    auto &parts = Route(sub);
+    for (std::size_t i = 0; i < shards_.size(); ++i) {
+      auto &s = shards_[i];
+      if (s.symbols > 0) {
+        parts[i].feed = feed_;
+        s.stream->Connect(std::move(parts[i]), ShardCallbacks(i), delivery_);
+        s.live.store(true, std::memory_order_release);
+      }
+    }
+  }
+
+  void Disconnect() {
+    // Stopping a socket waits for its thread, which may be in Refuse()
+    // waiting for mtx_.
+    std::vector<Stream *> live;
+    {
+      std::lock_guard lock(mtx_);
+      for (auto &s : shards_) {
+        if (s.live) {
+          s.live.store(false, std::memory_order_release);
+          live.push_back(s.stream.get());
+        }
+      }
+    }
+    for (auto *stream : live) {
+      stream->Disconnect();
+    }
+  }
+
+  // Same contract as MarketDataStreamT::Subscribe, across shards.
+  bool Subscribe(const MarketDataSubscription &add) {
+    std::lock_guard lock(mtx_);
+    bool changed = false;
+    auto &parts = Route(add);
+    for (std::size_t i = 0; i < shards_.size(); ++i) {
+      auto &s = shards_[i];
+      auto &part = parts[i];
+      if (part.trades.empty() && part.quotes.empty() && part.bars.empty()) {
+        continue;
+      }
+      if (s.live) {
+        changed |= s.stream->Subscribe(part);
+      } else {
+        part.feed = feed_;
+        s.stream->Connect(std::move(part), ShardCallbacks(i), delivery_);
+        s.live.store(true, std::memory_order_release);
+        changed = true;
+      }
+    }
+    return changed;
+  }
+
+  // Same contract as MarketDataStreamT::Unsubscribe, across shards. A shard
+  // left without symbols stays connected.
+  bool Unsubscribe(const MarketDataSubscription &remove) {
+    std::lock_guard lock(mtx_);
+    bool changed = false;
+    for (std::size_t i = 0; i < shards_.size(); ++i) {
+      MarketDataSubscription part;
+      for (auto list : kSubscriptionLists) {
+        for (const auto &sym : remove.*list) {
+          if (auto it = owner_.find(sym); it != owner_.end() &&
+                                          it->second == i) {
+            (part.*list).push_back(sym);
+          }
+        }
+      }
+      if (shards_[i].live) {
+        changed |= shards_[i].stream->Unsubscribe(part);
+      }
+    }
+    // Symbols subscribed on no channel are free to move on their next
+    // Subscribe.
+    for (auto list : kSubscriptionLists) {
+      for (const auto &sym : remove.*list) {
+        auto it = owner_.find(sym);
+        if (it == owner_.end()) {
+          continue;
+        }
+        const auto want = shards_[it->second].stream->Subscription();
+        const bool used = std::ranges::any_of(kSubscriptionLists, [&](auto l) {
+          return std::ranges::find(want.*l, sym) != (want.*l).end();
+        });
+        if (!used) {
+          --shards_[it->second].symbols;
+          owner_.erase(it);
+        }
+      }
+    }
+    return changed;
+  }
+
+  // Consumer side; call from one thread only. Shards are visited round
+  // robin so a busy one cannot starve the others.
+  std::optional<MarketDataEvent> Poll() {
+    for (std::size_t k = 0; k < shards_.size(); ++k) {
+      auto &s = shards_[NextShard()];
+      if (!s.live.load(std::memory_order_acquire)) {
+        continue;
+      }
+      if (auto e = s.stream->Poll()) {
+        return e;
+      }
+    }
+    return std::nullopt;
+  }
+
+  template <class F>
+  std::size_t Drain(F &&f,
+                    std::size_t max = std::numeric_limits<std::size_t>::max()) {
+    std::size_t n = 0;
+    for (std::size_t k = 0; k < shards_.size() && n < max; ++k) {
+      auto &s = shards_[NextShard()];
+      if (s.live.load(std::memory_order_acquire)) {
+        n += s.stream->Drain(f, max - n);
+      }
+    }
+    return n;
+  }
+
+  std::size_t ShardCount() const noexcept { return shards_.size(); }
+
+  // Shard that carries `symbol`, if it is subscribed.
+  std::optional<std::size_t> ShardOf(std::string_view symbol) const {
+    std::lock_guard lock(mtx_);
+    if (auto it = owner_.find(symbol); it != owner_.end()) {
+      return it->second;
+    }
+    return std::nullopt;
+  }
+
+  std::vector<ShardHealth> Health() const {
+    std::lock_guard lock(mtx_);
+    std::vector<ShardHealth> out;
+    out.reserve(shards_.size());
+    for (const auto &s : shards_) {
+      ShardHealth h;
+      h.symbols = s.symbols;
+      h.connected = s.live && s.stream->IsConnected();
+      h.frames = s.stream->FramesReceived();
+      h.lastFrame = s.stream->LastFrameTime();
+      h.delivery = s.stream->Stats();
+      h.reconnects = s.stream->GetReconnectStats();
+      h.refused = s.refused;
+      out.push_back(h);
+    }
+    return out;
+  }
+
+private:
+  struct Shard {
+    std::unique_ptr<Stream> stream;
+    std::size_t symbols{0};
+    // Set once the shard's delivery queues exist; read by the consumer. A
+    // refused shard stays live so its queued events can still be taken.
+    std::atomic<bool> live{false};
+    bool refused{false};
+  };
+
+  // Whether new symbols may go to shard `i`. Called with mtx_ held.
+  bool Open(std::size_t i) const {
+    const auto &s = shards_[i];
+    return !s.refused && (!capped_ || s.live);
+  }
+
+  // Splits `sub` by owning shard into parts_, assigning unseen symbols to
+  // the open shard with the fewest. Called with mtx_ held.
+  std::vector<MarketDataSubscription> &Route(
+      const MarketDataSubscription &sub) {
+    parts_.assign(shards_.size(), MarketDataSubscription{});
+    for (auto list : kSubscriptionLists) {
+      for (const auto &sym : sub.*list) {
+        auto it = owner_.find(sym);
+        if (it == owner_.end()) {
+          std::optional<std::size_t> least;
+          for (std::size_t i = 0; i < shards_.size(); ++i) {
+            if (Open(i) &&
+                (!least || shards_[i].symbols < shards_[*least].symbols)) {
+              least = i;
+            }
+          }
+          if (!least) {
+            continue;
+          }
+          ++shards_[*least].symbols;
+          it = owner_.emplace(sym, *least).first;
+        }
+        (parts_[it->second].*list).push_back(sym);
+      }
+    }
+    return parts_;
+  }
+
+  // The user's callbacks, with connection-limit errors on shard `i` seen
+  // first by Refuse().
+  MarketDataCallbacks ShardCallbacks(std::size_t i) {
+    auto cbs = cbs_;
+    cbs.onError = [this, i, user = cbs_.onError](const APIError &e) {
+      if (e.status == kConnectionLimitExceeded) {
+        Refuse(i);
+      }
+      if (user) {
+        user(e);
+      }
+    };
+    return cbs;
+  }
+
+  // Runs on shard `i`'s socket thread. Moves the symbols of a shard the
+  // server turned away to the shards that are up and stops opening others.
+  void Refuse(std::size_t i) {
+    std::lock_guard lock(mtx_);
+    auto &s = shards_[i];
+    const bool othersUp = std::ranges::any_of(shards_, [&](const Shard &o) {
+      return &o != &s && o.live && !o.refused;
+    });
+    if (s.refused || !othersUp) {
+      return;
+    }
+    s.refused = true;
+    capped_ = true;
+    // The server keeps refusing until another connection closes.
+    s.stream->SetReconnectPolicy(ReconnectPolicy{.enabled = false});
+
+    const auto moved = s.stream->Subscription();
+    for (auto list : kSubscriptionLists) {
+      for (const auto &sym : moved.*list) {
+        owner_.erase(sym);
+      }
+    }
+    s.symbols = 0;
+    const auto &parts = Route(moved);
+    for (std::size_t j = 0; j < shards_.size(); ++j) {
+      const auto &part = parts[j];
+      if (!part.trades.empty() || !part.quotes.empty() || !part.bars.empty()) {
+        shards_[j].stream->Subscribe(part);
+      }
+    }
+  }
+
+  std::size_t NextShard() noexcept {
+    const auto i = next_;
+    next_ = next_ + 1 == shards_.size() ? 0 : next_ + 1;
+    return i;
+  }
+
+  mutable std::mutex mtx_;
+  std::vector<Shard> shards_;
+  std::vector<MarketDataSubscription> parts_;
+  std::unordered_map<std::string, std::size_t, SymbolHash, std::equal_to<>>
+      owner_;
+  std::string feed_;
+  MarketDataCallbacks cbs_;
+  MarketDataDelivery delivery_;
+  // As last given to SetReconnectPolicy; Connect restores it on every shard.
+  ReconnectPolicy policy_;
+  // Set once a shard was refused: only shards already up take symbols.
+  bool capped_{false};
+  std::size_t next_{0};
+};
+
+using ShardedMarketDataStream =
+    ShardedMarketDataStreamT<Environment, WebSocketClient>;
+
+} // namespace alpaca
@@ -1,12 +1,17 @@
 #pragma once
 #include <alpaca/client/environment.hpp>
+#include <alpaca/client/reconnect.hpp>
 #include <alpaca/client/websocketClient.hpp>
 #include <alpaca/models/streaming/serialize.hpp>
 #include <alpaca/models/streaming/tradeupdate.hpp>
+#include <alpaca/utils/latency.hpp>
 #include <atomic>
+#include <chrono>
 #include <format>
 #include <glaze/glaze.hpp>
 #include <string>
+#include <string_view>
+#include <type_traits>
 
 namespace alpaca {
 
@@ -16,36 +21,122 @@ public:
   explicit TradeUpdateStreamT(const Env &env, Ws ws = Ws{})
       : env_(env), ws_(std::move(ws)) {}
 
+  // Closes the socket while the members its callbacks touch still exist;
+  // ws_ itself is destroyed after them.
+  ~TradeUpdateStreamT() { Disconnect(); }
+
+  // Reconnects after an unexpected close, replaying auth and listen. On by
+  // default.
+  void SetReconnectPolicy(ReconnectPolicy policy) {
+    reconnector_.SetPolicy(policy);
+  }
+
+  ReconnectStats GetReconnectStats() const { return reconnector_.Stats(); }
+
+  // Records into `in` "tu.decode", reading each frame, and "tu.callback",
+  // onLeanUpdate and onUpdate of each trade update together. For each
+  // trade update also "tu.lag.exchange", its `at` to receipt on the wall
+  // clock, and "tu.lag.callback", receipt to the callbacks. Plus
+  // "ws.handle trade" when Ws supports it. Null turns it off. Call before
+  // Connect.
+  void SetInstrumentation(Instrumentation *in) {
+    decodeHist_ = in ? &in->Histogram("tu.decode") : nullptr;
+    callbackHist_ = in ? &in->Histogram("tu.callback") : nullptr;
+    exchangeLagHist_ = in ? &in->Histogram("tu.lag.exchange") : nullptr;
+    callbackLagHist_ = in ? &in->Histogram("tu.lag.callback") : nullptr;
+    if constexpr (requires { ws_.SetInstrumentation(in, "trade"); }) {
+      ws_.SetInstrumentation(in, "trade");
+    }
+  }
+
   void Connect(TradeUpdateCallbacks cbs) {
     cbs_ = std::move(cbs);
     state_ = State::Connecting;
+    reconnector_.Arm();
+    ws_.Connect(env_.GetTradeStreamUrl(), MakeWsCallbacks());
+  }
+
+  void Disconnect() {
+    reconnector_.Cancel();
+    ws_.Disconnect();
+  }
 
+  bool IsConnected() const { return ws_.IsConnected(); }
+
+private:
+  enum class State { Disconnected, Connecting, Authenticated, Subscribed };
+
+  WsCallbacks MakeWsCallbacks() {
     WsCallbacks wsCbs;
-    wsCbs.onOpen = [this]() { SendAuth(); };
-    wsCbs.onMessage = [this](const std::string &raw) { OnMessage(raw); };
+    wsCbs.onOpen = [this]() {
+      Reconnector::CallbackScope scope(reconnector_);
+      SendAuth();
+    };
+    // A Ws that does not stamp frames gets them stamped here.
+    wsCbs.onMessage = [this](const std::string &raw) {
+      Reconnector::CallbackScope scope(reconnector_);
+      OnMessage(raw, ReceiveTime::Now());
+    };
+    wsCbs.onTimedMessage = [this](const std::string &raw,
+                                  const ReceiveTime &received) {
+      Reconnector::CallbackScope scope(reconnector_);
+      OnMessage(raw, received);
+    };
     wsCbs.onClose = [this]() {
+      Reconnector::CallbackScope scope(reconnector_);
       state_ = State::Disconnected;
       if (cbs_.onDisconnected)
         cbs_.onDisconnected();
+      ScheduleReconnect();
     };
     wsCbs.onError = [this](const std::string &reason) {
+      Reconnector::CallbackScope scope(reconnector_);
       if (cbs_.onError)
         cbs_.onError(APIError{ErrorCode::Connection, reason});
+      if (!ws_.IsConnected())
+        ScheduleReconnect();
     };
-    ws_.Connect(env_.GetTradeStreamUrl(), std::move(wsCbs));
+    return wsCbs;
   }
 
-  void Disconnect() { ws_.Disconnect(); }
-
-  bool IsConnected() const { return ws_.IsConnected(); }
+  // Reports through onError, once, when the policy's attempts run out.
+  void ScheduleReconnect() {
+    if (reconnector_.Stats().gaveUp) {
+      return;
+    }
+    const bool scheduled = reconnector_.Schedule([this] {
+      state_ = State::Connecting;
+      ws_.Connect(env_.GetTradeStreamUrl(), MakeWsCallbacks());
+      // Disconnect() ran in a socket callback meanwhile and did not wait.
+      if (reconnector_.Cancelled()) {
+        ws_.Disconnect();
+      }
+    });
+    if (!scheduled && reconnector_.Stats().gaveUp && cbs_.onError)
+      cbs_.onError(
+          APIError{ErrorCode::Connection, "Reconnect attempts exhausted"});
+  }
 
-private:
-  enum class State { Disconnected, Connecting, Authenticated, Subscribed };
+  void OnMessage(const std::string &raw, const ReceiveTime &received) {
+    if (cbs_.onUpdate) {
+      Decode<OrderResponse>(raw, received);
+    } else {
+      Decode<TradeUpdateOrderLeanWire>(raw, received);
+    }
+  }
 
-  void OnMessage(const std::string &raw) {
-    // Step 1: determine the stream type
-    TradingStreamBaseWire base;
-    auto err = glz::read<glz::opts{.error_on_unknown_keys = false}>(base, raw);
+  // One read per frame; with only onLeanUpdate set, `Order` is the lean
+  // wire and the rest of the order is skipped unparsed.
+  template <class Order>
+  void Decode(const std::string &raw, const ReceiveTime &received) {
+    using Clock = std::chrono::steady_clock;
+    const auto start = decodeHist_ ? Clock::now() : Clock::time_point{};
+    TradingStreamWire<Order> msg;
+    auto err = glz::read<glz::opts{.error_on_unknown_keys = false}>(msg, raw);
+    const auto decoded = decodeHist_ ? Clock::now() : Clock::time_point{};
+    if (decodeHist_) {
+      decodeHist_->Record(decoded - start);
+    }
     if (err) {
       if (cbs_.onError)
         cbs_.onError(
@@ -53,8 +144,8 @@ private:
       return;
     }
 
-    if (base.stream == "authorization") {
-      if (base.data.status == "authorized") {
+    if (msg.stream == "authorization") {
+      if (msg.data.status == "authorized") {
         state_ = State::Authenticated;
         if (cbs_.onConnected)
           cbs_.onConnected();
@@ -64,31 +155,72 @@ private:
           cbs_.onError(APIError{ErrorCode::Connection,
                                 "Trade stream authorization failed"});
       }
-    } else if (base.stream == "listening") {
+    } else if (msg.stream == "listening") {
       state_ = State::Subscribed;
-    } else if (base.stream == "trade_updates") {
-      // Step 2: full parse for trade update payload
-      TradeUpdateEnvelopeWire envelope;
-      auto err2 =
-          glz::read<glz::opts{.error_on_unknown_keys = false}>(envelope, raw);
-      if (err2) {
-        if (cbs_.onError)
-          cbs_.onError(
-              APIError{ErrorCode::JSONParsing, glz::format_error(err2, raw)});
-        return;
+      if (auto gap = reconnector_.Restored(); gap && cbs_.onReconnected)
+        cbs_.onReconnected(*gap);
+    } else if (msg.stream == "trade_updates") {
+      auto &data = msg.data;
+      const auto event = ParseTradeUpdateEvent(data.event);
+      RecordLag(data.at, received);
+      if (cbs_.onLeanUpdate) {
+        auto lean = MakeLean(event, data);
+        lean.received = received;
+        cbs_.onLeanUpdate(std::move(lean));
       }
-
-      if (cbs_.onUpdate) {
+      if constexpr (std::is_same_v<Order, OrderResponse>) {
         TradeUpdate update;
-        update.event = ParseTradeUpdateEvent(envelope.data.event);
-        update.at = envelope.data.at;
-        update.order = envelope.data.order;
+        update.event = event;
+        update.at = std::move(data.at);
+        update.price = data.price;
+        update.qty = data.qty;
+        update.positionQty = data.positionQty;
+        update.order = std::move(data.order);
+        update.received = received;
         cbs_.onUpdate(std::move(update));
       }
+      if (callbackHist_) {
+        callbackHist_->Record(Clock::now() - decoded);
+      }
     }
     // Other stream types are silently ignored
   }
 
+  void RecordLag(std::string_view at, const ReceiveTime &received) {
+    if (!exchangeLagHist_) {
+      return;
+    }
+    if (const auto ns = utils::ParseRfc3339Nanos(at)) {
+      const std::chrono::sys_time<std::chrono::nanoseconds> sent{
+          std::chrono::nanoseconds{*ns}};
+      exchangeLagHist_->Record(received.wall - sent);
+    }
+    callbackLagHist_->Record(std::chrono::steady_clock::now() -
+                             received.mono);
+  }
+
+  template <class Order>
+  static LeanTradeUpdate MakeLean(TradeUpdateEvent event,
+                                  const TradingStreamDataWire<Order> &data) {
+    LeanTradeUpdate lean;
+    lean.event = event;
+    lean.at = data.at;
+    lean.orderID = data.order.id;
+    lean.clientOrderID = data.order.clientOrderID;
+    if constexpr (std::is_same_v<Order, OrderResponse>) {
+      lean.symbol = data.order.symbol.value_or("");
+    } else {
+      lean.symbol = data.order.symbol;
+    }
+    lean.status = data.order.status;
+    lean.filledQty = data.order.filledQty;
+    lean.filledAvgPrice = data.order.filledAvgPrice;
+    lean.price = data.price;
+    lean.qty = data.qty;
+    lean.positionQty = data.positionQty;
+    return lean;
+  }
+
   void SendAuth() {
     ws_.Send(std::format(R"({{"action":"auth","key":"{}","secret":"{}"}})",
                          env_.GetID(), env_.GetSecret()));
@@ -99,9 +231,15 @@ private:
   }
 
   Env env_;
+  // Outlives ws_, whose shutdown may still report a close.
+  Reconnector reconnector_;
   Ws ws_;
   TradeUpdateCallbacks cbs_;
   std::atomic<State> state_{State::Disconnected};
+  HdrHistogram *decodeHist_{nullptr};
+  HdrHistogram *callbackHist_{nullptr};
+  HdrHistogram *exchangeLagHist_{nullptr};
+  HdrHistogram *callbackLagHist_{nullptr};
 };
 
 using TradeUpdateStream = TradeUpdateStreamT<Environment, WebSocketClient>;
@@ -1,6 +1,8 @@
 #pragma once
 #include <alpaca/client/environment.hpp>
 #include <alpaca/client/httpClient.hpp>
+#include <alpaca/client/pooledHttpClient.hpp>
+#include <alpaca/models/trading/orderTemplate.hpp>
 #include <alpaca/models/trading/serialize.hpp>
 #include <alpaca/utils/utils.hpp>
 #include <expected>
@@ -37,23 +39,39 @@ public:
   TradingClientT(const Env &env, Http cli) noexcept
       : env_(env), cli_(std::move(cli)) {}
 
+  // Runs `f(*this)` on `ex` and returns a future of its result, e.g.
+  //   auto fut = cli.Async(io, [](auto &c) { return c.GetAccount(); });
+  template <class Executor, class F> auto Async(Executor &ex, F &&f) {
+    return ex.Submit(
+        [this, f = std::forward<F>(f)]() mutable { return f(*this); });
+  }
+
   std::expected<Account, APIError> GetAccount() noexcept {
     const auto &query = ACCOUNT_ENDPOINT;
     return cli_.template Request<Account>(Req::GET, query);
   }
 
-  std::expected<OrderResponse, APIError>
+  template <class Time = std::string>
+  std::expected<OrderResponseT<Time>, APIError>
   SubmitOrder(const OrderRequestParam &request) noexcept {
-    std::expected<std::string, glz::error_ctx> order_request;
-    order_request = glz::write_json(request);
-    if (!order_request) {
-      return std::unexpected(APIError{
-          ErrorCode::JSONParsing, glz::format_error(order_request.error())});
+    auto &body = BodyBuffer();
+    if (auto ec = glz::write_json(request, body)) {
+      return std::unexpected(
+          APIError{ErrorCode::JSONParsing, glz::format_error(ec)});
     }
 
     const auto &query = ORDERS_ENDPOINT;
-    return cli_.template Request<OrderResponse>(
-        Req::POST, query, order_request.value(), "application/json");
+    return cli_.template Request<OrderResponseT<Time>>(Req::POST, query, body,
+                                                       "application/json");
+  }
+
+  // Sends `tmpl` rendered with `patch`; see OrderTemplate.
+  template <class Time = std::string>
+  std::expected<OrderResponseT<Time>, APIError>
+  SubmitOrder(OrderTemplate &tmpl, const OrderPatch &patch) noexcept {
+    const auto &query = ORDERS_ENDPOINT;
+    return cli_.template Request<OrderResponseT<Time>>(
+        Req::POST, query, tmpl.Render(patch), "application/json");
   }
 
   std::expected<Positions, APIError> GetAllOpenPositions() noexcept {
@@ -61,13 +79,22 @@ public:
     return cli_.template Request<Positions>(Req::GET, query);
   }
 
+  // Decodes into `out`, reusing its storage across polls. Requires
+  // Http::RequestInto.
+  std::expected<std::monostate, APIError>
+  GetAllOpenPositions(Positions &out) noexcept {
+    const auto &query = POSITIONS_ENDPOINT;
+    return cli_.RequestInto(out, Req::GET, query);
+  }
+
   std::expected<Position, APIError>
   GetOpenPosition(const std::string &symbol) noexcept {
     const auto query = std::format("{}/{}", POSITIONS_ENDPOINT, symbol);
     return cli_.template Request<Position>(Req::GET, query);
   }
 
-  std::expected<OrderResponse, APIError>
+  template <class Time = std::string>
+  std::expected<OrderResponseT<Time>, APIError>
   ClosePosition(const ClosePositionParams &cpp) noexcept {
     const auto qtyQuery = BuildClosePositionQuery(cpp.amt);
     if (!qtyQuery) {
@@ -77,7 +104,7 @@ public:
 
     const auto query = std::format("{}/{}?{}", POSITIONS_ENDPOINT,
                                    cpp.symbol_or_asset_id, qtyQuery.value());
-    return cli_.template Request<OrderResponse>(Req::DELETE, query);
+    return cli_.template Request<OrderResponseT<Time>>(Req::DELETE, query);
   }
 
   std::expected<Clock, APIError> GetMarketClockInfo() noexcept {
@@ -95,35 +122,20 @@ public:
     return cli_.template Request<CalendarResponse>(Req::GET, query);
   }
 
-  std::expected<std::vector<OrderResponse>, APIError>
+  template <class Time = std::string>
+  std::expected<std::vector<OrderResponseT<Time>>, APIError>
   GetAllOrders(const OrderListParam &o = {}) noexcept {
-    auto limit =
-        o.limit ? std::make_optional(std::to_string(*o.limit)) : std::nullopt;
-    auto nested = o.nested ? std::make_optional(*o.nested ? "true" : "false")
-                           : std::nullopt;
-    auto symbols = o.symbols
-                       ? std::make_optional(utils::SymbolsEncode(*o.symbols))
-                       : std::nullopt;
-
-    utils::QueryBuilder qb;
-    qb.add("status", ToString(o.status));
-    qb.add("limit", limit);
-    qb.add("after", o.after);
-    qb.add("until", o.until);
-    qb.add("direction", ToString(o.direction));
-    qb.add("nested", nested);
-    qb.add("symbols", symbols);
-    qb.add("side", ToString(o.side));
-    if (o.assetClass) {
-      for (const auto &a : *o.assetClass) {
-        qb.add("asset_class", ToString(a));
-      }
-    }
-    qb.add("before_order_id", o.beforeOrderID);
-    qb.add("after_order_id", o.afterOrderID);
-    const std::string query = std::format("{}?{}", ORDERS_ENDPOINT, qb.q);
+    return cli_.template Request<std::vector<OrderResponseT<Time>>>(
+        Req::GET, OrdersQuery(o));
+  }
 
-    return cli_.template Request<std::vector<OrderResponse>>(Req::GET, query);
+  // Decodes into `out`, reusing its storage across polls. Requires
+  // Http::RequestInto.
+  template <class Time>
+  std::expected<std::monostate, APIError>
+  GetAllOrders(std::vector<OrderResponseT<Time>> &out,
+               const OrderListParam &o = {}) noexcept {
+    return cli_.RequestInto(out, Req::GET, OrdersQuery(o));
   }
 
   std::expected<OrderID, APIError> DeleteAllOrders() noexcept {
@@ -131,16 +143,18 @@ public:
     return cli_.template Request<OrderID>(Req::DELETE, query);
   }
 
-  std::expected<OrderResponse, APIError>
+  template <class Time = std::string>
+  std::expected<OrderResponseT<Time>, APIError>
   GetOrderByClientID(std::string_view id) {
     utils::QueryBuilder qb;
     qb.add("client_order_id", id);
     const auto query =
         std::format("{}:by_client_order_id?{}", ORDERS_ENDPOINT, qb.q);
-    return cli_.template Request<OrderResponse>(Req::GET, query);
+    return cli_.template Request<OrderResponseT<Time>>(Req::GET, query);
   }
 
-  std::expected<OrderResponse, APIError>
+  template <class Time = std::string>
+  std::expected<OrderResponseT<Time>, APIError>
   GetOrderByID(std::string_view orderID,
                std::optional<bool> nstd = std::nullopt) noexcept {
     auto nested =
@@ -149,21 +163,21 @@ public:
     utils::QueryBuilder qb;
     qb.add("nested", nested);
     const auto query = std::format("{}/{}?{}", ORDERS_ENDPOINT, orderID, qb.q);
-    return cli_.template Request<OrderResponse>(Req::GET, query);
+    return cli_.template Request<OrderResponseT<Time>>(Req::GET, query);
   }
 
-  std::expected<OrderResponse, APIError>
+  template <class Time = std::string>
+  std::expected<OrderResponseT<Time>, APIError>
   ReplaceOrderByID(std::string_view orderID,
                    const ReplaceOrderParam &r) noexcept {
-    std::expected<std::string, glz::error_ctx> order_request;
-    order_request = glz::write_json(r);
-    if (!order_request) {
-      return std::unexpected(APIError{
-          ErrorCode::JSONParsing, glz::format_error(order_request.error())});
+    auto &body = BodyBuffer();
+    if (auto ec = glz::write_json(r, body)) {
+      return std::unexpected(
+          APIError{ErrorCode::JSONParsing, glz::format_error(ec)});
     }
     const auto query = std::format("{}/{}", ORDERS_ENDPOINT, orderID);
-    return cli_.template Request<OrderResponse>(
-        Req::PATCH, query, order_request.value(), "application/json");
+    return cli_.template Request<OrderResponseT<Time>>(Req::PATCH, query, body,
+                                                       "application/json");
   }
 
   std::expected<std::monostate, APIError>
@@ -189,6 +203,41 @@ public:
   }
 
 private:
+  // Per-thread buffer request bodies are serialized into; it keeps its
+  // capacity, so repeated orders do not allocate a fresh string each.
+  static std::string &BodyBuffer() noexcept {
+    thread_local std::string buf;
+    return buf;
+  }
+
+  static std::string OrdersQuery(const OrderListParam &o) {
+    auto limit =
+        o.limit ? std::make_optional(std::to_string(*o.limit)) : std::nullopt;
+    auto nested = o.nested ? std::make_optional(*o.nested ? "true" : "false")
+                           : std::nullopt;
+    auto symbols = o.symbols
+                       ? std::make_optional(utils::SymbolsEncode(*o.symbols))
+                       : std::nullopt;
+
+    utils::QueryBuilder qb;
+    qb.add("status", ToString(o.status));
+    qb.add("limit", limit);
+    qb.add("after", o.after);
+    qb.add("until", o.until);
+    qb.add("direction", ToString(o.direction));
+    qb.add("nested", nested);
+    qb.add("symbols", symbols);
+    qb.add("side", ToString(o.side));
+    if (o.assetClass) {
+      for (const auto &a : *o.assetClass) {
+        qb.add("asset_class", ToString(a));
+      }
+    }
+    qb.add("before_order_id", o.beforeOrderID);
+    qb.add("after_order_id", o.afterOrderID);
+    return std::format("{}?{}", ORDERS_ENDPOINT, qb.q);
+  }
+
   const Env &env_;
   Http cli_;
 
@@ -201,5 +250,6 @@ private:
 };
 
 using TradingClient = TradingClientT<Environment, HttpClient>;
+using PooledTradingClient = TradingClientT<Environment, PooledHttpClient>;
 
 }; // namespace alpaca
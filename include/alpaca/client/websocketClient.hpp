@@ -1,13 +1,22 @@
 #pragma once
+#include <alpaca/utils/latency.hpp>
+#include <chrono>
+#include <format>
 #include <functional>
 #include <ixwebsocket/IXWebSocket.h>
 #include <memory>
 #include <string>
+#include <string_view>
 
 namespace alpaca {
 
 struct WsCallbacks {
+  // Payload of a text or binary frame.
   std::function<void(const std::string &)> onMessage;
+  // The same with the time the client received it; used instead of
+  // onMessage when set.
+  std::function<void(const std::string &, const ReceiveTime &)>
+      onTimedMessage;
   std::function<void()> onOpen;
   std::function<void()> onClose;
   std::function<void(const std::string &)> onError;
@@ -28,14 +37,18 @@ public:
   WebSocketClient(const WebSocketClient &) = delete;
   WebSocketClient &operator=(const WebSocketClient &) = delete;
 
+  // Also restarts a socket that has closed. IX's own reconnection is off:
+  // streams reconnect through their Reconnector so they can re-authenticate
+  // and resubscribe.
   void Connect(const std::string &url, WsCallbacks cbs) {
+    ws_->stop();
     cbs_ = std::move(cbs);
+    ws_->disableAutomaticReconnection();
     ws_->setUrl(url);
     ws_->setOnMessageCallback([this](const ix::WebSocketMessagePtr &msg) {
       switch (msg->type) {
       case ix::WebSocketMessageType::Message:
-        if (cbs_.onMessage)
-          cbs_.onMessage(msg->str);
+        OnFrame(msg->str);
         break;
       case ix::WebSocketMessageType::Open:
         if (cbs_.onOpen)
@@ -60,13 +73,59 @@ public:
 
   void Send(const std::string &msg) { ws_->send(msg); }
 
+  void SendBinary(const std::string &msg) { ws_->sendBinary(msg); }
+
+  // Extra header for the opening handshake, e.g. the Content-Type that
+  // selects msgpack frames. Call before Connect.
+  void SetHeader(const std::string &name, const std::string &value) {
+    headers_[name] = value;
+    ws_->setExtraHeaders(headers_);
+  }
+
+  // Trusts the certificates in `path` (PEM) for wss:// instead of the system
+  // store, e.g. the self-signed one of a local test server. Call before
+  // Connect.
+  void SetCACertPath(const std::string &path) {
+    ix::SocketTLSOptions tls;
+    tls.caFile = path;
+    ws_->setTLSOptions(tls);
+  }
+
+  // Records "ws.handle <label>", the time the stream spends on each frame
+  // (decoding and callbacks), into `in`; null turns it off. Call before
+  // Connect.
+  void SetInstrumentation(Instrumentation *in, std::string_view label) {
+    handle_ = in ? &in->Histogram(std::format("ws.handle {}", label)) : nullptr;
+  }
+
   bool IsConnected() const {
     return ws_->getReadyState() == ix::ReadyState::Open;
   }
 
 private:
+  // Stamps the frame as it is handed over, before any decoding, so the
+  // stream's lag measurements start here.
+  void OnFrame(const std::string &payload) {
+    if (cbs_.onTimedMessage) {
+      const auto received = ReceiveTime::Now();
+      cbs_.onTimedMessage(payload, received);
+      if (handle_) {
+        handle_->Record(std::chrono::steady_clock::now() - received.mono);
+      }
+    } else if (cbs_.onMessage) {
+      const auto start = handle_ ? std::chrono::steady_clock::now()
+                                 : std::chrono::steady_clock::time_point{};
+      cbs_.onMessage(payload);
+      if (handle_) {
+        handle_->Record(std::chrono::steady_clock::now() - start);
+      }
+    }
+  }
+
   std::unique_ptr<ix::WebSocket> ws_;
+  ix::WebSocketHttpHeaders headers_;
   WsCallbacks cbs_;
+  HdrHistogram *handle_{nullptr};
 };
 
 } // namespace alpaca
@@ -0,0 +1,551 @@
+#pragma once
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <glaze/glaze.hpp>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+namespace alpaca {
+
+// Fixed-point decimal for prices, quantities and money: an int64 mantissa
+// and a base-10 scale, value = mantissa / 10^scale. Read straight from
+// Alpaca's string-quoted numbers and written back the same way with the
+// scale kept, so "150.00" stays "150.00". Sums, differences and products are
+// exact while they fit in 18 significant digits; past that the least
+// significant digits are rounded away (half away from zero), and values out
+// of int64 range saturate.
+class Decimal {
+private:
+  static constexpr std::uint64_t kMax =
+      std::numeric_limits<std::int64_t>::max();
+
+  static constexpr std::uint64_t Pow10(int n) noexcept {
+    std::uint64_t p = 1;
+    for (; n > 0; --n) {
+      p *= 10;
+    }
+    return p;
+  }
+
+  static constexpr std::uint64_t Abs(std::int64_t v) noexcept {
+    return v < 0 ? 0 - static_cast<std::uint64_t>(v)
+                 : static_cast<std::uint64_t>(v);
+  }
+
+  static constexpr std::int64_t Signed(std::uint64_t mag, bool neg) noexcept {
+    return neg ? -static_cast<std::int64_t>(mag)
+               : static_cast<std::int64_t>(mag);
+  }
+
+  // Rounds `mag / 10^n` half away from zero.
+  static constexpr std::uint64_t DropDigits(std::uint64_t mag, int n) noexcept {
+    if (n <= 0) {
+      return mag;
+    }
+    if (n > 19) {
+      return 0;
+    }
+    const auto p = Pow10(n);
+    const auto rem = mag % p;
+    return mag / p + (rem >= p - rem ? 1 : 0);
+  }
+
+  // Results are kept within [-kMax, kMax] so negation never overflows.
+  static constexpr bool MulOverflow(std::int64_t a, std::int64_t b,
+                                    std::int64_t &out) noexcept {
+    const auto ua = Abs(a);
+    const auto ub = Abs(b);
+    if (ua != 0 && ub > kMax / ua) {
+      return true;
+    }
+    out = Signed(ua * ub, (a < 0) != (b < 0));
+    return false;
+  }
+
+  // Full 128-bit product as {hi, lo}; portable stand-in for __int128.
+  static constexpr void MulWide(std::uint64_t a, std::uint64_t b,
+                                std::uint64_t &hi, std::uint64_t &lo) noexcept {
+    const auto aLo = a & 0xffffffffu, aHi = a >> 32;
+    const auto bLo = b & 0xffffffffu, bHi = b >> 32;
+    const auto ll = aLo * bLo;
+    const auto lh = aLo * bHi;
+    const auto hl = aHi * bLo;
+    const auto mid = (ll >> 32) + (lh & 0xffffffffu) + (hl & 0xffffffffu);
+    lo = (mid << 32) | (ll & 0xffffffffu);
+    hi = aHi * bHi + (lh >> 32) + (hl >> 32) + (mid >> 32);
+  }
+
+  // Divides {hi, lo} by 10 in place and returns the remainder.
+  static constexpr unsigned DivWide10(std::uint64_t &hi,
+                                      std::uint64_t &lo) noexcept {
+    std::uint64_t rem = 0;
+    std::uint64_t limbs[4] = {hi >> 32, hi & 0xffffffffu, lo >> 32,
+                              lo & 0xffffffffu};
+    for (auto &l : limbs) {
+      const auto cur = (rem << 32) | l;
+      l = cur / 10;
+      rem = cur % 10;
+    }
+    hi = (limbs[0] << 32) | limbs[1];
+    lo = (limbs[2] << 32) | limbs[3];
+    return static_cast<unsigned>(rem);
+  }
+
+  static constexpr bool AddOverflow(std::int64_t a, std::int64_t b,
+                                    std::int64_t &out) noexcept {
+    const auto max = static_cast<std::int64_t>(kMax);
+    if ((b > 0 && a > max - b) || (b < 0 && a < -max - b)) {
+      return true;
+    }
+    out = a + b;
+    return false;
+  }
+
+  constexpr Decimal(std::int64_t mantissa, int scale, int) noexcept
+      : mantissa_(mantissa), scale_(static_cast<std::int8_t>(scale)) {}
+
+  static constexpr Decimal Saturated(bool neg) noexcept {
+    return Decimal{Signed(kMax, neg), 0, 0};
+  }
+
+  constexpr void DropOne() noexcept {
+    mantissa_ = Signed(DropDigits(Abs(mantissa_), 1), mantissa_ < 0);
+    --scale_;
+  }
+
+  // Brings `a` and `b` to one scale: the larger of the two when the other
+  // mantissa can take it, otherwise fewer digits of the more precise one.
+  static constexpr void Align(Decimal &a, Decimal &b) noexcept {
+    if (a.scale_ < b.scale_) {
+      Align(b, a);
+      return;
+    }
+    while (a.scale_ > b.scale_) {
+      std::int64_t up{};
+      const auto p = static_cast<std::int64_t>(Pow10(a.scale_ - b.scale_));
+      if (!MulOverflow(b.mantissa_, p, up)) {
+        b = Decimal{up, a.scale_, 0};
+        return;
+      }
+      a.DropOne();
+    }
+  }
+
+public:
+  static constexpr int kMaxScale = 18;
+  // Fractional digits produced by operator/.
+  static constexpr int kDivScale = 9;
+  // Buffer size ToChars needs: sign, 19 digits and the decimal point.
+  static constexpr std::size_t kMaxChars = 24;
+
+  constexpr Decimal() noexcept = default;
+
+  // Values beyond +-INT64_MAX saturate, as arithmetic results do.
+  template <std::integral I>
+    requires(!std::same_as<I, bool>)
+  constexpr Decimal(I v) noexcept {
+    if (std::cmp_greater(v, kMax)) {
+      mantissa_ = Signed(kMax, false);
+    } else if (std::cmp_less(v, -Signed(kMax, false))) {
+      mantissa_ = Signed(kMax, true);
+    } else {
+      mantissa_ = static_cast<std::int64_t>(v);
+    }
+  }
+
+  // Explicit because NaN, infinities and out of range values have no
+  // Decimal and silently become 0; FromFloat reports them instead.
+  template <std::floating_point F> explicit Decimal(F v) noexcept {
+    if (const auto d = FromFloat(v)) {
+      *this = *d;
+    }
+  }
+
+  // Goes through the shortest round-trip representation of `v`, so 0.1
+  // becomes exactly 0.1. Empty for NaN, infinities and out of range values.
+  template <std::floating_point F>
+  static std::optional<Decimal> FromFloat(F v) noexcept {
+    if (!std::isfinite(v)) {
+      return std::nullopt;
+    }
+    char buf[64];
+    const auto [end, ec] = std::to_chars(buf, buf + sizeof buf, v);
+    if (ec != std::errc{}) {
+      return std::nullopt;
+    }
+    return Parse(std::string_view(buf, end));
+  }
+
+  // mantissa / 10^scale. The mantissa saturates at +-INT64_MAX; a scale
+  // past kMaxScale rounds digits away and a negative one multiplies them in.
+  static constexpr Decimal FromRaw(std::int64_t mantissa, int scale) noexcept {
+    const bool neg = mantissa < 0;
+    auto mag = std::min(Abs(mantissa), kMax);
+    for (; scale < 0; ++scale) {
+      if (mag > kMax / 10) {
+        return Saturated(neg);
+      }
+      mag *= 10;
+    }
+    if (scale > kMaxScale) {
+      mag = DropDigits(mag, scale - kMaxScale);
+      scale = kMaxScale;
+    }
+    return Decimal{Signed(mag, neg), scale, 0};
+  }
+
+  // Accepts JSON number syntax, e.g. "10", "-0.0333", "1.5e-05". Digits past
+  // kMaxScale or past int64 precision are rounded away.
+  static constexpr std::optional<Decimal> Parse(std::string_view s) noexcept {
+    auto digit = [&](std::size_t i) {
+      return i < s.size() && s[i] >= '0' && s[i] <= '9';
+    };
+
+    std::size_t i = 0;
+    const bool neg = i < s.size() && s[i] == '-';
+    if (i < s.size() && (s[i] == '-' || s[i] == '+')) {
+      ++i;
+    }
+
+    std::uint64_t mag = 0;
+    bool any = false;
+    for (; digit(i); ++i) {
+      const auto d = static_cast<std::uint64_t>(s[i] - '0');
+      if (mag > (kMax - d) / 10) {
+        return std::nullopt;
+      }
+      mag = mag * 10 + d;
+      any = true;
+    }
+
+    int frac = 0;
+    int roundDigit = -1;
+    if (i < s.size() && s[i] == '.') {
+      for (++i; digit(i); ++i) {
+        const auto d = static_cast<std::uint64_t>(s[i] - '0');
+        any = true;
+        if (roundDigit >= 0) {
+          continue;
+        }
+        if (frac < kMaxScale && mag <= (kMax - d) / 10) {
+          mag = mag * 10 + d;
+          ++frac;
+        } else {
+          roundDigit = static_cast<int>(d);
+        }
+      }
+    }
+    if (!any) {
+      return std::nullopt;
+    }
+
+    int exp = 0;
+    if (i < s.size() && (s[i] == 'e' || s[i] == 'E')) {
+      ++i;
+      const bool expNeg = i < s.size() && s[i] == '-';
+      if (i < s.size() && (s[i] == '-' || s[i] == '+')) {
+        ++i;
+      }
+      if (!digit(i)) {
+        return std::nullopt;
+      }
+      for (; digit(i); ++i) {
+        exp = std::min(exp * 10 + (s[i] - '0'), 1000);
+      }
+      exp = expNeg ? -exp : exp;
+    }
+    if (i != s.size()) {
+      return std::nullopt;
+    }
+
+    if (roundDigit >= 5 && mag < kMax) {
+      ++mag;
+    }
+    int scale = frac - exp;
+    for (; scale < 0; ++scale) {
+      if (mag > kMax / 10) {
+        return std::nullopt;
+      }
+      mag *= 10;
+    }
+    if (scale > kMaxScale) {
+      mag = DropDigits(mag, scale - kMaxScale);
+      scale = kMaxScale;
+    }
+    return Decimal{Signed(mag, neg), scale, 0};
+  }
+
+  constexpr std::int64_t Mantissa() const noexcept { return mantissa_; }
+  constexpr int Scale() const noexcept { return scale_; }
+
+  // Rounds half away from zero to at most `scale` fractional digits.
+  constexpr Decimal Round(int scale) const noexcept {
+    if (scale < 0) {
+      scale = 0;
+    }
+    if (scale >= scale_) {
+      return *this;
+    }
+    return Decimal{Signed(DropDigits(Abs(mantissa_), scale_ - scale),
+                          mantissa_ < 0),
+                   scale, 0};
+  }
+
+  // Writes exactly Scale() fractional digits into `out`, which must hold
+  // kMaxChars bytes. Returns one past the last byte written.
+  constexpr char *ToChars(char *out) const noexcept {
+    char tmp[kMaxChars]{};
+    int n = 0;
+    auto mag = Abs(mantissa_);
+    do {
+      tmp[n++] = static_cast<char>('0' + mag % 10);
+      mag /= 10;
+    } while (mag != 0);
+    while (n <= scale_) {
+      tmp[n++] = '0';
+    }
+
+    if (mantissa_ < 0) {
+      *out++ = '-';
+    }
+    for (int k = n; k-- > 0;) {
+      *out++ = tmp[k];
+      if (k == scale_ && scale_ > 0) {
+        *out++ = '.';
+      }
+    }
+    return out;
+  }
+
+  std::string ToString() const {
+    char buf[kMaxChars];
+    return std::string(buf, ToChars(buf));
+  }
+
+  explicit operator double() const noexcept {
+    return static_cast<double>(mantissa_) /
+           static_cast<double>(Pow10(scale_));
+  }
+
+  explicit operator long double() const noexcept {
+    return static_cast<long double>(mantissa_) /
+           static_cast<long double>(Pow10(scale_));
+  }
+
+  constexpr Decimal operator-() const noexcept {
+    return Decimal{-mantissa_, scale_, 0};
+  }
+
+  friend constexpr Decimal operator+(Decimal a, Decimal b) noexcept {
+    Align(a, b);
+    std::int64_t sum{};
+    while (AddOverflow(a.mantissa_, b.mantissa_, sum)) {
+      if (a.scale_ == 0) {
+        return Saturated(a.mantissa_ < 0);
+      }
+      a.DropOne();
+      b.DropOne();
+    }
+    return Decimal{sum, a.scale_, 0};
+  }
+
+  friend constexpr Decimal operator-(Decimal a, Decimal b) noexcept {
+    return a + -b;
+  }
+
+  friend constexpr Decimal operator*(Decimal a, Decimal b) noexcept {
+    const bool neg = (a.mantissa_ < 0) != (b.mantissa_ < 0);
+    std::int64_t product{};
+    if (a.scale_ + b.scale_ <= kMaxScale &&
+        !MulOverflow(a.mantissa_, b.mantissa_, product)) {
+      return Decimal{product, a.scale_ + b.scale_, 0};
+    }
+
+    // Round the exact 128-bit product, not the operands.
+    std::uint64_t hi{}, lo{};
+    MulWide(Abs(a.mantissa_), Abs(b.mantissa_), hi, lo);
+    int scale = a.scale_ + b.scale_;
+    unsigned last = 0;
+    while (hi != 0 || lo > kMax || scale > kMaxScale) {
+      if (scale == 0) {
+        return Saturated(neg);
+      }
+      last = DivWide10(hi, lo);
+      --scale;
+    }
+    if (last >= 5 && ++lo > kMax) {
+      if (scale == 0) {
+        return Saturated(neg);
+      }
+      lo = DropDigits(lo, 1);
+      --scale;
+    }
+    return Decimal{Signed(lo, neg), scale, 0};
+  }
+
+  // Rounded half away from zero to kDivScale fractional digits, or fewer
+  // when the integer part leaves no room. Division by zero yields zero.
+  friend constexpr Decimal operator/(Decimal a, Decimal b) noexcept {
+    if (b.mantissa_ == 0) {
+      return {};
+    }
+    const bool neg = (a.mantissa_ < 0) != (b.mantissa_ < 0);
+    auto num = Abs(a.mantissa_);
+    auto den = Abs(b.mantissa_);
+
+    // quotient mantissa = num * 10^shift / den at scale kDivScale
+    int shift = kDivScale + b.scale_ - a.scale_;
+    // Keep den * 10 within uint64 for the long division below.
+    constexpr auto kDenMax = std::numeric_limits<std::uint64_t>::max() / 10;
+    while (den > kDenMax) {
+      den = DropDigits(den, 1);
+      --shift;
+    }
+    for (; shift < 0 && den <= kDenMax / 10; ++shift) {
+      den *= 10;
+    }
+    if (shift < 0) {
+      num = DropDigits(num, -shift);
+      shift = 0;
+    }
+
+    auto q = num / den;
+    auto r = num % den;
+    int scale = kDivScale;
+    for (; shift > 0; --shift) {
+      if (q > (kMax - 9) / 10) {
+        scale -= shift;
+        break;
+      }
+      r *= 10;
+      q = q * 10 + r / den;
+      r %= den;
+    }
+    if (scale < 0 || q > kMax) {
+      return Saturated(neg);
+    }
+    if (r >= den - r && q < kMax) {
+      ++q;
+    }
+    return Decimal{Signed(q, neg), scale, 0};
+  }
+
+  constexpr Decimal &operator+=(Decimal o) noexcept {
+    return *this = *this + o;
+  }
+  constexpr Decimal &operator-=(Decimal o) noexcept {
+    return *this = *this - o;
+  }
+  constexpr Decimal &operator*=(Decimal o) noexcept {
+    return *this = *this * o;
+  }
+  constexpr Decimal &operator/=(Decimal o) noexcept {
+    return *this = *this / o;
+  }
+
+  // Compares values, not representations: 1.50 == 1.5.
+  friend constexpr std::strong_ordering operator<=>(const Decimal &a,
+                                                    const Decimal &b) noexcept {
+    if (a.scale_ == b.scale_) {
+      return a.mantissa_ <=> b.mantissa_;
+    }
+    const auto pa = static_cast<std::int64_t>(Pow10(a.scale_));
+    const auto pb = static_cast<std::int64_t>(Pow10(b.scale_));
+    if (const auto c = a.mantissa_ / pa <=> b.mantissa_ / pb; c != 0) {
+      return c;
+    }
+    // Fractional parts widened to kMaxScale digits, which always fits.
+    return (a.mantissa_ % pa) *
+               static_cast<std::int64_t>(Pow10(kMaxScale - a.scale_)) <=>
+           (b.mantissa_ % pb) *
+               static_cast<std::int64_t>(Pow10(kMaxScale - b.scale_));
+  }
+
+  friend constexpr bool operator==(const Decimal &a,
+                                   const Decimal &b) noexcept {
+    return (a <=> b) == 0;
+  }
+
+private:
+  std::int64_t mantissa_{0};
+  std::int8_t scale_{0};
+};
+
+}; // namespace alpaca
+
+template <>
+struct std::formatter<alpaca::Decimal> : std::formatter<std::string_view> {
+  auto format(const alpaca::Decimal &d, std::format_context &ctx) const {
+    char buf[alpaca::Decimal::kMaxChars];
+    return std::formatter<std::string_view>::format(
+        std::string_view(buf, d.ToChars(buf)), ctx);
+  }
+};
+
+namespace glz {
+
+// Reads both the quoted form Alpaca uses ("10.5") and bare JSON numbers. An
+// empty string, which Alpaca sends for some unset account amounts, is zero.
+template <> struct from<JSON, alpaca::Decimal> {
+  template <auto Opts>
+  static void op(alpaca::Decimal &value, is_context auto &&ctx, auto &&it,
+                 auto &&end) {
+    while (it != end &&
+           (*it == ' ' || *it == '\t' || *it == '\n' || *it == '\r')) {
+      ++it;
+    }
+    if (it == end) {
+      ctx.error = error_code::unexpected_end;
+      return;
+    }
+
+    std::string_view raw;
+    if (*it == '"') {
+      parse<JSON>::op<Opts>(raw, ctx, it, end);
+      if (bool(ctx.error)) {
+        return;
+      }
+      if (raw.empty()) {
+        value = {};
+        return;
+      }
+    } else {
+      const auto start = it;
+      while (it != end && ((*it >= '0' && *it <= '9') || *it == '-' ||
+                           *it == '+' || *it == '.' || *it == 'e' ||
+                           *it == 'E')) {
+        ++it;
+      }
+      raw = std::string_view(start, static_cast<std::size_t>(it - start));
+    }
+
+    const auto d = alpaca::Decimal::Parse(raw);
+    if (!d) {
+      ctx.error = error_code::syntax_error;
+      return;
+    }
+    value = *d;
+  }
+};
+
+template <> struct to<JSON, alpaca::Decimal> {
+  template <auto Opts>
+  static void op(const alpaca::Decimal &value, is_context auto &&ctx,
+                 auto &&b, auto &&ix) noexcept {
+    char buf[alpaca::Decimal::kMaxChars];
+    const std::string_view str(buf, value.ToChars(buf));
+    serialize<JSON>::op<Opts>(str, ctx, b, ix);
+  }
+};
+
+}; // namespace glz
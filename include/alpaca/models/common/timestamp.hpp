@@ -0,0 +1,74 @@
+#pragma once
+#include <alpaca/utils/utils.hpp>
+#include <chrono>
+#include <compare>
+#include <cstdint>
+#include <format>
+#include <glaze/glaze.hpp>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace alpaca {
+
+// Opt-in replacement for string timestamps in models. Decoded straight from
+// the RFC 3339 wire string into a nanosecond time point, so reading it costs
+// no allocation and consumers never reparse.
+struct Timestamp {
+  std::chrono::sys_time<std::chrono::nanoseconds> time{};
+
+  static std::optional<Timestamp> Parse(std::string_view s) noexcept {
+    const auto ns = utils::ParseRfc3339Nanos(s);
+    if (!ns) {
+      return std::nullopt;
+    }
+    return Timestamp{std::chrono::sys_time<std::chrono::nanoseconds>{
+        std::chrono::nanoseconds{*ns}}};
+  }
+
+  std::int64_t EpochNanos() const noexcept {
+    return time.time_since_epoch().count();
+  }
+
+  std::string ToString() const { return std::format("{:%FT%T}Z", time); }
+
+  auto operator<=>(const Timestamp &) const = default;
+};
+
+}; // namespace alpaca
+
+namespace glz {
+
+template <> struct from<JSON, alpaca::Timestamp> {
+  template <auto Opts>
+  static void op(alpaca::Timestamp &value, is_context auto &&ctx, auto &&it,
+                 auto &&end) {
+    std::string_view raw;
+    parse<JSON>::op<Opts>(raw, ctx, it, end);
+    if (bool(ctx.error)) {
+      return;
+    }
+    const auto ts = alpaca::Timestamp::Parse(raw);
+    if (!ts) {
+      ctx.error = error_code::syntax_error;
+      return;
+    }
+    value = *ts;
+  }
+};
+
+template <> struct to<JSON, alpaca::Timestamp> {
+  template <auto Opts>
+  static void op(const alpaca::Timestamp &value, is_context auto &&ctx,
+                 auto &&b, auto &&ix) noexcept {
+    // Same text as ToString(), formatted on the stack so writing does not
+    // allocate; nanosecond precision needs 30 characters.
+    char buf[32];
+    const auto res =
+        std::format_to_n(buf, sizeof(buf), "{:%FT%T}Z", value.time);
+    const std::string_view str(buf, res.out);
+    serialize<JSON>::op<Opts>(str, ctx, b, ix);
+  }
+};
+
+}; // namespace glz
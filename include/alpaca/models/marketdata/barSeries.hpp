@@ -0,0 +1,84 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace alpaca {
+
+// Columnar (structure-of-arrays) bar history for one symbol. Row i of every
+// column describes the same bar; timestamps are nanoseconds since the Unix
+// epoch. Decoded straight from the wire without a per-bar string.
+struct BarSeries {
+  std::vector<std::int64_t> timestamp{};
+  std::vector<double> open{};
+  std::vector<double> high{};
+  std::vector<double> low{};
+  std::vector<double> close{};
+  std::vector<double> vwap{};
+  std::vector<std::int64_t> volume{};
+  std::vector<std::int64_t> numTrades{};
+
+  std::size_t size() const noexcept { return timestamp.size(); }
+  bool empty() const noexcept { return timestamp.empty(); }
+
+  void reserve(std::size_t n) {
+    timestamp.reserve(n);
+    open.reserve(n);
+    high.reserve(n);
+    low.reserve(n);
+    close.reserve(n);
+    vwap.reserve(n);
+    volume.reserve(n);
+    numTrades.reserve(n);
+  }
+
+  void clear() noexcept {
+    timestamp.clear();
+    open.clear();
+    high.clear();
+    low.clear();
+    close.clear();
+    vwap.clear();
+    volume.clear();
+    numTrades.clear();
+  }
+
+  void append(const BarSeries &o) {
+    auto cat = [](auto &dst, const auto &src) {
+      dst.insert(dst.end(), src.begin(), src.end());
+    };
+    cat(timestamp, o.timestamp);
+    cat(open, o.open);
+    cat(high, o.high);
+    cat(low, o.low);
+    cat(close, o.close);
+    cat(vwap, o.vwap);
+    cat(volume, o.volume);
+    cat(numTrades, o.numTrades);
+  }
+
+  // Takes over `o`'s columns when this series is empty. Otherwise the
+  // values are copied; they are trivially copyable, so a move gains
+  // nothing there.
+  void append(BarSeries &&o) {
+    if (empty()) {
+      *this = std::move(o);
+      return;
+    }
+    append(static_cast<const BarSeries &>(o));
+  }
+};
+
+using BarSeriesMap = std::map<std::string, BarSeries>;
+
+// One page of /v2/stocks/bars decoded into columns.
+struct BarSeriesPage {
+  BarSeriesMap bars{};
+  std::optional<std::string> next_page_token = std::nullopt;
+};
+
+}; // namespace alpaca
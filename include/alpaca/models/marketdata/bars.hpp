@@ -23,20 +23,25 @@ enum class BarSort {
   Desc,
 };
 
-struct Bar {
+// `Time` is std::string by default; alpaca::Timestamp decodes the RFC 3339
+// string into a nanosecond time point without allocating.
+template <class Time = std::string> struct BarT {
   double close{}, high{}, low{};
   long long number_of_trades{};
   double open{};
-  std::string timestamp{};
+  Time timestamp{};
   long long volume{};
   double volume_weigted_price{};
 };
 
-struct Bars {
-  std::map<std::string, std::vector<Bar>> bars{};
+template <class Time = std::string> struct BarsT {
+  std::map<std::string, std::vector<BarT<Time>>> bars{};
   std::optional<std::string> next_page_token = std::nullopt;
 };
 
+using Bar = BarT<>;
+using Bars = BarsT<>;
+
 struct BarParams {
   std::vector<std::string> symbols{};
   std::string timeframe{"1D"};
@@ -51,15 +56,28 @@ struct BarParams {
   std::optional<BarSort> sort = std::nullopt;
 };
 
+// Controls MarketDataClientT::GetBarsSharded. Shards are the cross product of
+// symbol chunks and time slices; each shard paginates independently.
+struct BarShardOptions {
+  // Symbols per shard; 0 keeps every symbol in a single chunk.
+  std::size_t symbolsPerShard{50};
+  // Number of equal slices the [start, end] range is cut into.
+  std::size_t timeSlices{1};
+  // Shards fetched concurrently.
+  std::size_t maxParallel{4};
+};
+
 struct LatestBarParam {
   std::vector<std::string> symbols{};
   std::optional<BarFeed> feed = std::nullopt;
 };
 
-struct LatestBars {
-  std::map<std::string, Bar> bars{};
+template <class Time = std::string> struct LatestBarsT {
+  std::map<std::string, BarT<Time>> bars{};
 };
 
+using LatestBars = LatestBarsT<>;
+
 constexpr std::optional<std::string_view>
 ToString(std::optional<BarFeed> f) noexcept {
   if (!f) {
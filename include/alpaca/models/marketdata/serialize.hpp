@@ -1,6 +1,24 @@
 #pragma once
+#include <alpaca/models/common/timestamp.hpp>
+#include <alpaca/models/marketdata/barSeries.hpp>
 #include <alpaca/models/marketdata/bars.hpp>
+#include <cstdint>
 #include <glaze/glaze.hpp>
+#include <vector>
+
+namespace alpaca {
+
+// Wire-only row used to decode bars straight into BarSeries columns.
+struct BarRowWire {
+  double c{}, h{}, l{};
+  std::int64_t n{};
+  double o{};
+  Timestamp t{};
+  std::int64_t v{};
+  double vw{};
+};
+
+}; // namespace alpaca
 
 namespace glz {
 
@@ -20,22 +38,63 @@ template <> struct meta<alpaca::BarSort> {
   static constexpr auto value = glz::enumerate(Asc, Desc);
 };
 
-template <> struct meta<alpaca::Bar> {
-  using T = alpaca::Bar;
+template <class Time> struct meta<alpaca::BarT<Time>> {
+  using T = alpaca::BarT<Time>;
   static constexpr auto value =
       object("c", &T::close, "h", &T::high, "l", &T::low, "n",
              &T::number_of_trades, "o", &T::open, "t", &T::timestamp, "v",
              &T::volume, "vw", &T::volume_weigted_price);
 };
 
-template <> struct meta<alpaca::Bars> {
-  using T = alpaca::Bars;
+template <class Time> struct meta<alpaca::BarsT<Time>> {
+  using T = alpaca::BarsT<Time>;
+  static constexpr auto value =
+      object("bars", &T::bars, "next_page_token", &T::next_page_token);
+};
+
+template <> struct meta<alpaca::BarRowWire> {
+  using T = alpaca::BarRowWire;
+  static constexpr auto value =
+      object("c", &T::c, "h", &T::h, "l", &T::l, "n", &T::n, "o", &T::o, "t",
+             &T::t, "v", &T::v, "vw", &T::vw);
+};
+
+template <> struct from<JSON, alpaca::BarSeries> {
+  template <auto Opts>
+  static void op(alpaca::BarSeries &value, is_context auto &&ctx, auto &&it,
+                 auto &&end) {
+    // Rows land in a per-thread scratch buffer whose capacity survives across
+    // pages, then get transposed into the columns.
+    thread_local std::vector<alpaca::BarRowWire> rows;
+    rows.clear();
+    parse<JSON>::op<Opts>(rows, ctx, it, end);
+    if (bool(ctx.error)) {
+      return;
+    }
+
+    value.clear();
+    value.reserve(rows.size());
+    for (const auto &r : rows) {
+      value.timestamp.push_back(r.t.EpochNanos());
+      value.open.push_back(r.o);
+      value.high.push_back(r.h);
+      value.low.push_back(r.l);
+      value.close.push_back(r.c);
+      value.vwap.push_back(r.vw);
+      value.volume.push_back(r.v);
+      value.numTrades.push_back(r.n);
+    }
+  }
+};
+
+template <> struct meta<alpaca::BarSeriesPage> {
+  using T = alpaca::BarSeriesPage;
   static constexpr auto value =
       object("bars", &T::bars, "next_page_token", &T::next_page_token);
 };
 
-template <> struct meta<alpaca::LatestBars> {
-  using T = alpaca::LatestBars;
+template <class Time> struct meta<alpaca::LatestBarsT<Time>> {
+  using T = alpaca::LatestBarsT<Time>;
   static constexpr auto value = object("bars", &T::bars);
 };
 
@@ -0,0 +1,638 @@
+#pragma once
+#include <alpaca/models/common/timestamp.hpp>
+#include <alpaca/models/streaming/marketdata.hpp>
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace alpaca {
+
+// One value of a market-data message as it appears in the frame. Strings are
+// the raw contents between the quotes, escapes included; the decoder swaps
+// any view field that had one for a decoded copy before delivery. Numbers
+// keep their text and are converted on access, so fields nobody reads cost
+// nothing. Arrays and objects carry their full raw text.
+//
+// Binary (msgpack) frames produce Int, Float and Time values already
+// decoded; their strings, arrays and maps are raw bytes like above.
+struct WireValue {
+  enum class Kind { String, Number, Literal, Array, Object, Int, Float, Time };
+
+  Kind kind{Kind::Literal};
+  std::string_view text;
+  int64_t i{};
+  double f{};
+  Timestamp time{};
+
+  std::optional<double> AsDouble() const noexcept {
+    if (kind == Kind::Float) {
+      return f;
+    }
+    if (kind == Kind::Int) {
+      return static_cast<double>(i);
+    }
+    double out{};
+    if (kind != Kind::Number ||
+        std::from_chars(text.data(), text.data() + text.size(), out).ec !=
+            std::errc{}) {
+      return std::nullopt;
+    }
+    return out;
+  }
+
+  std::optional<int64_t> AsInt() const noexcept {
+    if (kind == Kind::Int) {
+      return i;
+    }
+    if (kind == Kind::Float) {
+      const auto n = static_cast<int64_t>(f);
+      if (static_cast<double>(n) != f) {
+        return std::nullopt;
+      }
+      return n;
+    }
+    int64_t out{};
+    if (kind != Kind::Number ||
+        std::from_chars(text.data(), text.data() + text.size(), out).ec !=
+            std::errc{}) {
+      return std::nullopt;
+    }
+    return out;
+  }
+
+  std::optional<std::string_view> AsString() const noexcept {
+    if (kind != Kind::String) {
+      return std::nullopt;
+    }
+    return text;
+  }
+};
+
+namespace detail {
+
+inline void AppendUtf8(std::string &out, uint32_t cp) {
+  if (cp < 0x80) {
+    out += static_cast<char>(cp);
+  } else if (cp < 0x800) {
+    out += static_cast<char>(0xC0 | (cp >> 6));
+    out += static_cast<char>(0x80 | (cp & 0x3F));
+  } else if (cp < 0x10000) {
+    out += static_cast<char>(0xE0 | (cp >> 12));
+    out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (cp & 0x3F));
+  } else {
+    out += static_cast<char>(0xF0 | (cp >> 18));
+    out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+    out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (cp & 0x3F));
+  }
+}
+
+inline bool ReadHex4(std::string_view s, std::size_t at, uint32_t &cp) {
+  if (at + 4 > s.size()) {
+    return false;
+  }
+  const char *first = s.data() + at;
+  return std::from_chars(first, first + 4, cp, 16).ptr == first + 4;
+}
+
+// Decodes the JSON escapes in `raw`, the text between the quotes, into
+// `out`. Fails on a malformed escape.
+inline bool UnescapeJson(std::string_view raw, std::string &out) {
+  out.clear();
+  out.reserve(raw.size());
+  for (std::size_t i = 0; i < raw.size(); ++i) {
+    if (raw[i] != '\\') {
+      out += raw[i];
+      continue;
+    }
+    if (++i == raw.size()) {
+      return false;
+    }
+    switch (raw[i]) {
+    case '"':
+    case '\\':
+    case '/':
+      out += raw[i];
+      break;
+    case 'b':
+      out += '\b';
+      break;
+    case 'f':
+      out += '\f';
+      break;
+    case 'n':
+      out += '\n';
+      break;
+    case 'r':
+      out += '\r';
+      break;
+    case 't':
+      out += '\t';
+      break;
+    case 'u': {
+      uint32_t cp{};
+      if (!ReadHex4(raw, i + 1, cp)) {
+        return false;
+      }
+      i += 4;
+      if (cp >= 0xD800 && cp < 0xDC00) {
+        // High surrogate; the low half must follow as another \u escape.
+        uint32_t low{};
+        if (i + 2 >= raw.size() || raw[i + 1] != '\\' || raw[i + 2] != 'u' ||
+            !ReadHex4(raw, i + 3, low) || low < 0xDC00 || low >= 0xE000) {
+          return false;
+        }
+        i += 6;
+        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+      } else if (cp >= 0xDC00 && cp < 0xE000) {
+        return false;
+      }
+      AppendUtf8(out, cp);
+      break;
+    }
+    default:
+      return false;
+    }
+  }
+  return true;
+}
+
+template <class T>
+bool AssignNumber(T &dst, const WireValue &v) noexcept {
+  if constexpr (std::is_floating_point_v<T>) {
+    const auto n = v.AsDouble();
+    if (n) {
+      dst = *n;
+    }
+    return n.has_value();
+  } else {
+    const auto n = v.AsInt();
+    if (n) {
+      dst = static_cast<T>(*n);
+    }
+    return n.has_value();
+  }
+}
+
+inline bool AssignString(std::string_view &dst, const WireValue &v) noexcept {
+  const auto s = v.AsString();
+  if (s) {
+    dst = *s;
+  }
+  return s.has_value();
+}
+
+// Binary frames carry no timestamp text; `raw` is left empty for them.
+inline bool AssignTime(std::string_view &raw, Timestamp &time,
+                       const WireValue &v) noexcept {
+  if (v.kind == WireValue::Kind::Time) {
+    time = v.time;
+    return true;
+  }
+  const auto s = v.AsString();
+  if (!s) {
+    return false;
+  }
+  const auto ts = Timestamp::Parse(*s);
+  if (!ts) {
+    return false;
+  }
+  raw = *s;
+  time = *ts;
+  return true;
+}
+
+inline bool AssignArray(std::string_view &dst, const WireValue &v) noexcept {
+  if (v.kind != WireValue::Kind::Array) {
+    return false;
+  }
+  dst = v.text;
+  return true;
+}
+
+// Field setters, one per message type. Unknown keys are accepted and
+// ignored; a known key with a value of the wrong shape fails the message.
+
+inline bool AssignField(StreamTradeView &t, std::string_view key,
+                        const WireValue &v) noexcept {
+  if (key == "S")
+    return AssignString(t.symbol, v);
+  if (key == "t")
+    return AssignTime(t.timestamp, t.time, v);
+  if (key == "p")
+    return AssignNumber(t.price, v);
+  if (key == "s")
+    return AssignNumber(t.size, v);
+  if (key == "x")
+    return AssignString(t.exchange, v);
+  if (key == "z")
+    return AssignString(t.tape, v);
+  return true;
+}
+
+inline bool AssignField(StreamQuoteView &q, std::string_view key,
+                        const WireValue &v) noexcept {
+  if (key == "S")
+    return AssignString(q.symbol, v);
+  if (key == "t")
+    return AssignTime(q.timestamp, q.time, v);
+  if (key == "ap")
+    return AssignNumber(q.askPrice, v);
+  if (key == "bp")
+    return AssignNumber(q.bidPrice, v);
+  if (key == "as")
+    return AssignNumber(q.askSize, v);
+  if (key == "bs")
+    return AssignNumber(q.bidSize, v);
+  if (key == "ax")
+    return AssignString(q.askExchange, v);
+  if (key == "bx")
+    return AssignString(q.bidExchange, v);
+  return true;
+}
+
+inline bool AssignField(StreamBarView &b, std::string_view key,
+                        const WireValue &v) noexcept {
+  if (key == "S")
+    return AssignString(b.symbol, v);
+  if (key == "t")
+    return AssignTime(b.timestamp, b.time, v);
+  if (key == "o")
+    return AssignNumber(b.open, v);
+  if (key == "h")
+    return AssignNumber(b.high, v);
+  if (key == "l")
+    return AssignNumber(b.low, v);
+  if (key == "c")
+    return AssignNumber(b.close, v);
+  if (key == "vw")
+    return AssignNumber(b.vwap, v);
+  if (key == "v")
+    return AssignNumber(b.volume, v);
+  if (key == "n")
+    return AssignNumber(b.numTrades, v);
+  return true;
+}
+
+inline bool AssignField(StreamControlView &c, std::string_view key,
+                        const WireValue &v) noexcept {
+  if (key == "msg")
+    return AssignString(c.msg, v);
+  if (key == "code")
+    return AssignNumber(c.code, v);
+  if (key == "trades")
+    return AssignArray(c.trades, v);
+  if (key == "quotes")
+    return AssignArray(c.quotes, v);
+  if (key == "bars")
+    return AssignArray(c.bars, v);
+  return true;
+}
+
+// The string fields of each view that can hold escapes. Timestamps are
+// parsed where they are read and never have any.
+
+inline auto StringFields(StreamTradeView &t) noexcept {
+  return std::array{&t.symbol, &t.exchange, &t.tape};
+}
+
+inline auto StringFields(StreamQuoteView &q) noexcept {
+  return std::array{&q.symbol, &q.askExchange, &q.bidExchange};
+}
+
+inline auto StringFields(StreamBarView &b) noexcept {
+  return std::array{&b.symbol};
+}
+
+inline auto StringFields(StreamControlView &c) noexcept {
+  return std::array{&c.msg};
+}
+
+// Points the fields of `view` that hold escapes at decoded copies in
+// `scratch`, which must outlive the delivery.
+template <class View>
+bool UnescapeFields(View &view, std::array<std::string, 3> &scratch) {
+  auto fields = StringFields(view);
+  for (std::size_t i = 0; i < fields.size(); ++i) {
+    auto &field = *fields[i];
+    if (field.find('\\') == std::string_view::npos) {
+      continue;
+    }
+    if (!UnescapeJson(field, scratch[i])) {
+      return false;
+    }
+    field = scratch[i];
+  }
+  return true;
+}
+
+// Forward-only cursor over a JSON frame. Only what the market-data protocol
+// uses is understood: arrays of flat objects whose values are strings,
+// numbers, literals or nested arrays/objects (which are skipped whole).
+class JsonCursor {
+public:
+  explicit JsonCursor(std::string_view s) noexcept
+      : begin_(s.data()), p_(s.data()), end_(s.data() + s.size()) {}
+
+  void SkipWs() noexcept {
+    while (p_ != end_ &&
+           (*p_ == ' ' || *p_ == '\n' || *p_ == '\r' || *p_ == '\t')) {
+      ++p_;
+    }
+  }
+
+  bool Peek(char c) noexcept {
+    SkipWs();
+    return p_ != end_ && *p_ == c;
+  }
+
+  bool Consume(char c) noexcept {
+    if (!Peek(c)) {
+      return false;
+    }
+    ++p_;
+    return true;
+  }
+
+  bool AtEnd() noexcept {
+    SkipWs();
+    return p_ == end_;
+  }
+
+  bool ReadString(std::string_view &out) noexcept {
+    if (!Consume('"')) {
+      return false;
+    }
+    const char *start = p_;
+    while (p_ != end_ && *p_ != '"') {
+      if (*p_ == '\\' && p_ + 1 != end_) {
+        escaped_ = true;
+        ++p_;
+      }
+      ++p_;
+    }
+    if (p_ == end_) {
+      return false;
+    }
+    out = std::string_view(start, static_cast<std::size_t>(p_ - start));
+    ++p_;
+    return true;
+  }
+
+  bool ReadValue(WireValue &out) noexcept {
+    SkipWs();
+    if (p_ == end_) {
+      return false;
+    }
+    const char c = *p_;
+    if (c == '"') {
+      out.kind = WireValue::Kind::String;
+      return ReadString(out.text);
+    }
+    if (c == '[' || c == '{') {
+      out.kind = c == '[' ? WireValue::Kind::Array : WireValue::Kind::Object;
+      const char *start = p_;
+      if (!SkipNested()) {
+        return false;
+      }
+      out.text = std::string_view(start, static_cast<std::size_t>(p_ - start));
+      return true;
+    }
+
+    const char *start = p_;
+    const bool number = c == '-' || (c >= '0' && c <= '9');
+    while (p_ != end_ && *p_ != ',' && *p_ != '}' && *p_ != ']' &&
+           *p_ != ' ' && *p_ != '\n' && *p_ != '\r' && *p_ != '\t') {
+      ++p_;
+    }
+    if (p_ == start) {
+      return false;
+    }
+    out.kind = number ? WireValue::Kind::Number : WireValue::Kind::Literal;
+    out.text = std::string_view(start, static_cast<std::size_t>(p_ - start));
+    return true;
+  }
+
+  std::size_t Offset() const noexcept {
+    return static_cast<std::size_t>(p_ - begin_);
+  }
+
+  const char *Position() const noexcept { return p_; }
+  void Rewind(const char *pos) noexcept { p_ = pos; }
+
+  // Whether a string read since the last call had an escape.
+  bool TakeEscaped() noexcept { return std::exchange(escaped_, false); }
+
+private:
+  bool SkipNested() noexcept {
+    int depth = 0;
+    while (p_ != end_) {
+      const char c = *p_;
+      if (c == '"') {
+        std::string_view ignored;
+        if (!ReadString(ignored)) {
+          return false;
+        }
+        continue;
+      }
+      ++p_;
+      if (c == '[' || c == '{') {
+        ++depth;
+      } else if ((c == ']' || c == '}') && --depth == 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  const char *begin_;
+  const char *p_;
+  const char *end_;
+  bool escaped_{false};
+};
+
+// Reads the remaining "key": value pairs of the current object into `view`,
+// consuming the closing brace.
+template <class View>
+bool DecodeFields(JsonCursor &cur, View &view, bool first) noexcept {
+  while (!cur.Consume('}')) {
+    if (!first && !cur.Consume(',')) {
+      return false;
+    }
+    first = false;
+    std::string_view key;
+    WireValue value;
+    if (!cur.ReadString(key) || !cur.Consume(':') || !cur.ReadValue(value) ||
+        !AssignField(view, key, value)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Finds the "T" of the object starting at the cursor (just past '{') without
+// moving it; empty when there is none. Only needed when "T" is not the first
+// key.
+inline std::optional<std::string_view> FindType(JsonCursor cur) noexcept {
+  for (bool first = true; !cur.Consume('}'); first = false) {
+    if (!first && !cur.Consume(',')) {
+      return std::nullopt;
+    }
+    std::string_view key;
+    WireValue value;
+    if (!cur.ReadString(key) || !cur.Consume(':') || !cur.ReadValue(value)) {
+      return std::nullopt;
+    }
+    if (key == "T") {
+      return value.AsString();
+    }
+  }
+  return std::string_view{};
+}
+
+template <class View, class F>
+bool DecodeAs(JsonCursor &cur, const char *body, bool first, F &&deliver) {
+  View view{};
+  if (body) {
+    cur.Rewind(body);
+  }
+  cur.TakeEscaped();
+  if (!DecodeFields(cur, view, first)) {
+    return false;
+  }
+  if (cur.TakeEscaped()) {
+    std::array<std::string, 3> scratch;
+    if (!UnescapeFields(view, scratch)) {
+      return false;
+    }
+    deliver(view);
+    return true;
+  }
+  deliver(view);
+  return true;
+}
+
+template <class Handler>
+bool DecodeMessage(JsonCursor &cur, Handler &h) {
+  if (!cur.Consume('{')) {
+    return false;
+  }
+  const char *body = cur.Position();
+
+  // Alpaca always sends "T" first, so the usual path dispatches right away
+  // and decodes the rest of the object in one pass.
+  std::string_view type;
+  bool first = true;
+  const char *rewind = nullptr;
+  std::string_view key;
+  if (!cur.Peek('}') && cur.ReadString(key) && key == "T" && cur.Consume(':') &&
+      cur.ReadString(type)) {
+    first = false;
+  } else {
+    cur.Rewind(body);
+    const auto found = FindType(cur);
+    if (!found) {
+      return false;
+    }
+    type = *found;
+    rewind = body;
+  }
+
+  if (type == "q") {
+    return DecodeAs<StreamQuoteView>(
+        cur, rewind, first, [&](auto &v) { h.OnQuote(v); });
+  }
+  if (type == "t") {
+    return DecodeAs<StreamTradeView>(
+        cur, rewind, first, [&](auto &v) { h.OnTrade(v); });
+  }
+  if (type == "b") {
+    return DecodeAs<StreamBarView>(cur, rewind, first,
+                                   [&](auto &v) { h.OnBar(v); });
+  }
+  if (type == "success" || type == "subscription" || type == "error") {
+    return DecodeAs<StreamControlView>(cur, rewind, first, [&](auto &v) {
+      v.type = type;
+      h.OnControl(v);
+    });
+  }
+
+  // Unknown T values are skipped.
+  WireValue ignored;
+  cur.Rewind(body - 1);
+  return cur.ReadValue(ignored);
+}
+
+// Reads a raw JSON array of strings, e.g. a StreamControlView list, into
+// `out`.
+inline bool ReadStringList(std::string_view raw,
+                           std::vector<std::string> &out) {
+  JsonCursor cur(raw);
+  out.clear();
+  if (!cur.Consume('[')) {
+    return false;
+  }
+  for (bool first = true; !cur.Consume(']'); first = false) {
+    std::string_view s;
+    if ((!first && !cur.Consume(',')) || !cur.ReadString(s)) {
+      return false;
+    }
+    if (cur.TakeEscaped()) {
+      if (!UnescapeJson(s, out.emplace_back())) {
+        return false;
+      }
+      continue;
+    }
+    out.emplace_back(s);
+  }
+  return cur.AtEnd();
+}
+
+} // namespace detail
+
+// Decodes one market-data frame, a JSON array of messages (a lone object is
+// accepted too), without allocating. Each message is dispatched on "T" and
+// parsed straight into the matching view, then handed to `h.OnTrade`,
+// `h.OnQuote`, `h.OnBar` or `h.OnControl`. Messages before a malformed one
+// have already been delivered when the error is returned.
+template <class Handler>
+std::optional<std::string> DecodeMarketDataFrame(std::string_view frame,
+                                                 Handler &&h) {
+  detail::JsonCursor cur(frame);
+  auto fail = [&] {
+    return std::make_optional(std::format(
+        "Malformed market data frame at offset {}", cur.Offset()));
+  };
+
+  if (cur.Peek('{')) {
+    if (!detail::DecodeMessage(cur, h) || !cur.AtEnd()) {
+      return fail();
+    }
+    return std::nullopt;
+  }
+
+  if (!cur.Consume('[')) {
+    return fail();
+  }
+  for (bool first = true; !cur.Consume(']'); first = false) {
+    if ((!first && !cur.Consume(',')) || !detail::DecodeMessage(cur, h)) {
+      return fail();
+    }
+  }
+  if (!cur.AtEnd()) {
+    return fail();
+  }
+  return std::nullopt;
+}
+
+} // namespace alpaca
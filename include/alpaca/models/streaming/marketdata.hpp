@@ -1,7 +1,16 @@
 #pragma once
 #include <alpaca/client/httpClient.hpp>
+#include <alpaca/client/reconnect.hpp>
+#include <alpaca/models/common/timestamp.hpp>
+#include <alpaca/utils/latency.hpp>
+#include <alpaca/utils/symbolTable.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <string>
+#include <string_view>
+#include <variant>
 #include <vector>
 
 namespace alpaca {
@@ -13,6 +22,9 @@ struct StreamTrade {
   std::string tape;
   double price{};
   int64_t size{};
+  Timestamp time{};
+  SymbolId symbolId{kNoSymbol};
+  ReceiveTime received{};
 };
 
 struct StreamQuote {
@@ -22,6 +34,9 @@ struct StreamQuote {
   double bidPrice{};
   int64_t askSize{};
   int64_t bidSize{};
+  Timestamp time{};
+  SymbolId symbolId{kNoSymbol};
+  ReceiveTime received{};
 };
 
 struct StreamBar {
@@ -34,6 +49,159 @@ struct StreamBar {
   double vwap{};
   int64_t volume{};
   int64_t numTrades{};
+  Timestamp time{};
+  SymbolId symbolId{kNoSymbol};
+  ReceiveTime received{};
+};
+
+// Zero-copy counterparts of the types above, handed to the *View callbacks.
+// String members point into the received frame and are only valid for the
+// duration of the callback; copy whatever must outlive it. `timestamp` is the
+// raw wire text (empty for msgpack frames), `time` the same instant decoded.
+// `symbolId` is the stream's interned id for `symbol` (see SymbolTable).
+// `received` is when the frame carrying the message came off the socket; in
+// the owning types above too.
+
+struct StreamTradeView {
+  std::string_view symbol;
+  std::string_view timestamp;
+  std::string_view exchange;
+  std::string_view tape;
+  double price{};
+  int64_t size{};
+  Timestamp time{};
+  SymbolId symbolId{kNoSymbol};
+  ReceiveTime received{};
+};
+
+struct StreamQuoteView {
+  std::string_view symbol;
+  std::string_view timestamp;
+  std::string_view askExchange;
+  std::string_view bidExchange;
+  double askPrice{};
+  double bidPrice{};
+  int64_t askSize{};
+  int64_t bidSize{};
+  Timestamp time{};
+  SymbolId symbolId{kNoSymbol};
+  ReceiveTime received{};
+};
+
+struct StreamBarView {
+  std::string_view symbol;
+  std::string_view timestamp;
+  double open{};
+  double high{};
+  double low{};
+  double close{};
+  double vwap{};
+  int64_t volume{};
+  int64_t numTrades{};
+  Timestamp time{};
+  SymbolId symbolId{kNoSymbol};
+  ReceiveTime received{};
+};
+
+// Wire format of a market-data connection. Msgpack frames are binary and
+// smaller, with numbers and timestamps that need no text parsing.
+enum class StreamEncoding { Json, Msgpack };
+
+// "success", "subscription" and "error" messages. For "subscription" the
+// lists are the raw arrays of the confirmed symbols, in `encoding`.
+struct StreamControlView {
+  StreamEncoding encoding{StreamEncoding::Json};
+  std::string_view type;
+  std::string_view msg;
+  int code{};
+  std::string_view trades;
+  std::string_view quotes;
+  std::string_view bars;
+};
+
+// Compact copies of trades, quotes and bars for queued delivery. They own
+// nothing, so they can sit in a ring between threads; the symbol is
+// `symbolId` (resolve it with the stream's Symbols().Name()) and `received`
+// is as in the views.
+
+struct TradeEvent {
+  SymbolId symbolId{kNoSymbol};
+  Timestamp time{};
+  ReceiveTime received{};
+  double price{};
+  int64_t size{};
+};
+
+struct QuoteEvent {
+  SymbolId symbolId{kNoSymbol};
+  Timestamp time{};
+  ReceiveTime received{};
+  double askPrice{};
+  double bidPrice{};
+  int64_t askSize{};
+  int64_t bidSize{};
+  // Earlier quotes for the symbol this one replaced (DeliveryMode::Conflated
+  // only).
+  uint32_t coalesced{};
+};
+
+struct BarEvent {
+  SymbolId symbolId{kNoSymbol};
+  Timestamp time{};
+  ReceiveTime received{};
+  double open{};
+  double high{};
+  double low{};
+  double close{};
+  double vwap{};
+  int64_t volume{};
+  int64_t numTrades{};
+};
+
+using MarketDataEvent = std::variant<TradeEvent, QuoteEvent, BarEvent>;
+
+enum class DeliveryMode {
+  // Trade/quote/bar callbacks run on the socket thread.
+  Inline,
+  // Events go into a bounded ring and are taken out by the caller's thread
+  // with Poll()/Drain(); the trade/quote/bar callbacks are not used.
+  Queued,
+  // Like Queued, but quotes are not queued: each symbol keeps only its
+  // latest quote until the consumer takes it. Trades and bars still go
+  // through the ring.
+  Conflated,
+};
+
+// What the socket thread does when the ring is full.
+enum class OverflowPolicy {
+  // Wait for the consumer (stalls socket reads).
+  Block,
+  // Discard the incoming event.
+  DropNewest,
+  // Discard the oldest queued event to make room.
+  DropOldest,
+};
+
+struct MarketDataDelivery {
+  DeliveryMode mode{DeliveryMode::Inline};
+  // Rounded up to a power of two.
+  std::size_t capacity{std::size_t{1} << 16};
+  OverflowPolicy overflow{OverflowPolicy::DropOldest};
+  // Quote slots for DeliveryMode::Conflated, indexed by symbol id; quotes
+  // for ids at or above it are dropped.
+  std::size_t maxSymbols{std::size_t{1} << 14};
+};
+
+struct DeliveryStats {
+  uint64_t enqueued{};
+  // Events lost to a full ring, whichever end was discarded.
+  uint64_t dropped{};
+  // Events that had to wait for room under OverflowPolicy::Block.
+  uint64_t blocked{};
+  // Quotes overwritten by a newer one before they were taken.
+  uint64_t coalesced{};
+  // Queued events plus symbols with a conflated quote waiting.
+  std::size_t queued{};
 };
 
 struct MarketDataSubscription {
@@ -43,13 +211,30 @@ struct MarketDataSubscription {
   std::string feed{"iex"};
 };
 
+// The symbol lists of a MarketDataSubscription, for code that treats every
+// channel alike.
+inline constexpr std::array kSubscriptionLists{
+    &MarketDataSubscription::trades, &MarketDataSubscription::quotes,
+    &MarketDataSubscription::bars};
+
+// Code of the "error" message the server sends before closing a connection
+// that would exceed the account's market-data connection limit.
+inline constexpr int kConnectionLimitExceeded = 406;
+
 struct MarketDataCallbacks {
   std::function<void(StreamTrade)> onTrade;
   std::function<void(StreamQuote)> onQuote;
   std::function<void(StreamBar)> onBar;
+  // Allocation-free alternatives to onTrade/onQuote/onBar; both kinds may be
+  // set, views are delivered first.
+  std::function<void(const StreamTradeView &)> onTradeView;
+  std::function<void(const StreamQuoteView &)> onQuoteView;
+  std::function<void(const StreamBarView &)> onBarView;
   std::function<void(APIError)> onError;
   std::function<void()> onConnected;
   std::function<void()> onDisconnected;
+  // After an automatic reconnect, once the subscription is confirmed again.
+  std::function<void(const ReconnectGap &)> onReconnected;
 };
 
 } // namespace alpaca
@@ -0,0 +1,557 @@
+#pragma once
+#include <alpaca/models/common/timestamp.hpp>
+#include <alpaca/models/streaming/marketDataDecoder.hpp>
+#include <alpaca/models/streaming/marketdata.hpp>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace alpaca {
+
+namespace detail {
+
+// Forward-only reader over a msgpack frame, yielding the same WireValues as
+// JsonCursor: integers, floats and timestamps (extension type -1) come out
+// decoded, strings as views of their bytes, arrays and maps as their raw
+// bytes (skipped whole).
+class MsgpackCursor {
+public:
+  explicit MsgpackCursor(std::string_view s) noexcept
+      : begin_(reinterpret_cast<const unsigned char *>(s.data())),
+        p_(begin_), end_(begin_ + s.size()) {}
+
+  bool AtEnd() const noexcept { return p_ == end_; }
+
+  bool ReadMapHeader(uint32_t &n) noexcept {
+    return ReadHeader(n, 0x80, 0xde, 0xdf);
+  }
+
+  bool ReadArrayHeader(uint32_t &n) noexcept {
+    return ReadHeader(n, 0x90, 0xdc, 0xdd);
+  }
+
+  bool ReadString(std::string_view &out) noexcept {
+    if (p_ == end_) {
+      return false;
+    }
+    const auto c = *p_;
+    uint32_t len;
+    if ((c & 0xe0) == 0xa0) {
+      ++p_;
+      len = c & 0x1f;
+    } else if (c >= 0xd9 && c <= 0xdb) {
+      ++p_;
+      if (!ReadLength(len, c - 0xd9)) {
+        return false;
+      }
+    } else {
+      return false;
+    }
+    return Take(len, out);
+  }
+
+  bool ReadValue(WireValue &out, int depth = 0) noexcept {
+    if (p_ == end_) {
+      return false;
+    }
+    const auto *start = p_;
+    const auto c = *p_;
+
+    if (c <= 0x7f || c >= 0xe0) {
+      ++p_;
+      out.kind = WireValue::Kind::Int;
+      out.i = static_cast<int8_t>(c);
+      return true;
+    }
+    if ((c & 0xe0) == 0xa0 || (c >= 0xd9 && c <= 0xdb)) {
+      out.kind = WireValue::Kind::String;
+      return ReadString(out.text);
+    }
+    const bool map = (c & 0xf0) == 0x80 || c == 0xde || c == 0xdf;
+    const bool array = (c & 0xf0) == 0x90 || c == 0xdc || c == 0xdd;
+    if (map || array) {
+      if (depth >= kMaxDepth || !SkipContainer(map, depth)) {
+        return false;
+      }
+      out.kind = map ? WireValue::Kind::Object : WireValue::Kind::Array;
+      out.text = Since(start);
+      return true;
+    }
+
+    ++p_;
+    switch (c) {
+    case 0xc0:
+      return Literal(out, "null");
+    case 0xc2:
+      return Literal(out, "false");
+    case 0xc3:
+      return Literal(out, "true");
+    case 0xca: {
+      uint32_t bits;
+      if (!ReadBE(bits)) {
+        return false;
+      }
+      out.kind = WireValue::Kind::Float;
+      out.f = std::bit_cast<float>(bits);
+      return true;
+    }
+    case 0xcb: {
+      uint64_t bits;
+      if (!ReadBE(bits)) {
+        return false;
+      }
+      out.kind = WireValue::Kind::Float;
+      out.f = std::bit_cast<double>(bits);
+      return true;
+    }
+    case 0xcc:
+      return ReadInt<uint8_t>(out);
+    case 0xcd:
+      return ReadInt<uint16_t>(out);
+    case 0xce:
+      return ReadInt<uint32_t>(out);
+    case 0xcf:
+      return ReadInt<uint64_t>(out);
+    case 0xd0:
+      return ReadInt<int8_t>(out);
+    case 0xd1:
+      return ReadInt<int16_t>(out);
+    case 0xd2:
+      return ReadInt<int32_t>(out);
+    case 0xd3:
+      return ReadInt<int64_t>(out);
+    case 0xc4:
+    case 0xc5:
+    case 0xc6: {
+      uint32_t len;
+      out.kind = WireValue::Kind::String;
+      return ReadLength(len, c - 0xc4) && Take(len, out.text);
+    }
+    case 0xd4:
+      return ReadExt(out, 1, start);
+    case 0xd5:
+      return ReadExt(out, 2, start);
+    case 0xd6:
+      return ReadExt(out, 4, start);
+    case 0xd7:
+      return ReadExt(out, 8, start);
+    case 0xd8:
+      return ReadExt(out, 16, start);
+    case 0xc7:
+    case 0xc8:
+    case 0xc9: {
+      uint32_t len;
+      return ReadLength(len, c - 0xc7) && ReadExt(out, len, start);
+    }
+    default:
+      return false;
+    }
+  }
+
+  std::size_t Offset() const noexcept {
+    return static_cast<std::size_t>(p_ - begin_);
+  }
+
+  const unsigned char *Position() const noexcept { return p_; }
+  void Rewind(const unsigned char *pos) noexcept { p_ = pos; }
+
+private:
+  static constexpr int kMaxDepth = 32;
+
+  template <class T> bool ReadBE(T &out) noexcept {
+    if (static_cast<std::size_t>(end_ - p_) < sizeof(T)) {
+      return false;
+    }
+    std::make_unsigned_t<T> v = 0;
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+      v = static_cast<std::make_unsigned_t<T>>((v << 8) | p_[i]);
+    }
+    p_ += sizeof(T);
+    out = static_cast<T>(v);
+    return true;
+  }
+
+  // `width` 0, 1, 2 selects an 8, 16 or 32-bit length.
+  bool ReadLength(uint32_t &len, int width) noexcept {
+    if (width == 0) {
+      uint8_t n;
+      if (!ReadBE(n)) {
+        return false;
+      }
+      len = n;
+      return true;
+    }
+    if (width == 1) {
+      uint16_t n;
+      if (!ReadBE(n)) {
+        return false;
+      }
+      len = n;
+      return true;
+    }
+    return ReadBE(len);
+  }
+
+  bool ReadHeader(uint32_t &n, unsigned char fix, unsigned char b16,
+                  unsigned char b32) noexcept {
+    if (p_ == end_) {
+      return false;
+    }
+    const auto c = *p_;
+    if ((c & 0xf0) == fix) {
+      ++p_;
+      n = c & 0x0f;
+      return true;
+    }
+    if (c == b16 || c == b32) {
+      ++p_;
+      return ReadLength(n, c == b16 ? 1 : 2);
+    }
+    return false;
+  }
+
+  bool Take(uint32_t len, std::string_view &out) noexcept {
+    if (static_cast<std::size_t>(end_ - p_) < len) {
+      return false;
+    }
+    out = std::string_view(reinterpret_cast<const char *>(p_), len);
+    p_ += len;
+    return true;
+  }
+
+  template <class T> bool ReadInt(WireValue &out) noexcept {
+    T v;
+    if (!ReadBE(v)) {
+      return false;
+    }
+    if constexpr (std::is_same_v<T, uint64_t>) {
+      if (v > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+        return false;
+      }
+    }
+    out.kind = WireValue::Kind::Int;
+    out.i = static_cast<int64_t>(v);
+    return true;
+  }
+
+  static bool Literal(WireValue &out, std::string_view text) noexcept {
+    out.kind = WireValue::Kind::Literal;
+    out.text = text;
+    return true;
+  }
+
+  // Extension payload of `len` bytes after its type byte. Timestamps (type
+  // -1) are decoded, other extensions kept as raw literals.
+  bool ReadExt(WireValue &out, uint32_t len,
+               const unsigned char *start) noexcept {
+    int8_t type;
+    std::string_view data;
+    if (!ReadBE(type) || !Take(len, data)) {
+      return false;
+    }
+    if (type != -1) {
+      out.kind = WireValue::Kind::Literal;
+      out.text = Since(start);
+      return true;
+    }
+
+    MsgpackCursor body(data);
+    int64_t sec;
+    uint32_t nsec;
+    if (len == 4) {
+      uint32_t s;
+      if (!body.ReadBE(s)) {
+        return false;
+      }
+      sec = s;
+      nsec = 0;
+    } else if (len == 8) {
+      uint64_t v;
+      if (!body.ReadBE(v)) {
+        return false;
+      }
+      nsec = static_cast<uint32_t>(v >> 34);
+      sec = static_cast<int64_t>(v & 0x3ffffffffull);
+    } else if (len == 12) {
+      if (!body.ReadBE(nsec) || !body.ReadBE(sec)) {
+        return false;
+      }
+    } else {
+      return false;
+    }
+    out.kind = WireValue::Kind::Time;
+    out.time = Timestamp{std::chrono::sys_time<std::chrono::nanoseconds>{
+        std::chrono::seconds{sec} + std::chrono::nanoseconds{nsec}}};
+    return true;
+  }
+
+  bool SkipContainer(bool map, int depth) noexcept {
+    uint32_t n;
+    if (map ? !ReadMapHeader(n) : !ReadArrayHeader(n)) {
+      return false;
+    }
+    const uint64_t items = map ? uint64_t{n} * 2 : n;
+    for (uint64_t k = 0; k < items; ++k) {
+      WireValue ignored;
+      if (!ReadValue(ignored, depth + 1)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  std::string_view Since(const unsigned char *start) const noexcept {
+    return std::string_view(reinterpret_cast<const char *>(start),
+                            static_cast<std::size_t>(p_ - start));
+  }
+
+  const unsigned char *begin_;
+  const unsigned char *p_;
+  const unsigned char *end_;
+};
+
+template <class View>
+bool DecodeMsgpackFields(MsgpackCursor &cur, View &view,
+                         uint32_t n) noexcept {
+  for (; n > 0; --n) {
+    std::string_view key;
+    WireValue value;
+    if (!cur.ReadString(key) || !cur.ReadValue(value) ||
+        !AssignField(view, key, value)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// "T" of the map whose `n` entries start at the cursor, without moving it;
+// empty when there is none.
+inline std::optional<std::string_view> FindMsgpackType(MsgpackCursor cur,
+                                                       uint32_t n) noexcept {
+  for (; n > 0; --n) {
+    std::string_view key;
+    WireValue value;
+    if (!cur.ReadString(key) || !cur.ReadValue(value)) {
+      return std::nullopt;
+    }
+    if (key == "T") {
+      return value.AsString();
+    }
+  }
+  return std::string_view{};
+}
+
+template <class View, class F>
+bool DecodeMsgpackAs(MsgpackCursor &cur, uint32_t n, F &&deliver) {
+  View view{};
+  if (!DecodeMsgpackFields(cur, view, n)) {
+    return false;
+  }
+  deliver(view);
+  return true;
+}
+
+template <class Handler>
+bool DecodeMsgpackMessage(MsgpackCursor &cur, Handler &h) {
+  uint32_t n;
+  if (!cur.ReadMapHeader(n)) {
+    return false;
+  }
+  const auto *body = cur.Position();
+
+  // Same fast path as the JSON decoder: "T" normally comes first.
+  std::string_view type;
+  std::string_view key;
+  uint32_t rest = n;
+  if (n > 0 && cur.ReadString(key) && key == "T" && cur.ReadString(type)) {
+    rest = n - 1;
+  } else {
+    cur.Rewind(body);
+    const auto found = FindMsgpackType(cur, n);
+    if (!found) {
+      return false;
+    }
+    type = *found;
+  }
+
+  if (type == "q") {
+    return DecodeMsgpackAs<StreamQuoteView>(cur, rest,
+                                            [&](auto &v) { h.OnQuote(v); });
+  }
+  if (type == "t") {
+    return DecodeMsgpackAs<StreamTradeView>(cur, rest,
+                                            [&](auto &v) { h.OnTrade(v); });
+  }
+  if (type == "b") {
+    return DecodeMsgpackAs<StreamBarView>(cur, rest,
+                                          [&](auto &v) { h.OnBar(v); });
+  }
+  if (type == "success" || type == "subscription" || type == "error") {
+    return DecodeMsgpackAs<StreamControlView>(cur, rest, [&](auto &v) {
+      v.encoding = StreamEncoding::Msgpack;
+      v.type = type;
+      h.OnControl(v);
+    });
+  }
+
+  // Unknown T values are skipped.
+  cur.Rewind(body);
+  for (; n > 0; --n) {
+    WireValue ignored;
+    if (!cur.ReadValue(ignored) || !cur.ReadValue(ignored)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Reads a raw msgpack array of strings, e.g. a StreamControlView list, into
+// `out`.
+inline bool ReadMsgpackStringList(std::string_view raw,
+                                  std::vector<std::string> &out) {
+  MsgpackCursor cur(raw);
+  out.clear();
+  uint32_t n;
+  if (!cur.ReadArrayHeader(n)) {
+    return false;
+  }
+  for (; n > 0; --n) {
+    std::string_view s;
+    if (!cur.ReadString(s)) {
+      return false;
+    }
+    out.emplace_back(s);
+  }
+  return cur.AtEnd();
+}
+
+// Minimal msgpack writer for the client's control messages.
+class MsgpackWriter {
+public:
+  explicit MsgpackWriter(std::string &out) noexcept : out_(out) {}
+
+  void Map(uint32_t n) { Header(n, 0x80, 0xde, 0xdf); }
+  void Array(uint32_t n) { Header(n, 0x90, 0xdc, 0xdd); }
+
+  void String(std::string_view s) {
+    const auto n = static_cast<uint32_t>(s.size());
+    if (n < 32) {
+      out_ += static_cast<char>(0xa0 | n);
+    } else if (n <= 0xff) {
+      out_ += static_cast<char>(0xd9);
+      BE(n, 1);
+    } else if (n <= 0xffff) {
+      out_ += static_cast<char>(0xda);
+      BE(n, 2);
+    } else {
+      out_ += static_cast<char>(0xdb);
+      BE(n, 4);
+    }
+    out_ += s;
+  }
+
+  void Strings(const std::vector<std::string> &list) {
+    Array(static_cast<uint32_t>(list.size()));
+    for (const auto &s : list) {
+      String(s);
+    }
+  }
+
+private:
+  void Header(uint32_t n, unsigned char fix, unsigned char b16,
+              unsigned char b32) {
+    if (n < 16) {
+      out_ += static_cast<char>(fix | n);
+    } else if (n <= 0xffff) {
+      out_ += static_cast<char>(b16);
+      BE(n, 2);
+    } else {
+      out_ += static_cast<char>(b32);
+      BE(n, 4);
+    }
+  }
+
+  void BE(uint32_t v, int bytes) {
+    for (int i = bytes - 1; i >= 0; --i) {
+      out_ += static_cast<char>((v >> (8 * i)) & 0xff);
+    }
+  }
+
+  std::string &out_;
+};
+
+inline std::string EncodeMsgpackAuth(std::string_view key,
+                                     std::string_view secret) {
+  std::string out;
+  MsgpackWriter w(out);
+  w.Map(3);
+  w.String("action");
+  w.String("auth");
+  w.String("key");
+  w.String(key);
+  w.String("secret");
+  w.String(secret);
+  return out;
+}
+
+// {"action": action, "trades": [...], "quotes": [...], "bars": [...]}
+inline std::string EncodeMsgpackAction(std::string_view action,
+                                       const MarketDataSubscription &sub) {
+  std::string out;
+  MsgpackWriter w(out);
+  w.Map(4);
+  w.String("action");
+  w.String(action);
+  w.String("trades");
+  w.Strings(sub.trades);
+  w.String("quotes");
+  w.Strings(sub.quotes);
+  w.String("bars");
+  w.Strings(sub.bars);
+  return out;
+}
+
+} // namespace detail
+
+// Msgpack counterpart of DecodeMarketDataFrame: the frame is an array of
+// maps (a lone map is accepted too) and produces the same views, handed to
+// the same handler methods. Timestamps arrive as msgpack timestamps, so the
+// views' `timestamp` text is empty and only `time` is set.
+template <class Handler>
+std::optional<std::string> DecodeMarketDataMsgpack(std::string_view frame,
+                                                   Handler &&h) {
+  detail::MsgpackCursor cur(frame);
+  auto fail = [&] {
+    return std::make_optional(std::format(
+        "Malformed market data frame at offset {}", cur.Offset()));
+  };
+
+  const auto *start = cur.Position();
+  uint32_t n;
+  if (!cur.ReadArrayHeader(n)) {
+    cur.Rewind(start);
+    if (!detail::DecodeMsgpackMessage(cur, h) || !cur.AtEnd()) {
+      return fail();
+    }
+    return std::nullopt;
+  }
+  for (; n > 0; --n) {
+    if (!detail::DecodeMsgpackMessage(cur, h)) {
+      return fail();
+    }
+  }
+  if (!cur.AtEnd()) {
+    return fail();
+  }
+  return std::nullopt;
+}
+
+} // namespace alpaca
@@ -7,61 +7,35 @@
 
 namespace alpaca {
 
-// ── Market data wire ────────────────────────────────────
-// Single fat struct
-// that covers all market-data message types. Fields not present in a given
-// message are left at their zero-initialized defaults; unknown JSON keys are
-// ignored via error_on_unknown_keys = false.
-
-struct MarketDataMsgWire {
-  std::string type;      // "T"  – type discriminator
-  std::string msg;       // "msg" – auth success/error message
-  int code{};            // "code" – error code
-  std::string symbol;    // "S"
-  std::string timestamp; // "t"
-  // trade
-  double price{};       // "p"
-  int64_t tradeSize{};  // "s"
-  std::string exchange; // "x"
-  std::string tape;     // "z"
-  // quote
-  double askPrice{};       // "ap"
-  double bidPrice{};       // "bp"
-  int64_t askSize{};       // "as"
-  int64_t bidSize{};       // "bs"
-  std::string askExchange; // "ax"
-  std::string bidExchange; // "bx"
-  // bar
-  double barOpen{};       // "o"
-  double barHigh{};       // "h"
-  double barLow{};        // "l"
-  double barClose{};      // "c"
-  double barVwap{};       // "vw"
-  int64_t barVolume{};    // "v"
-  int64_t barNumTrades{}; // "n"
-};
-
 // ── Trade-update stream wire
 // ──────────────────────────────────────────────────
 
-struct TradingAuthDataWire {
+// The order fields LeanTradeUpdate needs; everything else is skipped.
+struct TradeUpdateOrderLeanWire {
+  std::string id;
+  std::string clientOrderID;
+  std::string symbol;
   std::string status;
+  Decimal filledQty{};
+  std::optional<Decimal> filledAvgPrice;
 };
 
-struct TradingStreamBaseWire {
-  std::string stream;
-  TradingAuthDataWire data;
-};
-
-struct TradeUpdateDataWire {
+// Any trade-stream frame, read in one pass whatever its `stream`:
+// authorization frames fill `status`, trade updates the rest. `Order` is
+// OrderResponse or TradeUpdateOrderLeanWire.
+template <class Order> struct TradingStreamDataWire {
+  std::string status;
   std::string event;
   std::string at;
-  OrderResponse order{};
+  std::optional<Decimal> price;
+  std::optional<Decimal> qty;
+  std::optional<Decimal> positionQty;
+  Order order{};
 };
 
-struct TradeUpdateEnvelopeWire {
+template <class Order> struct TradingStreamWire {
   std::string stream;
-  TradeUpdateDataWire data;
+  TradingStreamDataWire<Order> data;
 };
 
 // ── Helper: event string → enum
@@ -96,35 +70,24 @@ inline TradeUpdateEvent ParseTradeUpdateEvent(const std::string &s) noexcept {
 // ────────────────────────────────────────────────────────────────
 namespace glz {
 
-template <> struct meta<alpaca::MarketDataMsgWire> {
-  using T = alpaca::MarketDataMsgWire;
-  static constexpr auto value = object(
-      "T", &T::type, "msg", &T::msg, "code", &T::code, "S", &T::symbol, "t",
-      &T::timestamp, "p", &T::price, "s", &T::tradeSize, "x", &T::exchange, "z",
-      &T::tape, "ap", &T::askPrice, "bp", &T::bidPrice, "as", &T::askSize, "bs",
-      &T::bidSize, "ax", &T::askExchange, "bx", &T::bidExchange, "o",
-      &T::barOpen, "h", &T::barHigh, "l", &T::barLow, "c", &T::barClose, "vw",
-      &T::barVwap, "v", &T::barVolume, "n", &T::barNumTrades);
-};
-
-template <> struct meta<alpaca::TradingAuthDataWire> {
-  using T = alpaca::TradingAuthDataWire;
-  static constexpr auto value = object("status", &T::status);
-};
-
-template <> struct meta<alpaca::TradingStreamBaseWire> {
-  using T = alpaca::TradingStreamBaseWire;
-  static constexpr auto value = object("stream", &T::stream, "data", &T::data);
+template <> struct meta<alpaca::TradeUpdateOrderLeanWire> {
+  using T = alpaca::TradeUpdateOrderLeanWire;
+  static constexpr auto value =
+      object("id", &T::id, "client_order_id", &T::clientOrderID, "symbol",
+             &T::symbol, "status", &T::status, "filled_qty", &T::filledQty,
+             "filled_avg_price", &T::filledAvgPrice);
 };
 
-template <> struct meta<alpaca::TradeUpdateDataWire> {
-  using T = alpaca::TradeUpdateDataWire;
+template <class Order> struct meta<alpaca::TradingStreamDataWire<Order>> {
+  using T = alpaca::TradingStreamDataWire<Order>;
   static constexpr auto value =
-      object("event", &T::event, "at", &T::at, "order", &T::order);
+      object("status", &T::status, "event", &T::event, "at", &T::at, "price",
+             &T::price, "qty", &T::qty, "position_qty", &T::positionQty,
+             "order", &T::order);
 };
 
-template <> struct meta<alpaca::TradeUpdateEnvelopeWire> {
-  using T = alpaca::TradeUpdateEnvelopeWire;
+template <class Order> struct meta<alpaca::TradingStreamWire<Order>> {
+  using T = alpaca::TradingStreamWire<Order>;
   static constexpr auto value = object("stream", &T::stream, "data", &T::data);
 };
 
@@ -1,7 +1,11 @@
 #pragma once
 #include <alpaca/client/httpClient.hpp>
+#include <alpaca/client/reconnect.hpp>
+#include <alpaca/models/common/decimal.hpp>
 #include <alpaca/models/trading/order.hpp>
+#include <alpaca/utils/latency.hpp>
 #include <functional>
+#include <optional>
 #include <string>
 
 namespace alpaca {
@@ -24,13 +28,42 @@ struct TradeUpdate {
   TradeUpdateEvent event{TradeUpdateEvent::unknown};
   std::string at;
   OrderResponse order{};
+  // Execution that caused a fill or partial_fill: its price and quantity,
+  // and the position size after it.
+  std::optional<Decimal> price;
+  std::optional<Decimal> qty;
+  std::optional<Decimal> positionQty;
+  // When the frame came off the socket.
+  ReceiveTime received{};
+};
+
+// The part of a trade update that latency-sensitive consumers act on. When
+// only onLeanUpdate is set the rest of the order is never materialized.
+struct LeanTradeUpdate {
+  TradeUpdateEvent event{TradeUpdateEvent::unknown};
+  std::string at;
+  std::string orderID;
+  std::string clientOrderID;
+  std::string symbol;
+  std::string status;
+  Decimal filledQty{};
+  std::optional<Decimal> filledAvgPrice;
+  std::optional<Decimal> price;
+  std::optional<Decimal> qty;
+  std::optional<Decimal> positionQty;
+  ReceiveTime received{};
 };
 
 struct TradeUpdateCallbacks {
   std::function<void(TradeUpdate)> onUpdate;
+  // Delivered before onUpdate when both are set.
+  std::function<void(LeanTradeUpdate)> onLeanUpdate;
   std::function<void(APIError)> onError;
   std::function<void()> onConnected;
   std::function<void()> onDisconnected;
+  // After an automatic reconnect, once listening again. Orders may have
+  // changed during the gap; refresh them with GetAllOrders.
+  std::function<void(const ReconnectGap &)> onReconnected;
 };
 
 } // namespace alpaca
@@ -1,4 +1,5 @@
 #pragma once
+#include <alpaca/models/common/decimal.hpp>
 #include <glaze/glaze.hpp>
 
 namespace alpaca {
@@ -35,16 +36,16 @@ struct Account {
 
   std::string currency{};
 
-  std::string buying_power{};
-  std::string regt_buying_power{};
-  std::string daytrading_buying_power{};
-  std::string effective_buying_power{};
-  std::string non_marginable_buying_power{};
-  std::string options_buying_power{};
-  std::string bod_dtbp{};
-  std::string cash{};
-  std::string accrued_fees{};
-  std::string portfolio_value{};
+  Decimal buying_power{};
+  Decimal regt_buying_power{};
+  Decimal daytrading_buying_power{};
+  Decimal effective_buying_power{};
+  Decimal non_marginable_buying_power{};
+  Decimal options_buying_power{};
+  Decimal bod_dtbp{};
+  Decimal cash{};
+  Decimal accrued_fees{};
+  Decimal portfolio_value{};
 
   bool pattern_day_trader{};
   bool trading_blocked{};
@@ -54,25 +55,25 @@ struct Account {
   std::string created_at{};
   bool trade_suspended_by_user{};
 
-  std::string multiplier{};
+  Decimal multiplier{};
   bool shorting_enabled{};
 
-  std::string equity{};
-  std::string last_equity{};
-  std::string long_market_value{};
-  std::string short_market_value{};
-  std::string position_market_value{};
-  std::string initial_margin{};
-  std::string maintenance_margin{};
-  std::string last_maintenance_margin{};
-  std::string sma{};
+  Decimal equity{};
+  Decimal last_equity{};
+  Decimal long_market_value{};
+  Decimal short_market_value{};
+  Decimal position_market_value{};
+  Decimal initial_margin{};
+  Decimal maintenance_margin{};
+  Decimal last_maintenance_margin{};
+  Decimal sma{};
 
   int daytrade_count{};
   std::string balance_asof;
 
   int crypto_tier{};
-  std::string intraday_adjustments{};
-  std::string pending_reg_taf_fees{};
+  Decimal intraday_adjustments{};
+  Decimal pending_reg_taf_fees{};
 };
 
 }; // namespace alpaca
@@ -1,4 +1,5 @@
 #pragma once
+#include <alpaca/models/common/decimal.hpp>
 #include <glaze/glaze.hpp>
 
 namespace alpaca {
@@ -32,25 +33,25 @@ struct LegsResponse {
 };
 
 using Legs = std::vector<Leg>;
-using LimitPrice = long double;
-using StopPrice = long double;
+using LimitPrice = Decimal;
+using StopPrice = Decimal;
 
 struct Quantity {
-  long double v{};
+  Decimal v{};
   auto operator<=>(const Quantity &) const = default;
 };
 struct Notional {
-  long double v{};
+  Decimal v{};
   auto operator<=>(const Notional &) const = default;
 };
 using ShareAmount = std::variant<Quantity, Notional>;
 
 struct TrailPrice {
-  long double v{};
+  Decimal v{};
   auto operator<=>(const TrailPrice &) const = default;
 };
 struct TrailPercent {
-  long double v{};
+  Decimal v{};
   auto operator<=>(const TrailPercent &) const = default;
 };
 using TrailAmount = std::variant<TrailPrice, TrailPercent>;
@@ -91,8 +92,8 @@ struct OrderRequestParam {
 struct OrderRequestWire {
   std::string symbol{};
 
-  std::optional<long double> qty = std::nullopt;
-  std::optional<long double> notional = std::nullopt;
+  std::optional<Decimal> qty = std::nullopt;
+  std::optional<Decimal> notional = std::nullopt;
 
   OrderSide side{};
   OrderType type{};
@@ -106,8 +107,8 @@ struct OrderRequestWire {
   std::optional<OrderClass> orderClass = std::nullopt;
   std::optional<Legs> legs = std::nullopt;
 
-  std::optional<long double> trailPrice = std::nullopt;
-  std::optional<long double> trailPercent = std::nullopt;
+  std::optional<Decimal> trailPrice = std::nullopt;
+  std::optional<Decimal> trailPercent = std::nullopt;
 
   std::optional<TakeProfit> takeProfit = std::nullopt;
   std::optional<StopLoss> stopLoss = std::nullopt;
@@ -197,19 +198,21 @@ inline std::optional<std::string> fromWire(OrderRequestParam &r,
   return std::nullopt;
 }
 
-struct OrderResponse {
+// `Time` is std::string by default, as for BarT; alpaca::Timestamp decodes
+// the *At fields into nanosecond time points without allocating.
+template <class Time = std::string> struct OrderResponseT {
   std::string id;
   std::string clientOrderID;
 
-  std::string createdAt;
-  std::string updatedAt;
-  std::string submittedAt;
+  Time createdAt{};
+  Time updatedAt{};
+  Time submittedAt{};
 
-  std::optional<std::string> filledAt = std::nullopt;
-  std::optional<std::string> expiredAt = std::nullopt;
-  std::optional<std::string> canceledAt = std::nullopt;
-  std::optional<std::string> failedAt = std::nullopt;
-  std::optional<std::string> replacedAt = std::nullopt;
+  std::optional<Time> filledAt = std::nullopt;
+  std::optional<Time> expiredAt = std::nullopt;
+  std::optional<Time> canceledAt = std::nullopt;
+  std::optional<Time> failedAt = std::nullopt;
+  std::optional<Time> replacedAt = std::nullopt;
 
   std::optional<std::string> replacedBy = std::nullopt;
   std::optional<std::string> replaces = std::nullopt;
@@ -218,11 +221,11 @@ struct OrderResponse {
   std::optional<std::string> symbol = std::nullopt;
   std::optional<std::string> assetClass = std::nullopt;
 
-  std::optional<std::string> notional = std::nullopt;
-  std::optional<std::string> qty = std::nullopt;
+  std::optional<Decimal> notional = std::nullopt;
+  std::optional<Decimal> qty = std::nullopt;
 
-  std::string filledQty;
-  std::optional<std::string> filledAvgPrice = std::nullopt;
+  Decimal filledQty{};
+  std::optional<Decimal> filledAvgPrice = std::nullopt;
 
   std::optional<std::string> orderClass = std::nullopt;
   std::string orderType;
@@ -230,8 +233,8 @@ struct OrderResponse {
   OrderSide side;
 
   OrderTimeInForce timeInForce;
-  std::optional<std::string> limitPrice = std::nullopt;
-  std::optional<std::string> stopPrice = std::nullopt;
+  std::optional<Decimal> limitPrice = std::nullopt;
+  std::optional<Decimal> stopPrice = std::nullopt;
 
   std::string status;
 
@@ -240,14 +243,16 @@ struct OrderResponse {
   bool extendedHours{false};
 
   std::optional<glz::generic> legs = std::nullopt;
-  std::optional<std::string> trailPercent = std::nullopt;
-  std::optional<std::string> trailPrice = std::nullopt;
-  std::optional<std::string> hwm = std::nullopt;
+  std::optional<Decimal> trailPercent = std::nullopt;
+  std::optional<Decimal> trailPrice = std::nullopt;
+  std::optional<Decimal> hwm = std::nullopt;
 
   std::optional<std::string> subtag = std::nullopt;
   std::optional<std::string> source = std::nullopt;
 };
 
+using OrderResponse = OrderResponseT<>;
+
 struct OrderListParam {
   std::optional<OrderStatus> status = std::nullopt;
   std::optional<uint32_t> limit = std::nullopt;
@@ -268,11 +273,11 @@ struct OrderID {
 };
 
 struct ReplaceOrderParam {
-  std::optional<long double> qty = std::nullopt;
+  std::optional<Decimal> qty = std::nullopt;
   std::optional<OrderTimeInForce> timeInForce = std::nullopt;
-  std::optional<long double> limitPrice = std::nullopt;
-  std::optional<long double> stopPrice = std::nullopt;
-  std::optional<long double> trail = std::nullopt;
+  std::optional<Decimal> limitPrice = std::nullopt;
+  std::optional<Decimal> stopPrice = std::nullopt;
+  std::optional<Decimal> trail = std::nullopt;
   std::optional<std::string> clientOrderID = std::nullopt;
 };
 
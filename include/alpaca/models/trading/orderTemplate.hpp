@@ -0,0 +1,120 @@
+#pragma once
+#include <alpaca/client/httpClient.hpp>
+#include <alpaca/models/common/decimal.hpp>
+#include <alpaca/models/trading/order.hpp>
+#include <alpaca/models/trading/serialize.hpp>
+#include <expected>
+#include <glaze/glaze.hpp>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace alpaca {
+
+// The per-order part of a templated order.
+struct OrderPatch {
+  Decimal qty{};
+  std::optional<Decimal> limitPrice = std::nullopt;
+  std::optional<Decimal> stopPrice = std::nullopt;
+  // Left out of the body when empty; the server then assigns one.
+  std::string_view clientOrderID{};
+};
+
+// Request body for an order sent over and over with only the size, prices
+// and client order id changing, e.g. a market maker's quotes. Symbol, side,
+// type, time in force, class and the other fixed fields are serialized once
+// by Make(); Render() appends the patch to a copy of that prefix in a buffer
+// the template keeps, so a warm template neither allocates nor runs glaze.
+//
+// Not thread safe: use one template per sending thread.
+class OrderTemplate {
+public:
+  // `base` supplies every field except amt, limitPrice, stopPrice and
+  // clientOrderID, which are ignored; Render() sends qty, never notional.
+  static std::expected<OrderTemplate, APIError>
+  Make(const OrderRequestParam &base) {
+    auto wire = toWire(base);
+    wire.qty.reset();
+    wire.notional.reset();
+    wire.limitPrice.reset();
+    wire.stopPrice.reset();
+    wire.clientOrderID.reset();
+
+    OrderTemplate t;
+    if (auto ec = glz::write_json(wire, t.prefix_)) {
+      return std::unexpected(
+          APIError{ErrorCode::JSONParsing, glz::format_error(ec)});
+    }
+    // Drop the closing brace; Render() appends fields, then closes it.
+    t.prefix_.pop_back();
+    t.body_.reserve(t.prefix_.size() + kPatchReserve);
+    return t;
+  }
+
+  // The full JSON body for `patch`. Valid until the next Render().
+  const std::string &Render(const OrderPatch &patch) {
+    body_.assign(prefix_);
+    AppendDecimal("qty", patch.qty);
+    if (patch.limitPrice) {
+      AppendDecimal("limit_price", *patch.limitPrice);
+    }
+    if (patch.stopPrice) {
+      AppendDecimal("stop_price", *patch.stopPrice);
+    }
+    if (!patch.clientOrderID.empty()) {
+      AppendKey("client_order_id");
+      AppendEscaped(patch.clientOrderID);
+    }
+    body_.push_back('}');
+    return body_;
+  }
+
+  // The serialized fixed fields, without the closing brace.
+  std::string_view Prefix() const noexcept { return prefix_; }
+
+private:
+  // Room for the patched fields: three decimals plus a client order id of
+  // up to 128 characters.
+  static constexpr std::size_t kPatchReserve = 256;
+
+  OrderTemplate() = default;
+
+  void AppendKey(std::string_view key) {
+    body_.append(",\"");
+    body_.append(key);
+    body_.append("\":");
+  }
+
+  // Decimals go out as JSON strings, the same as glaze writes them.
+  void AppendDecimal(std::string_view key, Decimal d) {
+    char buf[Decimal::kMaxChars];
+    AppendKey(key);
+    body_.push_back('"');
+    body_.append(buf, d.ToChars(buf));
+    body_.push_back('"');
+  }
+
+  void AppendEscaped(std::string_view s) {
+    static constexpr char kHex[] = "0123456789abcdef";
+    body_.push_back('"');
+    for (const char c : s) {
+      const auto u = static_cast<unsigned char>(c);
+      if (c == '"' || c == '\\') {
+        body_.push_back('\\');
+        body_.push_back(c);
+      } else if (u < 0x20) {
+        body_.append("\\u00");
+        body_.push_back(kHex[u >> 4]);
+        body_.push_back(kHex[u & 0xf]);
+      } else {
+        body_.push_back(c);
+      }
+    }
+    body_.push_back('"');
+  }
+
+  std::string prefix_;
+  std::string body_;
+};
+
+} // namespace alpaca
@@ -1,4 +1,5 @@
 #pragma once
+#include <alpaca/models/common/decimal.hpp>
 #include <glaze/glaze.hpp>
 
 namespace alpaca {
@@ -12,22 +13,22 @@ struct Position {
   std::string assetClass{};
   bool assetMarginable{};
 
-  std::string qty{};
-  std::string avgEntryPrice{};
+  Decimal qty{};
+  Decimal avgEntryPrice{};
   std::string side{};
-  std::string marketValue{};
-  std::string costBasis{};
+  Decimal marketValue{};
+  Decimal costBasis{};
 
-  std::string unrealizedPL{};
-  std::string unrealizedPLPC{};
-  std::string unrealizedIntradayPL{};
-  std::string unrealizedIntradayPLPC{};
+  Decimal unrealizedPL{};
+  Decimal unrealizedPLPC{};
+  Decimal unrealizedIntradayPL{};
+  Decimal unrealizedIntradayPLPC{};
 
-  std::string currentPrice{};
-  std::string lastDayPrice{};
-  std::string changeToday{};
+  Decimal currentPrice{};
+  Decimal lastDayPrice{};
+  Decimal changeToday{};
 
-  std::string qtyAvailable{};
+  Decimal qtyAvailable{};
 };
 
 using Positions = std::vector<Position>;
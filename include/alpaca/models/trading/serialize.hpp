@@ -1,4 +1,5 @@
 #pragma once
+#include <alpaca/models/common/timestamp.hpp>
 #include <alpaca/models/trading/account.hpp>
 #include <alpaca/models/trading/calendar.hpp>
 #include <alpaca/models/trading/clock.hpp>
@@ -104,8 +105,8 @@ template <> struct from<JSON, alpaca::OrderRequestParam> {
   }
 };
 
-template <> struct meta<alpaca::OrderResponse> {
-  using T = alpaca::OrderResponse;
+template <class Time> struct meta<alpaca::OrderResponseT<Time>> {
+  using T = alpaca::OrderResponseT<Time>;
   static constexpr auto value = object(
       "id", &T::id, "client_order_id", &T::clientOrderID, "created_at",
       &T::createdAt, "updated_at", &T::updatedAt, "submitted_at",
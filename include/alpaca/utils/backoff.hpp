@@ -0,0 +1,21 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+namespace alpaca::detail {
+
+// Exponential backoff with "equal jitter": half fixed, half random. The
+// delay doubles from `base` with each attempt, up to `max`.
+inline std::chrono::milliseconds BackoffDelay(int attempt,
+                                              std::chrono::milliseconds base,
+                                              std::chrono::milliseconds max) {
+  thread_local std::mt19937 rng{std::random_device{}()};
+  const auto shift = std::min(attempt, 20);
+  const auto delay =
+      std::min<long long>(max.count(), base.count() << shift);
+  std::uniform_int_distribution<long long> jitter(0, delay / 2);
+  return std::chrono::milliseconds{delay - delay / 2 + jitter(rng)};
+}
+
+} // namespace alpaca::detail
@@ -0,0 +1,104 @@
+#pragma once
+#include <alpaca/utils/ringBuffer.hpp>
+#include <alpaca/utils/symbolTable.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace alpaca {
+
+// Latest value per symbol, for a consumer that only cares about the current
+// state rather than every update. One slot per symbol id in [0, capacity);
+// a write overwrites whatever the consumer has not taken yet, and ids whose
+// slot holds a fresh value wait in a dirty list, each at most once. One
+// producer and one consumer; a slot is locked only for the copy in or out.
+template <class T> class ConflationTable {
+  struct Slot {
+    std::atomic_flag busy;
+    bool dirty{false};
+    uint32_t coalesced{0};
+    T value{};
+  };
+
+  class SlotLock {
+  public:
+    explicit SlotLock(Slot &s) noexcept : s_(s) {
+      while (s_.busy.test_and_set(std::memory_order_acquire)) {
+      }
+    }
+    ~SlotLock() { s_.busy.clear(std::memory_order_release); }
+
+  private:
+    Slot &s_;
+  };
+
+public:
+  explicit ConflationTable(std::size_t capacity)
+      : capacity_(capacity), slots_(std::make_unique<Slot[]>(capacity)),
+        dirty_(capacity) {}
+
+  ConflationTable(const ConflationTable &) = delete;
+  ConflationTable &operator=(const ConflationTable &) = delete;
+
+  // Stores `v` as the latest value for `id`. Returns false when `id` has no
+  // slot. Producer only.
+  bool Put(SymbolId id, const T &v) noexcept {
+    if (id >= capacity_) {
+      return false;
+    }
+    auto &s = slots_[id];
+    bool wasDirty;
+    {
+      SlotLock lock(s);
+      s.value = v;
+      wasDirty = s.dirty;
+      if (wasDirty) {
+        ++s.coalesced;
+      } else {
+        s.dirty = true;
+        s.coalesced = 0;
+      }
+    }
+    if (wasDirty) {
+      coalesced_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      // Cannot fail: the list has room for every id and holds each at most
+      // once.
+      dirty_.TryPush(id);
+    }
+    return true;
+  }
+
+  // Takes the value of the next dirty symbol. `coalesced` is how many
+  // earlier updates it replaced since the last take. Consumer only.
+  bool TryTake(SymbolId &id, T &out, uint32_t &coalesced) noexcept {
+    if (!dirty_.TryPop(id)) {
+      return false;
+    }
+    auto &s = slots_[id];
+    SlotLock lock(s);
+    out = s.value;
+    coalesced = s.coalesced;
+    s.dirty = false;
+    return true;
+  }
+
+  std::size_t Capacity() const noexcept { return capacity_; }
+
+  // Symbols with a value waiting; approximate while the producer runs.
+  std::size_t Dirty() const noexcept { return dirty_.Size(); }
+
+  // Updates overwritten before the consumer took them.
+  uint64_t Coalesced() const noexcept {
+    return coalesced_.load(std::memory_order_relaxed);
+  }
+
+private:
+  const std::size_t capacity_;
+  std::unique_ptr<Slot[]> slots_;
+  RingBuffer<SymbolId> dirty_;
+  std::atomic<uint64_t> coalesced_{0};
+};
+
+} // namespace alpaca
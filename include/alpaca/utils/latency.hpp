@@ -0,0 +1,214 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace alpaca {
+
+// When a frame came off the socket, on both clocks: `mono` for intervals
+// inside the process (e.g. receive to callback), `wall` for comparing with
+// the exchange timestamps a message carries.
+struct ReceiveTime {
+  std::chrono::steady_clock::time_point mono{};
+  std::chrono::system_clock::time_point wall{};
+
+  static ReceiveTime Now() noexcept {
+    return {std::chrono::steady_clock::now(),
+            std::chrono::system_clock::now()};
+  }
+};
+
+// Copy of an HdrHistogram at one point in time.
+struct HistogramSnapshot {
+  uint64_t count{};
+  uint64_t min{};
+  uint64_t max{};
+  double mean{};
+  // Non-empty buckets in increasing order: {largest value in the bucket,
+  // number of values recorded in it}.
+  std::vector<std::pair<uint64_t, uint64_t>> buckets;
+
+  // The value at or below which the fraction `q` (0 to 1) of recorded values
+  // fall, to within the histogram's precision. Zero when empty.
+  uint64_t Percentile(double q) const noexcept {
+    if (count == 0) {
+      return 0;
+    }
+    const auto rank = std::max<uint64_t>(
+        1, static_cast<uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * count)));
+    uint64_t seen = 0;
+    for (const auto &[upper, n] : buckets) {
+      seen += n;
+      if (seen >= rank) {
+        return std::clamp(upper, min, max);
+      }
+    }
+    return max;
+  }
+};
+
+// Fixed-size log-linear histogram in the style of HdrHistogram: every power
+// of two is split into 32 linear buckets, so a recorded value is known to
+// within 1/32 (about 3%) of itself. Values are non-negative integers,
+// usually nanoseconds; those above 2^40 (about 18 minutes in ns) land in the
+// last bucket.
+//
+// Record() is lock-free (relaxed atomics only) and safe from any number of
+// threads; Snapshot() may run alongside it and sees each counter at some
+// recent value.
+class HdrHistogram {
+public:
+  static constexpr unsigned kSubBits = 5;
+  static constexpr uint64_t kSub = uint64_t{1} << kSubBits;
+  static constexpr unsigned kMaxBits = 40;
+  static constexpr uint64_t kMaxValue = (uint64_t{1} << kMaxBits) - 1;
+  static constexpr std::size_t kBuckets = (kMaxBits - kSubBits + 1) * kSub;
+
+  HdrHistogram() = default;
+  HdrHistogram(const HdrHistogram &) = delete;
+  HdrHistogram &operator=(const HdrHistogram &) = delete;
+
+  void Record(uint64_t v) noexcept {
+    v = std::min(v, kMaxValue);
+    counts_[Index(v)].fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(v, std::memory_order_relaxed);
+    auto lo = min_.load(std::memory_order_relaxed);
+    while (v < lo &&
+           !min_.compare_exchange_weak(lo, v, std::memory_order_relaxed)) {
+    }
+    auto hi = max_.load(std::memory_order_relaxed);
+    while (v > hi &&
+           !max_.compare_exchange_weak(hi, v, std::memory_order_relaxed)) {
+    }
+  }
+
+  // Negative durations, which a clock step can produce, count as zero.
+  template <class Rep, class Period>
+  void Record(std::chrono::duration<Rep, Period> d) noexcept {
+    const auto ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+    Record(static_cast<uint64_t>(std::max<decltype(ns)>(ns, 0)));
+  }
+
+  HistogramSnapshot Snapshot() const {
+    HistogramSnapshot s;
+    for (std::size_t i = 0; i < kBuckets; ++i) {
+      if (const auto n = counts_[i].load(std::memory_order_relaxed)) {
+        s.buckets.emplace_back(UpperBound(i), n);
+        s.count += n;
+      }
+    }
+    if (s.count != 0) {
+      s.min = min_.load(std::memory_order_relaxed);
+      s.max = max_.load(std::memory_order_relaxed);
+      s.mean = static_cast<double>(sum_.load(std::memory_order_relaxed)) /
+               static_cast<double>(s.count);
+    }
+    return s;
+  }
+
+  // Not atomic with respect to concurrent Record() calls; values recorded
+  // meanwhile may be partly kept.
+  void Reset() noexcept {
+    for (auto &c : counts_) {
+      c.store(0, std::memory_order_relaxed);
+    }
+    sum_.store(0, std::memory_order_relaxed);
+    min_.store(kMaxValue, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+  }
+
+  static constexpr std::size_t Index(uint64_t v) noexcept {
+    if (v < kSub) {
+      return static_cast<std::size_t>(v);
+    }
+    const auto shift = std::bit_width(v) - 1 - kSubBits;
+    return static_cast<std::size_t>(shift * kSub + (v >> shift));
+  }
+
+  // Largest value that maps to bucket `i`.
+  static constexpr uint64_t UpperBound(std::size_t i) noexcept {
+    if (i < kSub) {
+      return i;
+    }
+    const auto shift = i / kSub - 1;
+    const auto sub = i - shift * kSub;
+    return ((static_cast<uint64_t>(sub) + 1) << shift) - 1;
+  }
+
+private:
+  std::array<std::atomic<uint64_t>, kBuckets> counts_{};
+  std::atomic<uint64_t> sum_{0};
+  std::atomic<uint64_t> min_{kMaxValue};
+  std::atomic<uint64_t> max_{0};
+};
+
+// Named histograms that clients record into once given a pointer through
+// their SetInstrumentation(); a client without one records nothing and
+// reads no clock. One registry may be shared by several clients.
+//
+// Names are "<metric> <label>", e.g. "http.request GET /v2/orders" or
+// "md.decode trade"; see the SetInstrumentation() of each client for what
+// it records. Values are nanoseconds except for depths, which are counts.
+class Instrumentation {
+public:
+  Instrumentation() = default;
+  Instrumentation(const Instrumentation &) = delete;
+  Instrumentation &operator=(const Instrumentation &) = delete;
+
+  // The histogram called `name`, created on first use. The reference stays
+  // valid as long as the registry, so hot paths look it up once.
+  HdrHistogram &Histogram(std::string_view name) {
+    {
+      std::shared_lock lock(mtx_);
+      if (auto it = hists_.find(name); it != hists_.end()) {
+        return *it->second;
+      }
+    }
+    std::unique_lock lock(mtx_);
+    auto &h = hists_[std::string(name)];
+    if (!h) {
+      h = std::make_unique<HdrHistogram>();
+    }
+    return *h;
+  }
+
+  // Every histogram with at least one value, by name.
+  std::map<std::string, HistogramSnapshot> Snapshot() const {
+    std::shared_lock lock(mtx_);
+    std::map<std::string, HistogramSnapshot> out;
+    for (const auto &[name, h] : hists_) {
+      if (auto s = h->Snapshot(); s.count != 0) {
+        out.emplace(name, std::move(s));
+      }
+    }
+    return out;
+  }
+
+  void Reset() {
+    std::shared_lock lock(mtx_);
+    for (auto &[name, h] : hists_) {
+      h->Reset();
+    }
+  }
+
+private:
+  mutable std::shared_mutex mtx_;
+  std::map<std::string, std::unique_ptr<HdrHistogram>, std::less<>> hists_;
+};
+
+} // namespace alpaca
@@ -0,0 +1,89 @@
+#pragma once
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace alpaca {
+
+// Bounded lock-free queue for handing events from one producer thread to a
+// consumer thread. Each cell carries a sequence number (Vyukov's bounded
+// queue), so besides the consumer the producer may also pop, which is how
+// a full ring evicts its oldest entry. Capacity is rounded up to a power of
+// two. Neither side ever blocks or allocates after construction; elements
+// are copied in and out of preallocated cells.
+template <class T> class RingBuffer {
+  struct Cell {
+    std::atomic<std::size_t> seq;
+    T value;
+  };
+
+  // Keeps the producer and consumer counters on separate cache lines.
+  static constexpr std::size_t kLine = 64;
+
+public:
+  explicit RingBuffer(std::size_t capacity)
+      : mask_(std::bit_ceil(capacity < 2 ? std::size_t{2} : capacity) - 1),
+        cells_(std::make_unique<Cell[]>(mask_ + 1)) {
+    for (std::size_t i = 0; i <= mask_; ++i) {
+      cells_[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  RingBuffer(const RingBuffer &) = delete;
+  RingBuffer &operator=(const RingBuffer &) = delete;
+
+  // False when full. Single producer only.
+  bool TryPush(const T &v) noexcept {
+    const auto pos = tail_.load(std::memory_order_relaxed);
+    auto &cell = cells_[pos & mask_];
+    if (cell.seq.load(std::memory_order_acquire) != pos) {
+      return false;
+    }
+    cell.value = v;
+    cell.seq.store(pos + 1, std::memory_order_release);
+    tail_.store(pos + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+  // False when empty. Safe from the consumer and the producer at once.
+  bool TryPop(T &out) noexcept {
+    auto pos = head_.load(std::memory_order_relaxed);
+    for (;;) {
+      auto &cell = cells_[pos & mask_];
+      const auto seq = cell.seq.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::intptr_t>(seq) -
+                        static_cast<std::intptr_t>(pos + 1);
+      if (diff == 0) {
+        if (head_.compare_exchange_weak(pos, pos + 1,
+                                        std::memory_order_relaxed)) {
+          out = cell.value;
+          cell.seq.store(pos + mask_ + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = head_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  std::size_t Capacity() const noexcept { return mask_ + 1; }
+
+  // Approximate while either side is running.
+  std::size_t Size() const noexcept {
+    const auto head = head_.load(std::memory_order_relaxed);
+    const auto tail = tail_.load(std::memory_order_relaxed);
+    return tail > head ? tail - head : 0;
+  }
+
+private:
+  const std::size_t mask_;
+  std::unique_ptr<Cell[]> cells_;
+  alignas(kLine) std::atomic<std::size_t> tail_{0};
+  alignas(kLine) std::atomic<std::size_t> head_{0};
+};
+
+} // namespace alpaca
@@ -0,0 +1,66 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace alpaca {
+
+// A small trivially copyable value that one writer at a time replaces and
+// any number of readers copy without taking a lock: a read that overlaps a
+// write sees the sequence number move and retries, and the writer never
+// waits for readers. Callers serialize Store() themselves.
+template <class T> class SeqLock {
+  static_assert(std::is_trivially_copyable_v<T>);
+  static_assert(std::is_default_constructible_v<T>);
+
+  static constexpr std::size_t kWords =
+      (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+  using Words = std::array<std::uint64_t, kWords>;
+
+public:
+  SeqLock() noexcept { Store(T{}); }
+
+  SeqLock(const SeqLock &) = delete;
+  SeqLock &operator=(const SeqLock &) = delete;
+
+  T Load() const noexcept {
+    Words buf;
+    for (;;) {
+      const auto before = seq_.load(std::memory_order_acquire);
+      if (before & 1) {
+        continue;
+      }
+      for (std::size_t i = 0; i < kWords; ++i) {
+        buf[i] = words_[i].load(std::memory_order_relaxed);
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (seq_.load(std::memory_order_relaxed) == before) {
+        break;
+      }
+    }
+    T out;
+    std::memcpy(&out, buf.data(), sizeof(T));
+    return out;
+  }
+
+  void Store(const T &v) noexcept {
+    Words buf{};
+    std::memcpy(buf.data(), &v, sizeof(T));
+    const auto seq = seq_.load(std::memory_order_relaxed);
+    seq_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (std::size_t i = 0; i < kWords; ++i) {
+      words_[i].store(buf[i], std::memory_order_relaxed);
+    }
+    seq_.store(seq + 2, std::memory_order_release);
+  }
+
+private:
+  std::atomic<std::uint64_t> seq_{0};
+  std::array<std::atomic<std::uint64_t>, kWords> words_{};
+};
+
+} // namespace alpaca
@@ -0,0 +1,136 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace alpaca {
+
+using SymbolId = std::uint32_t;
+inline constexpr SymbolId kNoSymbol = std::numeric_limits<SymbolId>::max();
+
+struct SymbolHash {
+  using is_transparent = void;
+  std::size_t operator()(std::string_view s) const noexcept {
+    return std::hash<std::string_view>{}(s);
+  }
+};
+
+// Maps tickers to dense ids (0, 1, 2, ... in first-seen order), so
+// per-symbol state can live in a flat array indexed by id instead of a hash
+// map keyed by string. Ids are never reused or removed. Interning takes a
+// shared lock on hits and an exclusive one only for new symbols; Name() is
+// lock-free.
+class SymbolTable {
+private:
+  static constexpr std::size_t kChunkBits = 10;
+  static constexpr std::size_t kChunkSize = std::size_t{1} << kChunkBits;
+  static constexpr std::size_t kMaxChunks = 4096;
+  using Chunk = std::array<std::string, kChunkSize>;
+
+public:
+  static constexpr std::size_t kCapacity = kChunkSize * kMaxChunks;
+
+  SymbolTable() = default;
+  SymbolTable(const SymbolTable &) = delete;
+  SymbolTable &operator=(const SymbolTable &) = delete;
+
+  // Process-wide table used by streams unless they are given another one.
+  static SymbolTable &Global() {
+    static SymbolTable table;
+    return table;
+  }
+
+  // Returns the id of `symbol`, assigning the next one on first sight.
+  // kNoSymbol once kCapacity symbols have been interned.
+  SymbolId Intern(std::string_view symbol) {
+    if (auto id = Find(symbol)) {
+      return *id;
+    }
+
+    std::unique_lock lock(mtx_);
+    if (auto it = ids_.find(symbol); it != ids_.end()) {
+      return it->second;
+    }
+    const auto id = size_.load(std::memory_order_relaxed);
+    if (id >= kCapacity) {
+      return kNoSymbol;
+    }
+    auto &chunk = chunks_[id >> kChunkBits];
+    if (!chunk) {
+      chunk = std::make_unique<Chunk>();
+    }
+    auto &slot = (*chunk)[id & (kChunkSize - 1)];
+    slot = symbol;
+    // Keys view the slot, which never moves.
+    ids_.emplace(std::string_view(slot), static_cast<SymbolId>(id));
+    size_.store(id + 1, std::memory_order_release);
+    return static_cast<SymbolId>(id);
+  }
+
+  std::optional<SymbolId> Find(std::string_view symbol) const {
+    std::shared_lock lock(mtx_);
+    if (auto it = ids_.find(symbol); it != ids_.end()) {
+      return it->second;
+    }
+    return std::nullopt;
+  }
+
+  // Empty for ids that were never handed out.
+  std::string_view Name(SymbolId id) const noexcept {
+    if (id >= size_.load(std::memory_order_acquire)) {
+      return {};
+    }
+    return (*chunks_[id >> kChunkBits])[id & (kChunkSize - 1)];
+  }
+
+  // Number of ids handed out; every id is below it.
+  std::size_t Size() const noexcept {
+    return size_.load(std::memory_order_acquire);
+  }
+
+private:
+  mutable std::shared_mutex mtx_;
+  std::unordered_map<std::string_view, SymbolId, SymbolHash, std::equal_to<>>
+      ids_;
+  std::array<std::unique_ptr<Chunk>, kMaxChunks> chunks_{};
+  std::atomic<std::size_t> size_{0};
+};
+
+// Single-threaded front for a shared SymbolTable, e.g. one per stream
+// connection: repeat lookups touch no lock and allocate nothing.
+class SymbolCache {
+public:
+  explicit SymbolCache(SymbolTable &table = SymbolTable::Global()) noexcept
+      : table_(&table) {}
+
+  SymbolId Intern(std::string_view symbol) {
+    if (auto it = local_.find(symbol); it != local_.end()) {
+      return it->second;
+    }
+    const auto id = table_->Intern(symbol);
+    if (id != kNoSymbol) {
+      local_.emplace(table_->Name(id), id);
+    }
+    return id;
+  }
+
+  SymbolTable &Table() const noexcept { return *table_; }
+
+private:
+  SymbolTable *table_;
+  // Keys view the table's storage.
+  std::unordered_map<std::string_view, SymbolId, SymbolHash, std::equal_to<>>
+      local_;
+};
+
+} // namespace alpaca
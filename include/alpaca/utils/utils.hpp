@@ -1,5 +1,8 @@
 #pragma once
 #include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string_view>
 #include <thread>
 
 #define ENABLE_LOGGING
@@ -33,6 +36,105 @@ inline auto ToIsoz(std::chrono::sys_time<std::chrono::seconds> t) noexcept {
   return std::format("{:%FT%T}Z", t);
 };
 
+// Fixed-format RFC 3339 parser for wire timestamps such as
+// "2024-01-02T10:00:00Z", "2024-01-02T10:00:00.123456789Z" or
+// "2024-01-02T05:00:00-05:00". Returns nanoseconds since the Unix epoch.
+// No locale, no allocation, no std::chrono::parse.
+constexpr std::optional<std::int64_t>
+ParseRfc3339Nanos(std::string_view s) noexcept {
+  auto digit = [&](std::size_t i) -> int {
+    const auto c = static_cast<unsigned>(s[i]) - '0';
+    return c < 10 ? static_cast<int>(c) : -1;
+  };
+  auto two = [&](std::size_t i) -> int {
+    const int a = digit(i), b = digit(i + 1);
+    return (a | b) < 0 ? -1 : a * 10 + b;
+  };
+
+  if (s.size() < 20 || s[4] != '-' || s[7] != '-' ||
+      (s[10] != 'T' && s[10] != 't' && s[10] != ' ') || s[13] != ':' ||
+      s[16] != ':') {
+    return std::nullopt;
+  }
+  const int y1 = two(0), y2 = two(2), mo = two(5), d = two(8), hh = two(11),
+            mi = two(14), ss = two(17);
+  if ((y1 | y2 | mo | d | hh | mi | ss) < 0 || mo < 1 || mo > 12 || d < 1 ||
+      hh > 23 || mi > 59 || ss > 60) {
+    return std::nullopt;
+  }
+  constexpr int kDays[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+  const int year = y1 * 100 + y2;
+  const bool leap = year % 4 == 0 && (year % 100 != 0 || year % 400 == 0);
+  if (d > kDays[mo - 1] + (mo == 2 && leap)) {
+    return std::nullopt;
+  }
+
+  std::size_t i = 19;
+  std::int64_t frac = 0;
+  if (s[i] == '.') {
+    ++i;
+    int n = 0;
+    for (; i < s.size() && digit(i) >= 0; ++i, ++n) {
+      if (n < 9) {
+        frac = frac * 10 + digit(i);
+      }
+    }
+    if (n == 0) {
+      return std::nullopt;
+    }
+    for (; n < 9; ++n) {
+      frac *= 10;
+    }
+  }
+
+  std::int64_t offset = 0;
+  if (i < s.size() && (s[i] == 'Z' || s[i] == 'z')) {
+    ++i;
+  } else if (i + 6 == s.size() && (s[i] == '+' || s[i] == '-') &&
+             s[i + 3] == ':') {
+    const int oh = two(i + 1), om = two(i + 4);
+    if ((oh | om) < 0) {
+      return std::nullopt;
+    }
+    offset = (s[i] == '+' ? 1 : -1) * (oh * 3600 + om * 60);
+    i += 6;
+  } else {
+    return std::nullopt;
+  }
+  if (i != s.size()) {
+    return std::nullopt;
+  }
+
+  // days_from_civil (H. Hinnant), valid for the proleptic Gregorian calendar.
+  const std::int64_t y = y1 * 100 + y2 - (mo <= 2);
+  const std::int64_t era = (y >= 0 ? y : y - 399) / 400;
+  const std::int64_t yoe = y - era * 400;
+  const std::int64_t doy = (153 * (mo + (mo > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+  const std::int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  const std::int64_t days = era * 146097 + doe - 719468;
+
+  const std::int64_t secs = days * 86400 + hh * 3600 + mi * 60 + ss - offset;
+  return secs * 1'000'000'000 + frac;
+}
+
+// Inverse of ToIsoz. Accepts "YYYY-MM-DD" and "YYYY-MM-DDTHH:MM:SSZ".
+inline std::optional<std::chrono::sys_seconds>
+FromIsoz(std::string_view s) noexcept {
+  std::optional<std::int64_t> ns;
+  if (s.size() == 10) {
+    char buf[20];
+    s.copy(buf, 10);
+    std::string_view("T00:00:00Z").copy(buf + 10, 10);
+    ns = ParseRfc3339Nanos(std::string_view(buf, sizeof buf));
+  } else if (s.size() == 20 && s[10] == 'T' && s[19] == 'Z') {
+    ns = ParseRfc3339Nanos(s);
+  }
+  if (!ns) {
+    return std::nullopt;
+  }
+  return std::chrono::sys_seconds{std::chrono::seconds{*ns / 1'000'000'000}};
+}
+
 inline auto SleepToNextBoundary(int minutes) noexcept {
   using namespace std::chrono;
   auto now = system_clock::now();
@@ -5,9 +5,16 @@
 #include <glaze/glaze.hpp>
 
 #include <string>
+#include <string_view>
 
 namespace {
 
+alpaca::Decimal dec(std::string_view s) {
+  auto d = alpaca::Decimal::Parse(s);
+  REQUIRE(d.has_value());
+  return *d;
+}
+
 glz::generic generic_from_json(const std::string &json) {
   glz::generic g{};
   auto ec = glz::read_json(g, json);
@@ -31,16 +38,16 @@ alpaca::Account make_account_full() {
 
   a.currency = "USD";
 
-  a.buying_power = "10000";
-  a.regt_buying_power = "9000";
-  a.daytrading_buying_power = "8000";
-  a.effective_buying_power = "7000";
-  a.non_marginable_buying_power = "6000";
-  a.options_buying_power = "5000";
-  a.bod_dtbp = "4000";
-  a.cash = "3000";
-  a.accrued_fees = "0";
-  a.portfolio_value = "12345.67";
+  a.buying_power = dec("10000");
+  a.regt_buying_power = dec("9000");
+  a.daytrading_buying_power = dec("8000");
+  a.effective_buying_power = dec("7000");
+  a.non_marginable_buying_power = dec("6000");
+  a.options_buying_power = dec("5000");
+  a.bod_dtbp = dec("4000");
+  a.cash = dec("3000");
+  a.accrued_fees = dec("0");
+  a.portfolio_value = dec("12345.67");
 
   a.pattern_day_trader = false;
   a.trading_blocked = false;
@@ -50,25 +57,25 @@ alpaca::Account make_account_full() {
   a.created_at = "2026-01-07T10:00:00Z";
   a.trade_suspended_by_user = false;
 
-  a.multiplier = "2";
+  a.multiplier = dec("2");
   a.shorting_enabled = true;
 
-  a.equity = "12345.67";
-  a.last_equity = "12000.00";
-  a.long_market_value = "10000.00";
-  a.short_market_value = "0.00";
-  a.position_market_value = "10000.00";
-  a.initial_margin = "0.00";
-  a.maintenance_margin = "0.00";
-  a.last_maintenance_margin = "0.00";
-  a.sma = "0.00";
+  a.equity = dec("12345.67");
+  a.last_equity = dec("12000.00");
+  a.long_market_value = dec("10000.00");
+  a.short_market_value = dec("0.00");
+  a.position_market_value = dec("10000.00");
+  a.initial_margin = dec("0.00");
+  a.maintenance_margin = dec("0.00");
+  a.last_maintenance_margin = dec("0.00");
+  a.sma = dec("0.00");
 
   a.daytrade_count = 0;
   a.balance_asof = "2026-01-07";
 
   a.crypto_tier = 1;
-  a.intraday_adjustments = "0";
-  a.pending_reg_taf_fees = "0";
+  a.intraday_adjustments = dec("0");
+  a.pending_reg_taf_fees = dec("0");
 
   return a;
 }
@@ -0,0 +1,280 @@
+#include <alpaca/client/accountStateCache.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <expected>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+alpaca::Decimal D(std::string_view s) { return *alpaca::Decimal::Parse(s); }
+
+alpaca::Position MakePosition(std::string symbol, std::string_view qty,
+                              std::string_view avg) {
+  alpaca::Position p;
+  p.symbol = std::move(symbol);
+  p.qty = D(qty);
+  p.avgEntryPrice = D(avg);
+  return p;
+}
+
+alpaca::TradeUpdate MakeFill(std::string symbol, alpaca::OrderSide side,
+                             std::string_view qty, std::string_view price,
+                             std::optional<std::string_view> positionQty = {}) {
+  alpaca::TradeUpdate u;
+  u.event = alpaca::TradeUpdateEvent::fill;
+  u.order.symbol = std::move(symbol);
+  u.order.side = side;
+  u.qty = D(qty);
+  u.price = D(price);
+  if (positionQty) {
+    u.positionQty = D(*positionQty);
+  }
+  return u;
+}
+
+// Stands in for TradingClientT. `during` runs inside GetAllOpenPositions,
+// i.e. while a reconcile is in flight.
+struct FakeTradingClient {
+  alpaca::Account account;
+  alpaca::Positions positions;
+  std::function<void()> during;
+  std::atomic<int> calls{0};
+  bool fail = false;
+
+  std::expected<alpaca::Account, alpaca::APIError> GetAccount() {
+    ++calls;
+    if (fail) {
+      return std::unexpected(
+          alpaca::APIError{alpaca::ErrorCode::Connection, "down"});
+    }
+    return account;
+  }
+
+  std::expected<alpaca::Positions, alpaca::APIError> GetAllOpenPositions() {
+    if (during) {
+      during();
+    }
+    return positions;
+  }
+};
+
+} // namespace
+
+TEST_CASE("AccountStateCache: reconcile loads account and positions") {
+  FakeTradingClient cli;
+  cli.account.cash = D("10000");
+  cli.account.buying_power = D("40000");
+  cli.positions = {MakePosition("AAPL", "10", "150")};
+  alpaca::AccountStateCache cache;
+
+  REQUIRE(cache.Snapshot()->positions.empty());
+  REQUIRE(cache.Reconcile(cli).has_value());
+
+  auto s = cache.Snapshot();
+  REQUIRE(s->cash == D("10000"));
+  REQUIRE(s->buyingPower == D("40000"));
+  REQUIRE(s->account->cash == D("10000"));
+  REQUIRE(s->Qty("AAPL") == D("10"));
+  REQUIRE(s->Qty("MSFT") == alpaca::Decimal{});
+  REQUIRE(s->Find("MSFT") == nullptr);
+}
+
+TEST_CASE("AccountStateCache: fills move positions, cash and buying power") {
+  FakeTradingClient cli;
+  cli.account.cash = D("10000");
+  cli.account.buying_power = D("10000");
+  cli.positions = {MakePosition("AAPL", "10", "100")};
+  alpaca::AccountStateCache cache;
+  REQUIRE(cache.Reconcile(cli).has_value());
+  const auto before = cache.Snapshot();
+
+  REQUIRE(cache.Apply(MakeFill("AAPL", alpaca::OrderSide::buy, "10", "110")));
+  auto s = cache.Snapshot();
+  REQUIRE(s->Qty("AAPL") == D("20"));
+  REQUIRE(s->Find("AAPL")->avgEntryPrice == D("105"));
+  REQUIRE(s->Find("AAPL")->costBasis == D("2100"));
+  REQUIRE(s->cash == D("8900"));
+  REQUIRE(s->buyingPower == D("8900"));
+  REQUIRE(s->fillsSinceReconcile == 1);
+  // Earlier snapshots do not change.
+  REQUIRE(before->Qty("AAPL") == D("10"));
+
+  REQUIRE(cache.Apply(MakeFill("AAPL", alpaca::OrderSide::sell, "5", "120")));
+  s = cache.Snapshot();
+  REQUIRE(s->Qty("AAPL") == D("15"));
+  REQUIRE(s->Find("AAPL")->avgEntryPrice == D("105"));
+  REQUIRE(s->cash == D("9500"));
+  REQUIRE(s->buyingPower == D("9500"));
+
+  REQUIRE(cache.Apply(MakeFill("AAPL", alpaca::OrderSide::sell, "15", "100")));
+  REQUIRE(cache.Snapshot()->Find("AAPL") == nullptr);
+}
+
+TEST_CASE("AccountStateCache: a fill through flat opens a short") {
+  alpaca::AccountStateCache cache;
+
+  cache.Apply(MakeFill("TSLA", alpaca::OrderSide::buy, "3", "200"));
+  cache.Apply(MakeFill("TSLA", alpaca::OrderSide::sell, "5", "210"));
+
+  const auto *p = cache.Snapshot()->Find("TSLA");
+  REQUIRE(p != nullptr);
+  REQUIRE(p->qty == D("-2"));
+  REQUIRE(p->side == "short");
+  REQUIRE(p->avgEntryPrice == D("210"));
+}
+
+TEST_CASE("AccountStateCache: position_qty from the server wins") {
+  alpaca::AccountStateCache cache;
+
+  cache.Apply(MakeFill("AAPL", alpaca::OrderSide::buy, "1", "100", "7"));
+  REQUIRE(cache.Snapshot()->Qty("AAPL") == D("7"));
+}
+
+TEST_CASE("AccountStateCache: non-fill events are ignored") {
+  alpaca::AccountStateCache cache;
+  auto u = MakeFill("AAPL", alpaca::OrderSide::buy, "1", "100");
+  u.event = alpaca::TradeUpdateEvent::canceled;
+
+  REQUIRE_FALSE(cache.Apply(u));
+  REQUIRE(cache.Snapshot()->positions.empty());
+}
+
+TEST_CASE("AccountStateCache: fills racing a reconcile are replayed") {
+  FakeTradingClient cli;
+  cli.positions = {MakePosition("AAPL", "10", "100")};
+  alpaca::AccountStateCache cache;
+  // The REST positions predate both fills, but already reflect MSFT's.
+  cli.during = [&] {
+    cache.Apply(MakeFill("AAPL", alpaca::OrderSide::buy, "5", "100", "15"));
+    cache.Apply(MakeFill("MSFT", alpaca::OrderSide::buy, "2", "300", "2"));
+  };
+  cli.positions.push_back(MakePosition("MSFT", "2", "300"));
+
+  REQUIRE(cache.Reconcile(cli).has_value());
+  auto s = cache.Snapshot();
+  REQUIRE(s->Qty("AAPL") == D("15"));
+  REQUIRE(s->Qty("MSFT") == D("2"));
+  REQUIRE(s->Find("MSFT")->avgEntryPrice == D("300"));
+}
+
+TEST_CASE("AccountStateCache: racing fills REST already includes are not "
+          "replayed") {
+  FakeTradingClient cli;
+  alpaca::AccountStateCache cache;
+  // Both fills land before the positions are read, so REST shows 20 @ 105.
+  cli.positions = {MakePosition("AAPL", "20", "105")};
+  cli.during = [&] {
+    cache.Apply(MakeFill("AAPL", alpaca::OrderSide::buy, "10", "100", "10"));
+    cache.Apply(MakeFill("AAPL", alpaca::OrderSide::buy, "10", "110", "20"));
+  };
+
+  REQUIRE(cache.Reconcile(cli).has_value());
+  const auto *p = cache.Snapshot()->Find("AAPL");
+  REQUIRE(p->qty == D("20"));
+  REQUIRE(p->avgEntryPrice == D("105"));
+
+  // REST caught only the first: the second is replayed on top of it.
+  cli.positions = {MakePosition("AAPL", "10", "100")};
+  REQUIRE(cache.Reconcile(cli).has_value());
+  p = cache.Snapshot()->Find("AAPL");
+  REQUIRE(p->qty == D("20"));
+  REQUIRE(p->avgEntryPrice == D("105"));
+}
+
+TEST_CASE("AccountStateCache: racing fills without position_qty are counted") {
+  FakeTradingClient cli;
+  cli.positions = {MakePosition("AAPL", "10", "100")};
+  alpaca::AccountStateCache cache;
+  cli.during = [&] {
+    cache.Apply(MakeFill("AAPL", alpaca::OrderSide::buy, "5", "100"));
+  };
+
+  REQUIRE(cache.Reconcile(cli).has_value());
+  REQUIRE(cache.Snapshot()->Qty("AAPL") == D("10"));
+  REQUIRE(cache.UnreplayedFills() == 1);
+}
+
+TEST_CASE("AccountStateCache: Funds and Size follow every change") {
+  FakeTradingClient cli;
+  cli.account.cash = D("1000");
+  cli.account.buying_power = D("2000");
+  cli.positions = {MakePosition("AAPL", "10", "100")};
+  alpaca::SymbolTable symbols;
+  alpaca::AccountStateCache cache(2, symbols);
+  const auto aapl = symbols.Intern("AAPL");
+  const auto msft = symbols.Intern("MSFT");
+  const auto tsla = symbols.Intern("TSLA");
+
+  REQUIRE(cache.Size(aapl)->qty == alpaca::Decimal{});
+  REQUIRE(cache.Reconcile(cli).has_value());
+  REQUIRE(cache.Funds().cash == D("1000"));
+  REQUIRE(cache.Funds().buyingPower == D("2000"));
+  REQUIRE(cache.Size(aapl)->qty == D("10"));
+  REQUIRE(cache.Size(aapl)->avgEntryPrice == D("100"));
+
+  cache.Apply(MakeFill("MSFT", alpaca::OrderSide::buy, "2", "50"));
+  REQUIRE(cache.Size(msft)->qty == D("2"));
+  REQUIRE(cache.Funds().cash == D("900"));
+  REQUIRE(cache.Funds().fillsSinceReconcile == 1);
+
+  // Past maxSymbols only Snapshot() has the position.
+  cache.Apply(MakeFill("TSLA", alpaca::OrderSide::buy, "1", "10"));
+  REQUIRE_FALSE(cache.Size(tsla).has_value());
+  REQUIRE(cache.Snapshot()->Qty("TSLA") == D("1"));
+
+  // A reconcile that no longer has MSFT flattens its slot.
+  REQUIRE(cache.Reconcile(cli).has_value());
+  REQUIRE(cache.Size(msft)->qty == alpaca::Decimal{});
+  REQUIRE(cache.Funds().fillsSinceReconcile == 0);
+}
+
+TEST_CASE("AccountStateCache: a fill replaces only its own position") {
+  FakeTradingClient cli;
+  cli.positions = {MakePosition("AAPL", "10", "100"),
+                   MakePosition("MSFT", "1", "300")};
+  alpaca::AccountStateCache cache;
+  REQUIRE(cache.Reconcile(cli).has_value());
+  const auto before = cache.Snapshot();
+
+  cache.Apply(MakeFill("AAPL", alpaca::OrderSide::buy, "1", "100"));
+  const auto after = cache.Snapshot();
+  REQUIRE(after->positions.at("MSFT") == before->positions.at("MSFT"));
+  REQUIRE(after->positions.at("AAPL") != before->positions.at("AAPL"));
+}
+
+TEST_CASE("AccountStateCache: failed reconcile keeps the previous state") {
+  FakeTradingClient cli;
+  cli.positions = {MakePosition("AAPL", "10", "100")};
+  alpaca::AccountStateCache cache;
+  REQUIRE(cache.Reconcile(cli).has_value());
+
+  cli.fail = true;
+  auto r = cache.Reconcile(cli);
+  REQUIRE_FALSE(r.has_value());
+  REQUIRE(r.error().code == alpaca::ErrorCode::Connection);
+  REQUIRE(cache.Snapshot()->Qty("AAPL") == D("10"));
+}
+
+TEST_CASE("AccountStateCache: background reconcile runs until stopped") {
+  FakeTradingClient cli;
+  cli.positions = {MakePosition("AAPL", "10", "100")};
+  alpaca::AccountStateCache cache;
+
+  cache.ReconcileEvery(cli, std::chrono::milliseconds{1});
+  while (cli.calls < 3) {
+    auto s = cache.Snapshot();
+    const auto qty = s->Qty("AAPL");
+    REQUIRE((qty == alpaca::Decimal{} || qty == D("10")));
+    cache.Apply(MakeFill("MSFT", alpaca::OrderSide::buy, "1", "1"));
+  }
+  cache.StopReconcile();
+  const int calls = cli.calls;
+  std::this_thread::sleep_for(std::chrono::milliseconds{5});
+  REQUIRE(cli.calls == calls);
+}
@@ -0,0 +1,115 @@
+#include <alpaca/client/asyncExecutor.hpp>
+#include <alpaca/client/tradingClient.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <expected>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+struct TestEnvironment {
+  using Headers = std::vector<std::pair<std::string, std::string>>;
+
+  std::string GetBaseUrl() const { return "http://unit.test"; }
+  Headers GetAuthHeaders() const { return {}; }
+};
+
+// Thread-safe fake: every request sleeps briefly and records how many
+// requests were in flight at once.
+struct ConcurrentFakeHttpClient {
+  using Headers = TestEnvironment::Headers;
+
+  std::shared_ptr<std::atomic<int>> inFlight =
+      std::make_shared<std::atomic<int>>(0);
+  std::shared_ptr<std::atomic<int>> maxInFlight =
+      std::make_shared<std::atomic<int>>(0);
+
+  ConcurrentFakeHttpClient() = default;
+  ConcurrentFakeHttpClient(std::string, Headers) {}
+
+  template <class T>
+  std::expected<T, alpaca::APIError>
+  Request(alpaca::Req, const std::string &path,
+          std::optional<std::string> = std::nullopt,
+          std::optional<std::string> = std::nullopt) {
+    const int now = ++*inFlight;
+    int seen = maxInFlight->load();
+    while (now > seen && !maxInFlight->compare_exchange_weak(seen, now)) {
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    --*inFlight;
+
+    if (path != "/v2/clock") {
+      return std::unexpected(
+          alpaca::APIError{alpaca::ErrorCode::HTTPCode, "not found", 404});
+    }
+
+    T obj{};
+    auto err = glz::read_json(
+        obj, R"({"timestamp":"t","is_open":true,"next_open":"o","next_close":"c"})");
+    if (err) {
+      return std::unexpected(
+          alpaca::APIError{alpaca::ErrorCode::JSONParsing, "bad fixture"});
+    }
+    return obj;
+  }
+};
+
+} // namespace
+
+TEST_CASE("AsyncExecutor: runs submitted work and returns results") {
+  alpaca::AsyncExecutor io{2};
+
+  auto a = io.Submit([] { return 1; });
+  auto b = io.Submit([] { return std::string("two"); });
+
+  REQUIRE(a.get() == 1);
+  REQUIRE(b.get() == "two");
+}
+
+TEST_CASE("AsyncExecutor: destructor drains pending work") {
+  std::atomic<int> done{0};
+  {
+    alpaca::AsyncExecutor io{1};
+    for (int i = 0; i < 8; ++i) {
+      io.Submit([&] { ++done; });
+    }
+  }
+  REQUIRE(done == 8);
+}
+
+TEST_CASE("TradingClient.Async: requests overlap and keep expected results") {
+  TestEnvironment env{};
+  ConcurrentFakeHttpClient http{};
+  auto maxInFlight = http.maxInFlight;
+
+  alpaca::TradingClientT<TestEnvironment, ConcurrentFakeHttpClient> cli(
+      env, std::move(http));
+  alpaca::AsyncExecutor io{3};
+
+  std::vector<alpaca::AsyncResult<alpaca::Clock>> futs;
+  for (int i = 0; i < 3; ++i) {
+    futs.push_back(
+        cli.Async(io, [](auto &c) { return c.GetMarketClockInfo(); }));
+  }
+  auto bad = cli.Async(io, [](auto &c) { return c.GetAccount(); });
+
+  for (auto &f : futs) {
+    auto clock = f.get();
+    REQUIRE(clock.has_value());
+    REQUIRE(clock->isOpen);
+  }
+
+  auto acc = bad.get();
+  REQUIRE_FALSE(acc.has_value());
+  REQUIRE(acc.error().status.value() == 404);
+  REQUIRE(maxInFlight->load() > 1);
+}
@@ -1,9 +1,11 @@
 #include <alpaca/models/marketdata/serialize.hpp>
+#include <alpaca/utils/utils.hpp>
 
 #include <catch2/catch_approx.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <glaze/glaze.hpp>
 
+#include <chrono>
 #include <map>
 #include <string>
 #include <vector>
@@ -199,3 +201,97 @@ TEST_CASE("Glaze Bar: missing keys fails parsing (strict missing keys)") {
   REQUIRE(ec);
   REQUIRE(ec.ec == glz::error_code::missing_key);
 }
+
+TEST_CASE("Glaze BarSeriesPage: decodes bars into columns") {
+  alpaca::BarSeriesPage page{};
+  auto ec = glz::read_json(page, bars_json_map());
+  REQUIRE(!ec);
+
+  REQUIRE(page.next_page_token.value() == "TOKEN_123");
+  REQUIRE(page.bars.size() == 2);
+
+  const auto &aapl = page.bars.at("AAPL");
+  REQUIRE(aapl.size() == 2);
+  REQUIRE(aapl.close.size() == 2);
+  REQUIRE(aapl.close[0] == Catch::Approx(155.25));
+  REQUIRE(aapl.open[1] == Catch::Approx(155.50));
+  REQUIRE(aapl.volume[0] == 99999);
+  REQUIRE(aapl.numTrades[1] == 200);
+  REQUIRE(aapl.vwap[1] == Catch::Approx(156.00));
+  // 2024-01-03T00:00:00Z and five minutes later, in epoch nanoseconds.
+  REQUIRE(aapl.timestamp[0] == 1704240000LL * 1'000'000'000);
+  REQUIRE(aapl.timestamp[1] - aapl.timestamp[0] == 300LL * 1'000'000'000);
+
+  REQUIRE(page.bars.at("MSFT").size() == 1);
+}
+
+TEST_CASE("Glaze BarSeriesPage: malformed timestamp is a parse error") {
+  alpaca::BarSeriesPage page{};
+  auto ec = glz::read_json(
+      page, R"json({"bars":{"AAPL":[{"c":1,"h":1,"l":1,"n":1,"o":1,)json"
+            R"json("t":"yesterday","v":1,"vw":1}]}})json");
+  REQUIRE(ec);
+}
+
+TEST_CASE("Glaze BarsT<Timestamp>: timestamps decode to nanosecond time "
+          "points") {
+  alpaca::BarsT<alpaca::Timestamp> bars{};
+  auto ec = glz::read_json(bars, bars_json_map());
+  REQUIRE(!ec);
+
+  const auto &aapl = bars.bars.at("AAPL");
+  REQUIRE(aapl.size() == 2);
+  REQUIRE(aapl[0].timestamp.EpochNanos() == 1704240000LL * 1'000'000'000);
+  REQUIRE(aapl[1].timestamp > aapl[0].timestamp);
+  REQUIRE(aapl[0].close == Catch::Approx(155.25));
+}
+
+TEST_CASE("Timestamp: fractional seconds and offsets") {
+  auto a = alpaca::Timestamp::Parse("2024-01-02T10:00:00.123456789Z");
+  REQUIRE(a.has_value());
+  REQUIRE(a->EpochNanos() % 1'000'000'000 == 123456789);
+
+  auto b = alpaca::Timestamp::Parse("2024-01-02T05:00:00-05:00");
+  auto c = alpaca::Timestamp::Parse("2024-01-02T10:00:00Z");
+  REQUIRE(b.has_value());
+  REQUIRE(c.has_value());
+  REQUIRE(*b == *c);
+
+  REQUIRE_FALSE(alpaca::Timestamp::Parse("2024-01-02 10:00").has_value());
+}
+
+TEST_CASE("Timestamp: dates that do not exist are rejected") {
+  using alpaca::Timestamp;
+  REQUIRE(Timestamp::Parse("2024-02-29T00:00:00Z").has_value());
+  REQUIRE(Timestamp::Parse("2000-02-29T00:00:00Z").has_value());
+  REQUIRE_FALSE(Timestamp::Parse("2023-02-29T00:00:00Z").has_value());
+  REQUIRE_FALSE(Timestamp::Parse("1900-02-29T00:00:00Z").has_value());
+  REQUIRE_FALSE(Timestamp::Parse("2024-04-31T00:00:00Z").has_value());
+}
+
+TEST_CASE("FromIsoz: dates and whole-second UTC times only") {
+  using namespace std::chrono;
+  using alpaca::utils::FromIsoz;
+  REQUIRE(FromIsoz("2024-01-02") == sys_days{2024y / January / 2});
+  REQUIRE(FromIsoz("2024-01-02T10:00:05Z") ==
+          sys_days{2024y / January / 2} + 10h + 5s);
+  REQUIRE(alpaca::utils::ToIsoz(*FromIsoz("2024-01-02T10:00:05Z")) ==
+          "2024-01-02T10:00:05Z");
+  REQUIRE_FALSE(FromIsoz("2024-02-30").has_value());
+  REQUIRE_FALSE(FromIsoz("2024-01-02T10:00:05.5Z").has_value());
+  REQUIRE_FALSE(FromIsoz("2024-01-02T05:00:05-05:00").has_value());
+}
+
+TEST_CASE("Glaze Timestamp: write -> read roundtrip") {
+  alpaca::BarT<alpaca::Timestamp> in{};
+  in.timestamp = *alpaca::Timestamp::Parse("2024-01-03T00:05:00.5Z");
+
+  std::string json;
+  REQUIRE(!glz::write_json(in, json));
+  REQUIRE(json.find(R"("t":"2024-01-03T00:05:00.500000000Z")") !=
+          std::string::npos);
+
+  alpaca::BarT<alpaca::Timestamp> out{};
+  REQUIRE(!glz::read_json(out, json));
+  REQUIRE(out.timestamp == in.timestamp);
+}
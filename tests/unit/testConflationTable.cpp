@@ -0,0 +1,78 @@
+#include <alpaca/utils/conflationTable.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+TEST_CASE("ConflationTable: keeps the latest value per symbol") {
+  alpaca::ConflationTable<int> t(4);
+
+  REQUIRE(t.Put(2, 10));
+  REQUIRE(t.Put(0, 1));
+  REQUIRE(t.Put(2, 11));
+  REQUIRE(t.Put(2, 12));
+  REQUIRE_FALSE(t.Put(4, 99));
+  REQUIRE(t.Dirty() == 2);
+  REQUIRE(t.Coalesced() == 2);
+
+  alpaca::SymbolId id;
+  int v;
+  uint32_t coalesced;
+  REQUIRE(t.TryTake(id, v, coalesced));
+  REQUIRE(id == 2);
+  REQUIRE(v == 12);
+  REQUIRE(coalesced == 2);
+
+  REQUIRE(t.TryTake(id, v, coalesced));
+  REQUIRE(id == 0);
+  REQUIRE(v == 1);
+  REQUIRE(coalesced == 0);
+  REQUIRE_FALSE(t.TryTake(id, v, coalesced));
+
+  // A taken symbol becomes dirty again on its next update.
+  REQUIRE(t.Put(2, 13));
+  REQUIRE(t.TryTake(id, v, coalesced));
+  REQUIRE(v == 13);
+  REQUIRE(coalesced == 0);
+}
+
+TEST_CASE("ConflationTable: consumer always ends on the final value") {
+  constexpr int kSymbols = 16;
+  constexpr int kRounds = 20000;
+  alpaca::ConflationTable<int> t(kSymbols);
+
+  std::thread producer([&] {
+    for (int r = 1; r <= kRounds; ++r) {
+      for (alpaca::SymbolId s = 0; s < kSymbols; ++s) {
+        t.Put(s, r);
+      }
+    }
+  });
+
+  std::vector<int> last(kSymbols, 0);
+  std::uint64_t taken = 0;
+  bool monotonic = true;
+  auto done = [&] {
+    for (int v : last) {
+      if (v != kRounds) {
+        return false;
+      }
+    }
+    return true;
+  };
+  while (!done()) {
+    alpaca::SymbolId id;
+    int v;
+    uint32_t coalesced;
+    if (t.TryTake(id, v, coalesced)) {
+      monotonic = monotonic && v > last[id];
+      last[id] = v;
+      taken += 1 + coalesced;
+    }
+  }
+  producer.join();
+  REQUIRE(monotonic);
+  REQUIRE(taken == std::uint64_t{kSymbols} * kRounds);
+}
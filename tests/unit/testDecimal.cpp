@@ -0,0 +1,127 @@
+#include <alpaca/models/trading/serialize.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+#include <glaze/glaze.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <format>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+alpaca::Decimal dec(std::string_view s) {
+  auto d = alpaca::Decimal::Parse(s);
+  REQUIRE(d.has_value());
+  return *d;
+}
+
+} // namespace
+
+TEST_CASE("Decimal: parse keeps the wire scale") {
+  REQUIRE(dec("150.00").ToString() == "150.00");
+  REQUIRE(dec("150.00").Mantissa() == 15000);
+  REQUIRE(dec("150.00").Scale() == 2);
+  REQUIRE(dec("-0.0333").ToString() == "-0.0333");
+  REQUIRE(dec("10").ToString() == "10");
+  REQUIRE(dec("1.5e-05").ToString() == "0.000015");
+  REQUIRE(dec("2E3").ToString() == "2000");
+
+  REQUIRE_FALSE(alpaca::Decimal::Parse("").has_value());
+  REQUIRE_FALSE(alpaca::Decimal::Parse("-").has_value());
+  REQUIRE_FALSE(alpaca::Decimal::Parse("1.2.3").has_value());
+  REQUIRE_FALSE(alpaca::Decimal::Parse("1e").has_value());
+  REQUIRE_FALSE(alpaca::Decimal::Parse("99999999999999999999").has_value());
+}
+
+TEST_CASE("Decimal: digits past the precision are rounded half away from "
+          "zero") {
+  REQUIRE(dec("0.1234567890123456789").ToString() == "0.123456789012345679");
+  REQUIRE(dec("1.005").Round(2).ToString() == "1.01");
+  REQUIRE(dec("-1.005").Round(2).ToString() == "-1.01");
+  REQUIRE(dec("1.004").Round(2).ToString() == "1.00");
+}
+
+TEST_CASE("Decimal: arithmetic is exact") {
+  REQUIRE(dec("0.1") + dec("0.2") == dec("0.3"));
+  REQUIRE((dec("1550.00") - dec("1500.00")).ToString() == "50.00");
+  REQUIRE((dec("150.25") * dec("10")).ToString() == "1502.50");
+  REQUIRE((dec("-3.5") * 2).ToString() == "-7.0");
+  REQUIRE((dec("10") / dec("4")).ToString() == "2.500000000");
+  REQUIRE((dec("2") / dec("3")).ToString() == "0.666666667");
+  REQUIRE(dec("1") / 0 == 0);
+
+  // The 128-bit product is rounded, not the operands.
+  REQUIRE((dec("12345678901.123456") * dec("1000000.5")).ToString() ==
+          "12345685073962906.56");
+
+  auto pnl = dec("0");
+  pnl += (dec("155.00") - dec("150.00")) * dec("10");
+  REQUIRE(pnl == 50);
+}
+
+TEST_CASE("Decimal: compares values, not representations") {
+  REQUIRE(dec("1.50") == dec("1.5"));
+  REQUIRE(dec("-1.5") < dec("-1.2"));
+  REQUIRE(dec("-1") < dec("-0.9999"));
+  REQUIRE(dec("0.0001") > 0);
+  REQUIRE(dec("2") > dec("1.999999999999999999"));
+}
+
+TEST_CASE("Decimal: conversions from and to binary floating point") {
+  REQUIRE(alpaca::Decimal{0.1}.ToString() == "0.1");
+  REQUIRE(alpaca::Decimal{250.50L}.ToString() == "250.5");
+  REQUIRE(static_cast<double>(dec("251.01")) == 251.01);
+  REQUIRE(std::format("{:>8}", dec("1.5")) == "     1.5");
+
+  REQUIRE(alpaca::Decimal::FromFloat(0.5) == dec("0.5"));
+  REQUIRE_FALSE(alpaca::Decimal::FromFloat(std::nan("")).has_value());
+  REQUIRE_FALSE(alpaca::Decimal::FromFloat(
+                    std::numeric_limits<double>::infinity())
+                    .has_value());
+  REQUIRE_FALSE(alpaca::Decimal::FromFloat(1e300).has_value());
+  REQUIRE(alpaca::Decimal{std::nan("")} == 0);
+  STATIC_REQUIRE_FALSE(std::is_convertible_v<double, alpaca::Decimal>);
+}
+
+TEST_CASE("Decimal: integers and raw parts out of range saturate") {
+  constexpr auto kMax = std::numeric_limits<std::int64_t>::max();
+  constexpr auto kMin = std::numeric_limits<std::int64_t>::min();
+  REQUIRE(alpaca::Decimal{kMin}.Mantissa() == -kMax);
+  REQUIRE((-alpaca::Decimal{kMin}).Mantissa() == kMax);
+  REQUIRE(alpaca::Decimal{std::numeric_limits<std::uint64_t>::max()}
+              .Mantissa() == kMax);
+
+  REQUIRE(alpaca::Decimal::FromRaw(kMin, 2).Mantissa() == -kMax);
+  const auto fine = alpaca::Decimal::FromRaw(1550, 20);
+  REQUIRE(fine.Scale() == alpaca::Decimal::kMaxScale);
+  REQUIRE(fine == dec("0.000000000000000016"));
+  REQUIRE(alpaca::Decimal::FromRaw(15, -2) == 1500);
+  REQUIRE(alpaca::Decimal::FromRaw(kMax, -1).Mantissa() == kMax);
+}
+
+TEST_CASE("Glaze Decimal: reads quoted and bare numbers, writes quoted") {
+  std::vector<alpaca::Decimal> v;
+  REQUIRE(!glz::read_json(v, R"(["150.00", 2.5, -3, "1e2"])"));
+  REQUIRE(v.size() == 4);
+  REQUIRE(v[0].ToString() == "150.00");
+  REQUIRE(v[1] == dec("2.5"));
+  REQUIRE(v[2] == -3);
+  REQUIRE(v[3] == 100);
+
+  std::string json;
+  REQUIRE(!glz::write_json(v, json));
+  REQUIRE(json == R"(["150.00","2.5","-3","100"])");
+
+  alpaca::Decimal bad{};
+  REQUIRE(glz::read_json(bad, R"("abc")"));
+
+  // Alpaca sends "" for some unset account amounts.
+  alpaca::Decimal empty{dec("1")};
+  REQUIRE(!glz::read_json(empty, R"("")"));
+  REQUIRE(empty == 0);
+}
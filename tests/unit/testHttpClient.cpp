@@ -0,0 +1,132 @@
+#include <alpaca/client/httpClient.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <variant>
+
+namespace {
+
+using Reply = std::map<std::string, int>;
+
+// A finished exchange as httplib would hand it back; the body goes into the
+// response unless the caller streamed it elsewhere.
+httplib::Result Response(int status, std::string body = {}) {
+  auto res = std::make_unique<httplib::Response>();
+  res->status = status;
+  res->body = std::move(body);
+  return httplib::Result(std::move(res), httplib::Error::Success);
+}
+
+} // namespace
+
+TEST_CASE("HttpClient: GET bodies go to the per-thread response buffer") {
+  using alpaca::Req;
+  using alpaca::detail::BodySink;
+  using alpaca::detail::ResponseBuffer;
+
+  REQUIRE(BodySink(Req::GET) == &ResponseBuffer());
+  REQUIRE(BodySink(Req::POST) == nullptr);
+  REQUIRE(BodySink(Req::DELETE) == nullptr);
+  REQUIRE(BodySink(Req::PATCH) == nullptr);
+}
+
+TEST_CASE("HttpClient: endpoint names fold ids and symbols") {
+  using alpaca::Req;
+  using alpaca::detail::EndpointName;
+
+  REQUIRE(EndpointName(Req::GET, "/v2/positions") == "GET /v2/positions");
+  REQUIRE(EndpointName(Req::GET, "/v2/positions/AAPL") ==
+          "GET /v2/positions/:symbol");
+  REQUIRE(EndpointName(Req::DELETE, "/v2/positions/MSFT?percentage=50") ==
+          "DELETE /v2/positions/:symbol");
+  REQUIRE(EndpointName(Req::GET, "/v2/assets/MSFT") ==
+          "GET /v2/assets/:symbol");
+  REQUIRE(EndpointName(Req::GET,
+                       "/v2/assets/b0b6dd9d-8b9b-48a9-ba46-b9d54906e415") ==
+          "GET /v2/assets/:id");
+  REQUIRE(EndpointName(Req::GET,
+                       "/v2/orders/61e69015-8549-4bfd-b9c3-01e75843f47d"
+                       "?nested=true") == "GET /v2/orders/:id");
+  REQUIRE(EndpointName(Req::GET, "/v2/stocks/bars/latest?symbols=AAPL") ==
+          "GET /v2/stocks/bars/latest");
+}
+
+TEST_CASE("HttpClient: a large response buffer is released after decoding") {
+  using alpaca::detail::kResponseBufferCap;
+  using alpaca::detail::TrimResponseBuffer;
+
+  std::string sink;
+  sink.reserve(kResponseBufferCap / 2);
+  sink = "[]";
+  const auto kept = sink.capacity();
+  TrimResponseBuffer(&sink);
+  REQUIRE(sink.capacity() == kept);
+  REQUIRE(sink == "[]");
+
+  sink.reserve(kResponseBufferCap * 2);
+  TrimResponseBuffer(&sink);
+  REQUIRE(sink.capacity() <= kResponseBufferCap);
+
+  TrimResponseBuffer(nullptr);
+}
+
+TEST_CASE("HttpClient: Decode reads the sink, not the response body") {
+  auto &sink = alpaca::detail::ResponseBuffer();
+  sink = R"({"conn":7})";
+  const auto resp = Response(200);
+
+  auto out = alpaca::detail::Decode<Reply>(resp, &sink);
+  REQUIRE(out.has_value());
+  REQUIRE(out->at("conn") == 7);
+
+  // Without a sink the response body is decoded.
+  const auto direct = Response(200, R"({"conn":3})");
+  auto plain = alpaca::detail::Decode<Reply>(direct);
+  REQUIRE(plain.has_value());
+  REQUIRE(plain->at("conn") == 3);
+}
+
+TEST_CASE("HttpClient: an HTTP error carries the streamed body") {
+  auto &sink = alpaca::detail::ResponseBuffer();
+  sink = R"({"code":42210000,"message":"insufficient buying power"})";
+  const auto resp = Response(403);
+
+  Reply out;
+  auto done = alpaca::detail::DecodeInto(resp, &sink, out);
+  REQUIRE_FALSE(done.has_value());
+  REQUIRE(done.error().code == alpaca::ErrorCode::HTTPCode);
+  REQUIRE(done.error().status == 403);
+  REQUIRE(done.error().message == sink);
+}
+
+TEST_CASE("HttpClient: an empty body resets the target") {
+  std::string sink;
+  const auto resp = Response(204);
+
+  Reply out{{"stale", 1}};
+  auto done = alpaca::detail::DecodeInto(resp, &sink, out);
+  REQUIRE(done.has_value());
+  REQUIRE(out.empty());
+}
+
+TEST_CASE("HttpClient: a transport failure is a Transport error") {
+  const httplib::Result resp(nullptr, httplib::Error::Read);
+
+  auto out = alpaca::detail::Decode<Reply>(resp, nullptr);
+  REQUIRE_FALSE(out.has_value());
+  REQUIRE(out.error().code == alpaca::ErrorCode::Transport);
+  REQUIRE_FALSE(out.error().status.has_value());
+}
+
+TEST_CASE("HttpClient: a malformed body is a JSONParsing error") {
+  std::string sink = R"({"conn":)";
+  const auto resp = Response(200);
+
+  auto out = alpaca::detail::Decode<Reply>(resp, &sink);
+  REQUIRE_FALSE(out.has_value());
+  REQUIRE(out.error().code == alpaca::ErrorCode::JSONParsing);
+  REQUIRE(out.error().status == 200);
+}
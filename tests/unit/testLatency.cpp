@@ -0,0 +1,109 @@
+#include <alpaca/utils/latency.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+TEST_CASE("HdrHistogram: buckets tile the range within 1/32") {
+  using H = alpaca::HdrHistogram;
+  REQUIRE(H::Index(0) == 0);
+  REQUIRE(H::Index(31) == 31);
+  REQUIRE(H::Index(63) == 63);
+  REQUIRE(H::Index(H::kMaxValue) == H::kBuckets - 1);
+
+  uint64_t prevUpper = 0;
+  for (std::size_t i = 1; i < H::kBuckets; ++i) {
+    const auto upper = H::UpperBound(i);
+    const auto lower = prevUpper + 1;
+    REQUIRE(H::Index(lower) == i);
+    REQUIRE(H::Index(upper) == i);
+    REQUIRE(upper - lower <= lower / 32);
+    prevUpper = upper;
+  }
+  REQUIRE(prevUpper == H::kMaxValue);
+}
+
+TEST_CASE("HdrHistogram: percentiles, min, max and mean") {
+  alpaca::HdrHistogram h;
+  REQUIRE(h.Snapshot().count == 0);
+  REQUIRE(h.Snapshot().Percentile(0.5) == 0);
+
+  for (uint64_t v = 1; v <= 1000; ++v) {
+    h.Record(v * 1000);
+  }
+  const auto s = h.Snapshot();
+  REQUIRE(s.count == 1000);
+  REQUIRE(s.min == 1000);
+  REQUIRE(s.max == 1000000);
+  REQUIRE(s.mean == 500500.0);
+
+  auto near = [](uint64_t got, uint64_t want) {
+    return got >= want && got <= want + want / 32;
+  };
+  REQUIRE(near(s.Percentile(0.5), 500000));
+  REQUIRE(near(s.Percentile(0.99), 990000));
+  REQUIRE(s.Percentile(1.0) == 1000000);
+  REQUIRE(near(s.Percentile(0.0), 1000));
+}
+
+TEST_CASE("HdrHistogram: durations, clamping and reset") {
+  alpaca::HdrHistogram h;
+  h.Record(std::chrono::microseconds(3));
+  h.Record(std::chrono::nanoseconds(-5));
+  h.Record(~uint64_t{0});
+
+  auto s = h.Snapshot();
+  REQUIRE(s.count == 3);
+  REQUIRE(s.min == 0);
+  REQUIRE(s.max == alpaca::HdrHistogram::kMaxValue);
+  REQUIRE(s.Percentile(0.5) >= 3000);
+  REQUIRE(s.Percentile(0.5) <= 3000 + 3000 / 32);
+
+  h.Reset();
+  REQUIRE(h.Snapshot().count == 0);
+  h.Record(7);
+  REQUIRE(h.Snapshot().min == 7);
+}
+
+TEST_CASE("HdrHistogram: concurrent recording loses nothing") {
+  alpaca::HdrHistogram h;
+  constexpr int kThreads = 4;
+  constexpr int kPerThread = 20000;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < kPerThread; ++i) {
+        h.Record(static_cast<uint64_t>(t * kPerThread + i));
+      }
+    });
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+
+  const auto s = h.Snapshot();
+  REQUIRE(s.count == kThreads * kPerThread);
+  REQUIRE(s.min == 0);
+  REQUIRE(s.max == kThreads * kPerThread - 1);
+}
+
+TEST_CASE("Instrumentation: histograms by name and snapshots") {
+  alpaca::Instrumentation in;
+  auto &a = in.Histogram("md.decode trade");
+  REQUIRE(&in.Histogram("md.decode trade") == &a);
+
+  in.Histogram("unused");
+  a.Record(100);
+  a.Record(200);
+
+  auto snap = in.Snapshot();
+  REQUIRE(snap.size() == 1);
+  REQUIRE(snap.at("md.decode trade").count == 2);
+
+  in.Reset();
+  REQUIRE(in.Snapshot().empty());
+}
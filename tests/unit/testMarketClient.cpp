@@ -5,6 +5,7 @@
 #include <catch2/matchers/catch_matchers_string.hpp>
 
 #include <expected>
+#include <format>
 #include <print>
 #include <string>
 #include <unordered_map>
@@ -231,7 +232,7 @@ TEST_CASE("MarketDataClient.GetBars: input validation errors") {
     p.limit = 0;
     auto res = cli.GetBars(p);
     REQUIRE_FALSE(res.has_value());
-    REQUIRE(res.error().message == "Empty limit");
+    REQUIRE(res.error().message == "Limit must be positive");
   }
 }
 
@@ -332,3 +333,144 @@ TEST_CASE("MarketDataClient.GetLatestBar: empty symbols returns error") {
   REQUIRE_FALSE(res.has_value());
   REQUIRE(res.error().message == "Empty symbol");
 }
+
+TEST_CASE("MarketDataClient.GetBarsSharded: splits symbols and time, merges "
+          "in order") {
+  TestEnvironment env{};
+  FakeHttpClient http{env.GetDataUrl(), env.GetAuthHeaders()};
+
+  const std::string aaplDay1 = "/v2/stocks/bars?"
+                               "symbols=AAPL&"
+                               "timeframe=1Min&"
+                               "start=2024-01-03T00:00:00Z&"
+                               "end=2024-01-03T23:59:59Z";
+  const std::string aaplDay2 = "/v2/stocks/bars?"
+                               "symbols=AAPL&"
+                               "timeframe=1Min&"
+                               "start=2024-01-04T00:00:00Z&"
+                               "end=2024-01-05T00:00:00Z";
+  const std::string msftDay1 = "/v2/stocks/bars?"
+                               "symbols=MSFT&"
+                               "timeframe=1Min&"
+                               "start=2024-01-03T00:00:00Z&"
+                               "end=2024-01-03T23:59:59Z";
+  const std::string msftDay2 = "/v2/stocks/bars?"
+                               "symbols=MSFT&"
+                               "timeframe=1Min&"
+                               "start=2024-01-04T00:00:00Z&"
+                               "end=2024-01-05T00:00:00Z";
+
+  auto page = [](const char *sym, double close, const char *token) {
+    return std::format(
+        R"json({{"bars":{{"{}":[{{"c":{},"h":0,"l":0,"n":0,"o":0,)json"
+        R"json("t":"x","v":0,"vw":0}}]}},"next_page_token":"{}"}})json",
+        sym, close, token);
+  };
+
+  using Response = FakeHttpClient::Response;
+  http.getRoutes[aaplDay1] = Response{200, page("AAPL", 1, "")};
+  http.getRoutes[aaplDay2] = Response{200, page("AAPL", 2, "A2")};
+  http.getRoutes[aaplDay2 + "&page_token=A2"] =
+      Response{200, page("AAPL", 3, "")};
+  http.getRoutes[msftDay1] = Response{200, page("MSFT", 4, "")};
+  http.getRoutes[msftDay2] = Response{200, page("MSFT", 5, "")};
+
+  alpaca::MarketDataClientT<TestEnvironment, FakeHttpClient> cli(
+      env, std::move(http));
+
+  alpaca::BarParams p{};
+  p.symbols = {"AAPL", "MSFT"};
+  p.timeframe = "1Min";
+  p.start = "2024-01-03T00:00:00Z";
+  p.end = "2024-01-05T00:00:00Z";
+
+  alpaca::BarShardOptions o{};
+  o.symbolsPerShard = 1;
+  o.timeSlices = 2;
+  // FakeHttpClient records calls without locking.
+  o.maxParallel = 1;
+
+  auto res = cli.GetBarsSharded(p, o);
+  REQUIRE(res.has_value());
+  REQUIRE(res->bars.at("AAPL").size() == 3);
+  REQUIRE(res->bars.at("AAPL")[0].close == Catch::Approx(1.0));
+  REQUIRE(res->bars.at("AAPL")[1].close == Catch::Approx(2.0));
+  REQUIRE(res->bars.at("AAPL")[2].close == Catch::Approx(3.0));
+  REQUIRE(res->bars.at("MSFT").size() == 2);
+  REQUIRE(res->bars.at("MSFT")[0].close == Catch::Approx(4.0));
+  REQUIRE(res->bars.at("MSFT")[1].close == Catch::Approx(5.0));
+}
+
+TEST_CASE("MarketDataClient.GetBarsSharded: a failing shard fails the call") {
+  TestEnvironment env{};
+  FakeHttpClient http{env.GetDataUrl(), env.GetAuthHeaders()};
+
+  const std::string aapl = "/v2/stocks/bars?"
+                           "symbols=AAPL&"
+                           "timeframe=1D&"
+                           "start=2024-01-03T00:00:00Z&"
+                           "end=2024-01-04T00:00:00Z";
+  const std::string msft = "/v2/stocks/bars?"
+                           "symbols=MSFT&"
+                           "timeframe=1D&"
+                           "start=2024-01-03T00:00:00Z&"
+                           "end=2024-01-04T00:00:00Z";
+
+  http.getRoutes[aapl] = FakeHttpClient::Response{
+      200, R"json({"bars":{"AAPL":[]},"next_page_token":""})json"};
+  http.getRoutes[msft] = FakeHttpClient::Response{500, "boom"};
+
+  alpaca::MarketDataClientT<TestEnvironment, FakeHttpClient> cli(
+      env, std::move(http));
+
+  alpaca::BarParams p{};
+  p.symbols = {"AAPL", "MSFT"};
+
+  alpaca::BarShardOptions o{};
+  o.symbolsPerShard = 1;
+  o.maxParallel = 1;
+
+  auto res = cli.GetBarsSharded(p, o);
+  REQUIRE_FALSE(res.has_value());
+  REQUIRE(res.error().status.value() == 500);
+}
+
+TEST_CASE("MarketDataClient.ForEachBarPage: hands out pages as they arrive") {
+  TestEnvironment env{};
+  FakeHttpClient http{env.GetDataUrl(), env.GetAuthHeaders()};
+
+  const std::string page1 = "/v2/stocks/bars?"
+                            "symbols=AAPL%2CMSFT&"
+                            "timeframe=1D&"
+                            "start=2024-01-03T00:00:00Z&"
+                            "end=2024-01-04T00:00:00Z";
+  const std::string page2 = page1 + "&page_token=TOKEN_1";
+
+  http.getRoutes[page1] = FakeHttpClient::Response{200, bars_page_1_json()};
+  http.getRoutes[page2] = FakeHttpClient::Response{200, bars_page_2_json()};
+
+  alpaca::MarketDataClientT<TestEnvironment, FakeHttpClient> cli(
+      env, std::move(http));
+
+  alpaca::BarParams p{};
+  p.symbols = {"AAPL", "MSFT"};
+
+  SECTION("every page is delivered once") {
+    std::vector<std::size_t> symbolsPerPage;
+    auto res = cli.ForEachBarPage(p, [&](alpaca::Bars &&page) {
+      symbolsPerPage.push_back(page.bars.size());
+    });
+    REQUIRE(res.has_value());
+    REQUIRE(symbolsPerPage == std::vector<std::size_t>{1, 2});
+  }
+
+  SECTION("returning false stops pagination") {
+    int pages = 0;
+    auto res = cli.ForEachBarPage(p, [&](alpaca::Bars &&) {
+      ++pages;
+      return false;
+    });
+    REQUIRE(res.has_value());
+    REQUIRE(pages == 1);
+  }
+}
@@ -3,8 +3,13 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_string.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <map>
 #include <memory>
 #include <string>
+#include <thread>
+#include <variant>
 #include <vector>
 
 // ── Test doubles ──────────────────────────────────────────────────────────────
@@ -24,19 +29,40 @@ struct TestEnvironment {
 struct FakeWsState {
     std::vector<std::string> sent;
     alpaca::WsCallbacks      cbs;
+    std::map<std::string, std::string> headers;
     bool                     connected = false;
+    std::atomic<int>         connects{0};
+    // When set, Connect waits for `release` as IX's stop() waits for its
+    // socket thread; `inConnect` tells the test it got there.
+    std::atomic<bool>        holdConnect{false};
+    std::atomic<bool>        inConnect{false};
+    std::atomic<bool>        release{false};
 
     void Inject(const std::string& msg) {
         if (cbs.onMessage) cbs.onMessage(msg);
     }
+    // As a WebSocketClient does, with the time the frame was received.
+    void InjectAt(const std::string& msg, const alpaca::ReceiveTime& at) {
+        if (cbs.onTimedMessage) cbs.onTimedMessage(msg, at);
+    }
+    // Connection lost without the stream asking for it.
+    void Drop() {
+        connected = false;
+        if (cbs.onClose) cbs.onClose();
+    }
 };
 
 struct FakeWebSocket {
     std::shared_ptr<FakeWsState> state = std::make_shared<FakeWsState>();
 
     void Connect(const std::string& /*url*/, alpaca::WsCallbacks c) {
+        if (state->holdConnect) {
+            state->inConnect = true;
+            while (!state->release) std::this_thread::yield();
+        }
         state->cbs       = std::move(c);
         state->connected = true;
+        ++state->connects;
         // market-data protocol: server sends "connected" first; no auto-open
     }
     void Disconnect() {
@@ -44,6 +70,10 @@ struct FakeWebSocket {
         if (state->cbs.onClose) state->cbs.onClose();
     }
     void Send(const std::string& m) { state->sent.push_back(m); }
+    void SendBinary(const std::string& m) { state->sent.push_back(m); }
+    void SetHeader(const std::string& name, const std::string& value) {
+        state->headers[name] = value;
+    }
     bool IsConnected() const { return state->connected; }
 };
 
@@ -181,6 +211,36 @@ TEST_CASE("[MarketDataStream] error message fires onError", "[MarketDataStream]"
                  Catch::Matchers::ContainsSubstring("not authenticated"));
 }
 
+TEST_CASE("[MarketDataStream] JSON escapes in strings are decoded", "[MarketDataStream]") {
+    TestEnvironment env;
+    alpaca::MarketDataSubscription sub;
+
+    std::string message;
+    std::string symbol;
+    alpaca::MarketDataCallbacks cbs;
+    cbs.onError = [&](alpaca::APIError e) { message = e.message; };
+    cbs.onTradeView = [&](const alpaca::StreamTradeView &t) {
+        symbol = std::string(t.symbol);
+    };
+
+    auto [stream, ws] = MakeStream(env, sub, cbs);
+    ws->Inject(R"([{"T":"success","msg":"connected"}])");
+    ws->Inject(
+        R"([{"T":"error","code":400,"msg":"bad \"feed\"\\\né😀"}])");
+    REQUIRE(message == "bad \"feed\"\\\n\xC3\xA9\xF0\x9F\x98\x80");
+
+    ws->Inject(R"([{"T":"t","S":"BRK\/B","t":"2024-01-02T13:24:48Z","p":1,"s":1}])");
+    REQUIRE(symbol == "BRK/B");
+
+    ws->Inject(R"([{"T":"subscription","trades":["BRK\/A"],"quotes":[],"bars":[]}])");
+    REQUIRE(stream->ConfirmedSubscription().trades ==
+            std::vector<std::string>{"BRK/A"});
+
+    message.clear();
+    ws->Inject(R"([{"T":"error","code":400,"msg":"bad \x"}])");
+    REQUIRE(message.starts_with("Malformed market data frame"));
+}
+
 TEST_CASE("[MarketDataStream] unknown T value is silently ignored", "[MarketDataStream]") {
     TestEnvironment env;
     alpaca::MarketDataSubscription sub;
@@ -195,3 +255,707 @@ TEST_CASE("[MarketDataStream] unknown T value is silently ignored", "[MarketData
 
     REQUIRE(errors == 0);
 }
+
+TEST_CASE("[MarketDataStream] quote view and owning quote carry the same data", "[MarketDataStream]") {
+    TestEnvironment env;
+    alpaca::MarketDataSubscription sub;
+    sub.quotes = {"AAPL"};
+
+    std::string viewSymbol, viewAskExchange, viewTimestamp;
+    double viewBid = 0;
+    int64_t viewNanos = 0;
+    alpaca::StreamQuote owned;
+    alpaca::MarketDataCallbacks cbs;
+    cbs.onQuoteView = [&](const alpaca::StreamQuoteView& q) {
+        viewSymbol      = q.symbol;
+        viewAskExchange = q.askExchange;
+        viewTimestamp   = q.timestamp;
+        viewBid         = q.bidPrice;
+        viewNanos       = q.time.EpochNanos();
+    };
+    cbs.onQuote = [&](alpaca::StreamQuote q) { owned = std::move(q); };
+
+    auto [stream, ws] = MakeStream(env, sub, cbs);
+    ws->Inject(
+        R"([{"T":"q","S":"AAPL","bx":"V","bp":149.5,"bs":3,"ax":"Q",)"
+        R"("ap":150.25,"as":2,"c":["R"],"z":"C",)"
+        R"("t":"2024-01-02T10:00:00.5Z"}])");
+
+    REQUIRE(viewSymbol      == "AAPL");
+    REQUIRE(viewAskExchange == "Q");
+    REQUIRE(viewTimestamp   == "2024-01-02T10:00:00.5Z");
+    REQUIRE(viewBid         == 149.5);
+    REQUIRE(viewNanos       == 1704189600500000000LL);
+
+    REQUIRE(owned.symbol    == "AAPL");
+    REQUIRE(owned.timestamp == "2024-01-02T10:00:00.5Z");
+    REQUIRE(owned.askPrice  == 150.25);
+    REQUIRE(owned.askSize   == 2);
+    REQUIRE(owned.bidSize   == 3);
+    REQUIRE(owned.time.EpochNanos() == viewNanos);
+}
+
+TEST_CASE("[MarketDataStream] frames with several messages and T not first", "[MarketDataStream]") {
+    TestEnvironment env;
+    alpaca::MarketDataSubscription sub;
+
+    std::vector<std::string> seen;
+    alpaca::MarketDataCallbacks cbs;
+    cbs.onTradeView = [&](const alpaca::StreamTradeView& t) {
+        seen.push_back("t:" + std::string(t.symbol));
+    };
+    cbs.onBarView = [&](const alpaca::StreamBarView& b) {
+        seen.push_back("b:" + std::string(b.symbol));
+    };
+
+    auto [stream, ws] = MakeStream(env, sub, cbs);
+    ws->Inject(
+        R"([{"T":"t","S":"AAPL","p":1.5,"s":10,"c":["@","I"],"x":"V","z":"C",)"
+        R"("t":"2024-01-02T10:00:00Z"},)"
+        R"({"T":"x_future","nested":{"a":[1,{"b":"}"}]}},)"
+        R"({"S":"MSFT","o":1,"h":2,"l":0.5,"c":1.5,"v":100,"n":3,"vw":1.2,)"
+        R"("t":"2024-01-02T10:01:00Z","T":"b"}])");
+
+    REQUIRE(seen == std::vector<std::string>{"t:AAPL", "b:MSFT"});
+}
+
+TEST_CASE("[MarketDataStream] malformed frame reports JSONParsing after earlier messages", "[MarketDataStream]") {
+    TestEnvironment env;
+    alpaca::MarketDataSubscription sub;
+
+    int trades = 0;
+    std::vector<alpaca::APIError> errors;
+    alpaca::MarketDataCallbacks cbs;
+    cbs.onTradeView = [&](const alpaca::StreamTradeView&) { ++trades; };
+    cbs.onError     = [&](alpaca::APIError e) { errors.push_back(e); };
+
+    auto [stream, ws] = MakeStream(env, sub, cbs);
+    ws->Inject(
+        R"([{"T":"t","S":"AAPL","p":1.5,"s":10,"t":"2024-01-02T10:00:00Z"},)"
+        R"({"T":"t","S":"AAPL","p":"oops"}])");
+    ws->Inject(R"([{"T":"t","S":"AAPL","t":"not a time"}])");
+    ws->Inject(R"({"T":"t")");
+
+    REQUIRE(trades == 1);
+    REQUIRE(errors.size() == 3);
+    for (const auto& e : errors) {
+        REQUIRE(e.code == alpaca::ErrorCode::JSONParsing);
+    }
+}
+
+TEST_CASE("[MarketDataStream] events carry interned symbol ids", "[MarketDataStream]") {
+    TestEnvironment env;
+    alpaca::MarketDataSubscription sub;
+    sub.quotes = {"AAPL", "MSFT"};
+
+    std::vector<alpaca::SymbolId> viewIds;
+    alpaca::SymbolId ownedId = alpaca::kNoSymbol;
+    alpaca::MarketDataCallbacks cbs;
+    cbs.onQuoteView = [&](const alpaca::StreamQuoteView& q) {
+        viewIds.push_back(q.symbolId);
+    };
+    cbs.onQuote = [&](alpaca::StreamQuote q) { ownedId = q.symbolId; };
+
+    alpaca::SymbolTable table;
+    FakeWebSocket fakeWs;
+    auto ws = fakeWs.state;
+    TestStream stream(env, std::move(fakeWs));
+    stream.UseSymbolTable(table);
+    stream.Connect(sub, cbs);
+
+    // Subscribed symbols are interned before any event arrives.
+    REQUIRE(table.Size() == 2);
+    REQUIRE(table.Find("AAPL") == 0u);
+    REQUIRE(table.Find("MSFT") == 1u);
+
+    ws->Inject(
+        R"([{"T":"q","S":"MSFT","ap":1,"bp":1,"t":"2024-01-02T10:00:00Z"},)"
+        R"({"T":"q","S":"NVDA","ap":1,"bp":1,"t":"2024-01-02T10:00:00Z"}])");
+
+    REQUIRE(viewIds == std::vector<alpaca::SymbolId>{1, 2});
+    REQUIRE(ownedId == 2);
+    REQUIRE(&stream.Symbols() == &table);
+    REQUIRE(table.Name(2) == "NVDA");
+}
+
+TEST_CASE("[MarketDataStream] queued delivery hands compact events to Poll", "[MarketDataStream]") {
+    TestEnvironment env;
+    alpaca::MarketDataSubscription sub;
+    sub.trades = {"AAPL"};
+    sub.quotes = {"AAPL"};
+
+    bool inlineCalled = false;
+    alpaca::MarketDataCallbacks cbs;
+    cbs.onTrade = [&](alpaca::StreamTrade) { inlineCalled = true; };
+    cbs.onQuoteView = [&](const alpaca::StreamQuoteView&) { inlineCalled = true; };
+
+    alpaca::SymbolTable table;
+    FakeWebSocket fakeWs;
+    auto ws = fakeWs.state;
+    TestStream stream(env, std::move(fakeWs));
+    stream.UseSymbolTable(table);
+    alpaca::MarketDataDelivery delivery;
+    delivery.mode = alpaca::DeliveryMode::Queued;
+    stream.Connect(sub, cbs, delivery);
+
+    REQUIRE_FALSE(stream.Poll().has_value());
+    ws->Inject(
+        R"([{"T":"t","S":"AAPL","p":189.5,"s":100,"t":"2024-01-02T10:00:00Z"},)"
+        R"({"T":"q","S":"AAPL","ap":190,"bp":189,"as":3,"bs":4,"t":"2024-01-02T10:00:01Z"}])");
+    REQUIRE_FALSE(inlineCalled);
+    REQUIRE(stream.Stats().queued == 2);
+
+    auto first = stream.Poll();
+    REQUIRE(first.has_value());
+    const auto* trade = std::get_if<alpaca::TradeEvent>(&*first);
+    REQUIRE(trade != nullptr);
+    REQUIRE(table.Name(trade->symbolId) == "AAPL");
+    REQUIRE(trade->price == 189.5);
+    REQUIRE(trade->size == 100);
+
+    std::vector<alpaca::QuoteEvent> quotes;
+    const auto n = stream.Drain([&](const alpaca::MarketDataEvent& e) {
+        quotes.push_back(std::get<alpaca::QuoteEvent>(e));
+    });
+    REQUIRE(n == 1);
+    REQUIRE(quotes[0].askPrice == 190);
+    REQUIRE(quotes[0].bidSize == 4);
+    REQUIRE(stream.Stats().enqueued == 2);
+    REQUIRE(stream.Stats().dropped == 0);
+}
+
+TEST_CASE("[MarketDataStream] queued delivery overflow policies", "[MarketDataStream]") {
+    TestEnvironment env;
+    alpaca::MarketDataSubscription sub;
+    sub.trades = {"AAPL"};
+
+    const std::string frame =
+        R"([{"T":"t","S":"AAPL","p":1,"s":1,"t":"2024-01-02T10:00:00Z"},)"
+        R"({"T":"t","S":"AAPL","p":2,"s":1,"t":"2024-01-02T10:00:00Z"},)"
+        R"({"T":"t","S":"AAPL","p":3,"s":1,"t":"2024-01-02T10:00:00Z"}])";
+
+    auto run = [&](alpaca::OverflowPolicy policy) {
+        FakeWebSocket fakeWs;
+        auto ws = fakeWs.state;
+        auto stream = std::make_unique<TestStream>(env, std::move(fakeWs));
+        alpaca::MarketDataDelivery delivery;
+        delivery.mode = alpaca::DeliveryMode::Queued;
+        delivery.capacity = 2;
+        delivery.overflow = policy;
+        stream->Connect(sub, {}, delivery);
+        ws->Inject(frame);
+
+        std::vector<double> prices;
+        stream->Drain([&](const alpaca::MarketDataEvent& e) {
+            prices.push_back(std::get<alpaca::TradeEvent>(e).price);
+        });
+        REQUIRE(stream->Stats().dropped == 1);
+        return prices;
+    };
+
+    REQUIRE(run(alpaca::OverflowPolicy::DropNewest) == std::vector<double>{1, 2});
+    REQUIRE(run(alpaca::OverflowPolicy::DropOldest) == std::vector<double>{2, 3});
+}
+
+TEST_CASE("[MarketDataStream] Connect keeps the queue a consumer is polling", "[MarketDataStream]") {
+    TestEnvironment env;
+    alpaca::MarketDataSubscription sub;
+    sub.trades = {"AAPL"};
+    const std::string frame =
+        R"([{"T":"t","S":"AAPL","p":1,"s":1,"t":"2024-01-02T10:00:00Z"}])";
+
+    FakeWebSocket fakeWs;
+    auto ws = fakeWs.state;
+    TestStream stream(env, std::move(fakeWs));
+    alpaca::MarketDataDelivery delivery;
+    delivery.mode = alpaca::DeliveryMode::Queued;
+    delivery.capacity = 64;
+    stream.Connect(sub, {}, delivery);
+
+    // The consumer keeps polling while the stream is connected again.
+    constexpr int kRounds = 20;
+    std::atomic<int> seen{0};
+    std::thread consumer([&] {
+        while (seen < kRounds) {
+            seen += static_cast<int>(
+                stream.Drain([](const alpaca::MarketDataEvent&) {}));
+        }
+    });
+    delivery.capacity = 2;
+    for (int i = 0; i < kRounds; ++i) {
+        ws->Inject(frame);
+        stream.Disconnect();
+        stream.Connect(sub, {}, delivery);
+    }
+    consumer.join();
+
+    REQUIRE(seen == kRounds);
+    REQUIRE(stream.Stats().enqueued == kRounds);
+    // The first ring is still in use, so none of the events was dropped.
+    REQUIRE(stream.Stats().dropped == 0);
+}
+
+TEST_CASE("[MarketDataStream] Stats and Subscription can be read during Connect", "[MarketDataStream]") {
+    TestEnvironment env;
+    alpaca::MarketDataSubscription sub;
+    sub.trades = {"AAPL"};
+    sub.quotes = {"AAPL"};
+
+    FakeWebSocket fakeWs;
+    auto ws = fakeWs.state;
+    TestStream stream(env, std::move(fakeWs));
+    alpaca::MarketDataDelivery delivery;
+    delivery.mode = alpaca::DeliveryMode::Conflated;
+
+    // A monitoring thread, as an application's health check would be.
+    std::atomic<bool> done{false};
+    std::thread monitor([&] {
+        while (!done) {
+            (void)stream.Stats();
+            (void)stream.Subscription();
+        }
+    });
+    stream.Connect(sub, {}, delivery);
+    ws->Inject(R"([{"T":"q","S":"AAPL","ap":2,"bp":1,"as":1,"bs":1,"t":"2024-01-02T10:00:00Z"}])");
+    done = true;
+    monitor.join();
+
+    REQUIRE(stream.Stats().queued == 1);
+}
+
+TEST_CASE("[MarketDataStream] conflated delivery keeps the latest quote per symbol", "[MarketDataStream]") {
+    TestEnvironment env;
+    alpaca::MarketDataSubscription sub;
+    sub.trades = {"AAPL"};
+    sub.quotes = {"AAPL", "MSFT"};
+
+    alpaca::SymbolTable table;
+    FakeWebSocket fakeWs;
+    auto ws = fakeWs.state;
+    TestStream stream(env, std::move(fakeWs));
+    stream.UseSymbolTable(table);
+    alpaca::MarketDataDelivery delivery;
+    delivery.mode = alpaca::DeliveryMode::Conflated;
+    stream.Connect(sub, {}, delivery);
+
+    ws->Inject(
+        R"([{"T":"q","S":"AAPL","ap":1,"bp":1,"t":"2024-01-02T10:00:00Z"},)"
+        R"({"T":"q","S":"MSFT","ap":5,"bp":5,"t":"2024-01-02T10:00:00Z"},)"
+        R"({"T":"t","S":"AAPL","p":1.5,"s":10,"t":"2024-01-02T10:00:00Z"},)"
+        R"({"T":"q","S":"AAPL","ap":2,"bp":2,"t":"2024-01-02T10:00:01Z"},)"
+        R"({"T":"q","S":"AAPL","ap":3,"bp":3,"t":"2024-01-02T10:00:02Z"}])");
+
+    REQUIRE(stream.Stats().coalesced == 2);
+    REQUIRE(stream.Stats().queued == 3);
+
+    std::vector<alpaca::MarketDataEvent> events;
+    stream.Drain([&](const alpaca::MarketDataEvent& e) { events.push_back(e); });
+    REQUIRE(events.size() == 3);
+
+    // Trades are never conflated and come first.
+    REQUIRE(std::get<alpaca::TradeEvent>(events[0]).price == 1.5);
+    const auto& aapl = std::get<alpaca::QuoteEvent>(events[1]);
+    REQUIRE(table.Name(aapl.symbolId) == "AAPL");
+    REQUIRE(aapl.askPrice == 3);
+    REQUIRE(aapl.coalesced == 2);
+    const auto& msft = std::get<alpaca::QuoteEvent>(events[2]);
+    REQUIRE(table.Name(msft.symbolId) == "MSFT");
+    REQUIRE(msft.coalesced == 0);
+
+    REQUIRE_FALSE(stream.Poll().has_value());
+    REQUIRE(stream.Stats().enqueued == 5);
+}
+
+TEST_CASE("[MarketDataStream] reconnect replays auth and subscription", "[MarketDataStream]") {
+    TestEnvironment env;
+    alpaca::MarketDataSubscription sub;
+    sub.trades = {"AAPL"};
+
+    int disconnects = 0;
+    std::vector<alpaca::ReconnectGap> gaps;
+    alpaca::MarketDataCallbacks cbs;
+    cbs.onDisconnected = [&] { ++disconnects; };
+    cbs.onReconnected = [&](const alpaca::ReconnectGap& g) { gaps.push_back(g); };
+
+    FakeWebSocket fakeWs;
+    auto ws = fakeWs.state;
+    TestStream stream(env, std::move(fakeWs));
+    alpaca::ReconnectPolicy policy;
+    policy.baseBackoff = std::chrono::milliseconds{1};
+    stream.SetReconnectPolicy(policy);
+    stream.Connect(sub, cbs);
+    ws->Inject(R"([{"T":"success","msg":"connected"}])");
+    ws->Inject(R"([{"T":"success","msg":"authenticated"}])");
+    ws->Inject(R"([{"T":"subscription","trades":["AAPL"]}])");
+    REQUIRE(ws->sent.size() == 2);
+
+    ws->Drop();
+    REQUIRE(disconnects == 1);
+    while (ws->connects < 2) std::this_thread::yield();
+
+    ws->Inject(R"([{"T":"success","msg":"connected"}])");
+    ws->Inject(R"([{"T":"success","msg":"authenticated"}])");
+    REQUIRE(ws->sent.size() == 4);
+    REQUIRE(ws->sent[3] == ws->sent[1]);
+    REQUIRE(gaps.empty());
+    ws->Inject(R"([{"T":"subscription","trades":["AAPL"]}])");
+
+    REQUIRE(gaps.size() == 1);
+    REQUIRE(gaps[0].attempts == 1);
+    REQUIRE(gaps[0].up >= gaps[0].down);
+    const auto stats = stream.GetReconnectStats();
+    REQUIRE(stats.disconnects == 1);
+    REQUIRE(stats.reconnects == 1);
+    REQUIRE(stats.lastGap == gaps[0].duration);
+}
+
+TEST_CASE("[MarketDataStream] no reconnect after Disconnect or when disabled", "[MarketDataStream]") {
+    TestEnvironment env;
+    alpaca::MarketDataSubscription sub;
+    sub.trades = {"AAPL"};
+    alpaca::ReconnectPolicy policy;
+    policy.baseBackoff = std::chrono::milliseconds{1};
+
+    FakeWebSocket first;
+    auto ws1 = first.state;
+    TestStream closed(env, std::move(first));
+    closed.SetReconnectPolicy(policy);
+    closed.Connect(sub, {});
+    closed.Disconnect();
+
+    policy.enabled = false;
+    FakeWebSocket second;
+    auto ws2 = second.state;
+    TestStream disabled(env, std::move(second));
+    disabled.SetReconnectPolicy(policy);
+    disabled.Connect(sub, {});
+    ws2->Drop();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+    REQUIRE(ws1->connects == 1);
+    REQUIRE(ws2->connects == 1);
+    REQUIRE(disabled.GetReconnectStats().disconnects == 0);
+}
+
+TEST_CASE("[MarketDataStream] running out of reconnect attempts is reported once", "[MarketDataStream]") {
+    TestEnvironment env;
+    alpaca::MarketDataSubscription sub;
+    sub.trades = {"AAPL"};
+
+    std::vector<alpaca::APIError> errors;
+    alpaca::MarketDataCallbacks cbs;
+    cbs.onError = [&](const alpaca::APIError& e) { errors.push_back(e); };
+
+    FakeWebSocket fakeWs;
+    auto ws = fakeWs.state;
+    TestStream stream(env, std::move(fakeWs));
+    alpaca::ReconnectPolicy policy;
+    policy.baseBackoff = std::chrono::milliseconds{1};
+    policy.maxAttempts = 1;
+    stream.SetReconnectPolicy(policy);
+    stream.Connect(sub, cbs);
+    ws->Inject(R"([{"T":"success","msg":"connected"}])");
+
+    ws->Drop();
+    while (ws->connects < 2) std::this_thread::yield();
+    REQUIRE(errors.empty());
+
+    // The only attempt fails too; later closes are not reported again.
+    ws->Drop();
+    ws->Drop();
+    REQUIRE(errors.size() == 1);
+    REQUIRE(errors[0].code == alpaca::ErrorCode::Connection);
+    REQUIRE(errors[0].message == "Reconnect attempts exhausted");
+    REQUIRE(stream.GetReconnectStats().gaveUp);
+}
+
+TEST_CASE("[MarketDataStream] Disconnect from onDisconnected during a reconnect attempt", "[MarketDataStream]") {
+    TestEnvironment env;
+    alpaca::MarketDataSubscription sub;
+    sub.trades = {"AAPL"};
+
+    FakeWebSocket fakeWs;
+    auto ws = fakeWs.state;
+    TestStream stream(env, std::move(fakeWs));
+    alpaca::ReconnectPolicy policy;
+    policy.baseBackoff = std::chrono::milliseconds{1};
+    stream.SetReconnectPolicy(policy);
+
+    std::atomic<int> disconnects{0};
+    alpaca::MarketDataCallbacks cbs;
+    cbs.onDisconnected = [&] {
+        // The second close arrives while the attempt is stuck in Connect.
+        if (++disconnects == 2) stream.Disconnect();
+    };
+    stream.Connect(sub, cbs);
+    ws->holdConnect = true;
+
+    // This thread plays the socket thread, which the attempt waits for.
+    std::atomic<bool> done{false};
+    std::thread socket([&] {
+        ws->Drop();
+        while (!ws->inConnect) std::this_thread::yield();
+        ws->Drop();
+        done = true;
+        ws->release = true;
+    });
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+    while (!done && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+    REQUIRE(done);
+    socket.join();
+
+    // The attempt finished its Connect, saw the cancel and closed again.
+    while (ws->connects < 2) std::this_thread::yield();
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+    REQUIRE_FALSE(ws->connected);
+    REQUIRE(ws->connects == 2);
+}
+
+TEST_CASE("[MarketDataStream] Subscribe and Unsubscribe send only the difference", "[MarketDataStream]") {
+    TestEnvironment env;
+    alpaca::MarketDataSubscription sub;
+    sub.trades = {"AAPL"};
+    sub.quotes = {"AAPL"};
+
+    auto [stream, ws] = MakeStream(env, sub, {});
+
+    // Before authentication the change only updates the pending set.
+    alpaca::MarketDataSubscription add;
+    add.quotes = {"MSFT"};
+    REQUIRE(stream->Subscribe(add));
+    REQUIRE(ws->sent.empty());
+
+    ws->Inject(R"([{"T":"success","msg":"connected"}])");
+    ws->Inject(R"([{"T":"success","msg":"authenticated"}])");
+    REQUIRE(ws->sent.size() == 2);
+    REQUIRE_THAT(ws->sent[1], Catch::Matchers::ContainsSubstring(R"("quotes":["AAPL","MSFT"])"));
+
+    add.trades = {"AAPL", "NVDA"};
+    add.quotes = {"MSFT"};
+    REQUIRE(stream->Subscribe(add));
+    REQUIRE(ws->sent.size() == 3);
+    REQUIRE(ws->sent[2] ==
+            R"({"action":"subscribe","trades":["NVDA"],"quotes":[],"bars":[]})");
+    REQUIRE_FALSE(stream->Subscribe(add));
+    REQUIRE(ws->sent.size() == 3);
+
+    alpaca::MarketDataSubscription remove;
+    remove.quotes = {"AAPL", "TSLA"};
+    REQUIRE(stream->Unsubscribe(remove));
+    REQUIRE(ws->sent.back() ==
+            R"({"action":"unsubscribe","trades":[],"quotes":["AAPL"],"bars":[]})");
+    REQUIRE_FALSE(stream->Unsubscribe(remove));
+
+    const auto want = stream->Subscription();
+    REQUIRE(want.trades == std::vector<std::string>{"AAPL", "NVDA"});
+    REQUIRE(want.quotes == std::vector<std::string>{"MSFT"});
+    REQUIRE(stream->Symbols().Find("NVDA").has_value());
+}
+
+TEST_CASE("[MarketDataStream] subscription messages update the confirmed set", "[MarketDataStream]") {
+    TestEnvironment env;
+    alpaca::MarketDataSubscription sub;
+    sub.trades = {"AAPL"};
+
+    auto [stream, ws] = MakeStream(env, sub, {});
+    REQUIRE(stream->ConfirmedSubscription().trades.empty());
+
+    ws->Inject(R"([{"T":"subscription","trades":["AAPL","MSFT"],"quotes":[],"bars":["SPY"]}])");
+    auto confirmed = stream->ConfirmedSubscription();
+    REQUIRE(confirmed.trades == std::vector<std::string>{"AAPL", "MSFT"});
+    REQUIRE(confirmed.quotes.empty());
+    REQUIRE(confirmed.bars == std::vector<std::string>{"SPY"});
+
+    ws->Inject(R"([{"T":"subscription","trades":[],"quotes":[],"bars":[]}])");
+    REQUIRE(stream->ConfirmedSubscription().bars.empty());
+}
+
+TEST_CASE("[MarketDataStream] msgpack encoding sends binary control messages and decodes binary frames", "[MarketDataStream]") {
+    TestEnvironment env;
+    alpaca::MarketDataSubscription sub;
+    sub.trades = {"AAPL"};
+
+    std::vector<alpaca::StreamTrade> trades;
+    bool connected = false;
+    alpaca::MarketDataCallbacks cbs;
+    cbs.onTrade = [&](alpaca::StreamTrade t) { trades.push_back(std::move(t)); };
+    cbs.onConnected = [&] { connected = true; };
+
+    FakeWebSocket fakeWs;
+    auto ws = fakeWs.state;
+    TestStream stream(env, std::move(fakeWs));
+    stream.SetEncoding(alpaca::StreamEncoding::Msgpack);
+    stream.Connect(sub, cbs);
+    REQUIRE(ws->headers["Content-Type"] == "application/msgpack");
+
+    auto control = [](std::string_view msg) {
+        std::string out;
+        alpaca::detail::MsgpackWriter w(out);
+        w.Array(1);
+        w.Map(2);
+        w.String("T");
+        w.String("success");
+        w.String("msg");
+        w.String(msg);
+        return out;
+    };
+    ws->Inject(control("connected"));
+    REQUIRE(ws->sent.size() == 1);
+    REQUIRE(ws->sent[0] == alpaca::detail::EncodeMsgpackAuth("TEST_KEY", "TEST_SECRET"));
+    ws->Inject(control("authenticated"));
+    REQUIRE(connected);
+    REQUIRE(ws->sent.size() == 2);
+    REQUIRE(ws->sent[1] == alpaca::detail::EncodeMsgpackAction("subscribe", sub));
+
+    std::string frame;
+    alpaca::detail::MsgpackWriter w(frame);
+    w.Array(1);
+    w.Map(4);
+    w.String("T");
+    w.String("t");
+    w.String("S");
+    w.String("AAPL");
+    w.String("s");
+    frame += static_cast<char>(100); // positive fixint
+    w.String("t");
+    frame += std::string("\xd6\xff\x65\x94\x0e\xa0", 6); // 2024-01-02T13:24:48Z
+    ws->Inject(frame);
+
+    REQUIRE(trades.size() == 1);
+    REQUIRE(trades[0].symbol == "AAPL");
+    REQUIRE(trades[0].size == 100);
+    REQUIRE(trades[0].time.EpochNanos() == 1704201888000000000);
+    REQUIRE(trades[0].timestamp.starts_with("2024-01-02T13:24:48"));
+}
+
+TEST_CASE("[MarketDataStream] instrumentation records decode and callback times", "[MarketDataStream]") {
+    TestEnvironment env;
+    alpaca::MarketDataSubscription sub;
+    sub.trades = {"AAPL"};
+
+    int trades = 0;
+    alpaca::MarketDataCallbacks cbs;
+    cbs.onTrade = [&](alpaca::StreamTrade) { ++trades; };
+
+    FakeWebSocket fakeWs;
+    auto ws = fakeWs.state;
+    TestStream stream(env, std::move(fakeWs));
+    alpaca::Instrumentation in;
+    stream.SetInstrumentation(&in);
+    stream.Connect(sub, cbs);
+
+    ws->Inject(R"([{"T":"success","msg":"connected"}])");
+    ws->Inject(R"([{"T":"success","msg":"authenticated"}])");
+    ws->Inject(R"([{"T":"subscription","trades":["AAPL"]}])");
+    REQUIRE(in.Snapshot().empty());
+
+    ws->Inject(
+        R"([{"T":"t","S":"AAPL","p":1,"s":1,"t":"2024-01-02T10:00:00Z"},)"
+        R"({"T":"t","S":"AAPL","p":2,"s":1,"t":"2024-01-02T10:00:01Z"}])");
+    REQUIRE(trades == 2);
+
+    auto snap = in.Snapshot();
+    REQUIRE(snap.at("md.decode trade").count == 2);
+    REQUIRE(snap.at("md.callback trade").count == 2);
+    REQUIRE(snap.count("md.decode quote") == 0);
+}
+
+TEST_CASE("[MarketDataStream] receive time reaches every event and feeds the lag histograms", "[MarketDataStream]") {
+    using namespace std::chrono_literals;
+    TestEnvironment env;
+    alpaca::MarketDataSubscription sub;
+    sub.trades = {"AAPL"};
+    sub.feed = "sip";
+
+    // Received 5ms after the exchange stamped it.
+    const auto exchange = *alpaca::Timestamp::Parse("2024-01-02T10:00:00Z");
+    alpaca::ReceiveTime at;
+    at.mono = std::chrono::steady_clock::now();
+    at.wall = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
+        exchange.time + 5ms);
+    const std::string frame =
+        R"([{"T":"t","S":"AAPL","p":1,"s":1,"t":"2024-01-02T10:00:00Z"}])";
+
+    alpaca::Instrumentation in;
+
+    SECTION("inline") {
+        alpaca::ReceiveTime viewAt, ownedAt;
+        alpaca::MarketDataCallbacks cbs;
+        cbs.onTradeView = [&](const alpaca::StreamTradeView& v) { viewAt = v.received; };
+        cbs.onTrade = [&](alpaca::StreamTrade t) { ownedAt = t.received; };
+
+        FakeWebSocket fakeWs;
+        auto ws = fakeWs.state;
+        TestStream stream(env, std::move(fakeWs));
+        stream.SetInstrumentation(&in);
+        stream.Connect(sub, cbs);
+        ws->InjectAt(frame, at);
+
+        REQUIRE(viewAt.mono == at.mono);
+        REQUIRE(viewAt.wall == at.wall);
+        REQUIRE(ownedAt.mono == at.mono);
+        REQUIRE(stream.LastFrameTime() == at.mono);
+    }
+
+    SECTION("queued") {
+        FakeWebSocket fakeWs;
+        auto ws = fakeWs.state;
+        TestStream stream(env, std::move(fakeWs));
+        stream.SetInstrumentation(&in);
+        alpaca::MarketDataDelivery delivery;
+        delivery.mode = alpaca::DeliveryMode::Queued;
+        stream.Connect(sub, {}, delivery);
+        ws->InjectAt(frame, at);
+        REQUIRE(in.Snapshot().count("md.lag.callback sip") == 0);
+
+        auto e = stream.Poll();
+        REQUIRE(e.has_value());
+        REQUIRE(std::get<alpaca::TradeEvent>(*e).received.mono == at.mono);
+    }
+
+    auto snap = in.Snapshot();
+    const auto& exchangeLag = snap.at("md.lag.exchange sip");
+    REQUIRE(exchangeLag.count == 1);
+    REQUIRE(exchangeLag.max >= 5000000);
+    REQUIRE(exchangeLag.max <= 5000000 + 5000000 / 32);
+    REQUIRE(snap.at("md.lag.callback sip").count == 1);
+}
+
+TEST_CASE("[MarketDataStream] frames from a Ws without timestamps are stamped on arrival", "[MarketDataStream]") {
+    TestEnvironment env;
+    alpaca::MarketDataSubscription sub;
+    sub.trades = {"AAPL"};
+
+    alpaca::ReceiveTime received;
+    alpaca::MarketDataCallbacks cbs;
+    cbs.onTradeView = [&](const alpaca::StreamTradeView& v) { received = v.received; };
+
+    auto [stream, ws] = MakeStream(env, sub, cbs);
+    const auto before = std::chrono::steady_clock::now();
+    ws->Inject(R"([{"T":"t","S":"AAPL","p":1,"s":1,"t":"2024-01-02T10:00:00Z"}])");
+
+    REQUIRE(received.mono >= before);
+    REQUIRE(received.mono <= std::chrono::steady_clock::now());
+    REQUIRE(received.wall != std::chrono::system_clock::time_point{});
+}
+
+TEST_CASE("[MarketDataStream] destroying a connected stream closes the socket first", "[MarketDataStream]") {
+    TestEnvironment env;
+    alpaca::MarketDataSubscription sub;
+    sub.trades = {"AAPL"};
+    int disconnects = 0;
+    alpaca::MarketDataCallbacks cbs;
+    cbs.onDisconnected = [&] { ++disconnects; };
+
+    auto h = MakeStream(env, sub, cbs);
+    h.ws->Inject(R"([{"T":"success","msg":"connected"}])");
+    h.ws->Inject(R"([{"T":"success","msg":"authenticated"}])");
+    h.stream.reset();
+
+    REQUIRE_FALSE(h.ws->connected);
+    REQUIRE(disconnects == 1);
+    REQUIRE(h.ws->connects == 1);
+}
@@ -0,0 +1,183 @@
+#include <alpaca/models/streaming/msgpack.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <bit>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Appends msgpack values the SDK itself never writes.
+struct Packer {
+  std::string out;
+  alpaca::detail::MsgpackWriter w{out};
+
+  void BE(uint64_t v, int bytes) {
+    for (int i = bytes - 1; i >= 0; --i) {
+      out += static_cast<char>((v >> (8 * i)) & 0xff);
+    }
+  }
+  void Str(std::string_view s) { w.String(s); }
+  void F64(double d) {
+    out += static_cast<char>(0xcb);
+    BE(std::bit_cast<uint64_t>(d), 8);
+  }
+  void U32(uint32_t v) {
+    out += static_cast<char>(0xce);
+    BE(v, 4);
+  }
+  void Fix(int v) { out += static_cast<char>(v); }
+  // Timestamp extension, 64-bit form.
+  void Time64(uint64_t sec, uint32_t nsec) {
+    out += static_cast<char>(0xd7);
+    out += static_cast<char>(0xff);
+    BE((uint64_t{nsec} << 34) | sec, 8);
+  }
+};
+
+struct Recorder {
+  std::vector<alpaca::StreamTrade> trades;
+  std::vector<alpaca::StreamQuote> quotes;
+  std::vector<std::string> control;
+  std::vector<std::string> subscribedQuotes;
+
+  void OnTrade(const alpaca::StreamTradeView& v) {
+    alpaca::StreamTrade t;
+    t.symbol = v.symbol;
+    t.exchange = v.exchange;
+    t.price = v.price;
+    t.size = v.size;
+    t.time = v.time;
+    trades.push_back(t);
+  }
+  void OnQuote(const alpaca::StreamQuoteView& v) {
+    alpaca::StreamQuote q;
+    q.symbol = v.symbol;
+    q.bidPrice = v.bidPrice;
+    q.askSize = v.askSize;
+    quotes.push_back(q);
+  }
+  void OnBar(const alpaca::StreamBarView&) {}
+  void OnControl(const alpaca::StreamControlView& c) {
+    control.emplace_back(c.type);
+    if (!c.quotes.empty()) {
+      REQUIRE(c.encoding == alpaca::StreamEncoding::Msgpack);
+      REQUIRE(alpaca::detail::ReadMsgpackStringList(c.quotes,
+                                                    subscribedQuotes));
+    }
+  }
+};
+
+} // namespace
+
+TEST_CASE("Msgpack: trades, quotes and control messages decode to views") {
+  Packer p;
+  p.w.Array(3);
+
+  p.w.Map(7);
+  p.Str("T");
+  p.Str("t");
+  p.Str("S");
+  p.Str("AAPL");
+  p.Str("p");
+  p.F64(189.25);
+  p.Str("s");
+  p.U32(70000);
+  p.Str("x");
+  p.Str("V");
+  p.Str("c"); // conditions: skipped
+  p.w.Strings({"@", "I"});
+  p.Str("t");
+  p.Time64(1704189600, 123456789);
+
+  // "T" not first, negative fixint in an unknown key.
+  p.w.Map(4);
+  p.Str("bp");
+  p.F64(100.5);
+  p.Str("z");
+  p.Fix(0xff);
+  p.Str("T");
+  p.Str("q");
+  p.Str("S");
+  p.Str("MSFT");
+
+  p.w.Map(3);
+  p.Str("T");
+  p.Str("subscription");
+  p.Str("quotes");
+  p.w.Strings({"MSFT", "NVDA"});
+  p.Str("trades");
+  p.w.Strings({});
+
+  Recorder r;
+  REQUIRE_FALSE(alpaca::DecodeMarketDataMsgpack(p.out, r).has_value());
+
+  REQUIRE(r.trades.size() == 1);
+  REQUIRE(r.trades[0].symbol == "AAPL");
+  REQUIRE(r.trades[0].exchange == "V");
+  REQUIRE(r.trades[0].price == 189.25);
+  REQUIRE(r.trades[0].size == 70000);
+  REQUIRE(r.trades[0].time.EpochNanos() == 1704189600123456789);
+
+  REQUIRE(r.quotes.size() == 1);
+  REQUIRE(r.quotes[0].symbol == "MSFT");
+  REQUIRE(r.quotes[0].bidPrice == 100.5);
+
+  REQUIRE(r.control == std::vector<std::string>{"subscription"});
+  REQUIRE(r.subscribedQuotes == std::vector<std::string>{"MSFT", "NVDA"});
+}
+
+TEST_CASE("Msgpack: truncated or mistyped frames are rejected") {
+  Packer p;
+  p.w.Array(1);
+  p.w.Map(2);
+  p.Str("T");
+  p.Str("t");
+  p.Str("p");
+  p.Str("not a number");
+
+  Recorder r;
+  auto err = alpaca::DecodeMarketDataMsgpack(p.out, r);
+  REQUIRE(err.has_value());
+  REQUIRE(err->starts_with("Malformed market data frame"));
+
+  Packer q;
+  q.w.Array(1);
+  q.w.Map(2);
+  q.Str("T");
+  q.Str("t");
+  q.Str("p");
+  q.out += static_cast<char>(0xcb); // float64 with no payload
+  REQUIRE(alpaca::DecodeMarketDataMsgpack(q.out, r).has_value());
+  REQUIRE(r.trades.empty());
+}
+
+TEST_CASE("Msgpack: control messages encode as maps of strings") {
+  alpaca::MarketDataSubscription sub;
+  sub.trades = {"AAPL"};
+  const auto bytes = alpaca::detail::EncodeMsgpackAction("subscribe", sub);
+
+  alpaca::detail::MsgpackCursor cur(bytes);
+  uint32_t n = 0;
+  REQUIRE(cur.ReadMapHeader(n));
+  REQUIRE(n == 4);
+  std::string_view key;
+  std::string_view value;
+  REQUIRE(cur.ReadString(key));
+  REQUIRE(cur.ReadString(value));
+  REQUIRE(key == "action");
+  REQUIRE(value == "subscribe");
+
+  REQUIRE(cur.ReadString(key));
+  REQUIRE(key == "trades");
+  alpaca::WireValue list;
+  REQUIRE(cur.ReadValue(list));
+  std::vector<std::string> trades;
+  REQUIRE(alpaca::detail::ReadMsgpackStringList(list.text, trades));
+  REQUIRE(trades == std::vector<std::string>{"AAPL"});
+
+  const auto auth = alpaca::detail::EncodeMsgpackAuth("KEY", "SECRET");
+  REQUIRE(auth.size() == 1 + 7 + 5 + 4 + 4 + 7 + 7);
+}
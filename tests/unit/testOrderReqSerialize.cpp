@@ -1,3 +1,4 @@
+#include <alpaca/models/trading/orderTemplate.hpp>
 #include <alpaca/models/trading/serialize.hpp>
 
 #include <catch2/catch_approx.hpp>
@@ -40,7 +41,8 @@ TEST_CASE(
     "keys)") {
   auto req = base_req();
   req.amt = alpaca::Quantity{10};
-  req.trailAmt = alpaca::TrailAmount{alpaca::TrailPrice{0.25L}};
+  req.trailAmt =
+      alpaca::TrailAmount{alpaca::TrailPrice{alpaca::Decimal{0.25L}}};
 
   const auto json = write_json_or_fail(req);
 
@@ -73,7 +75,7 @@ TEST_CASE("Glaze boundary: Quantity -> JSON -> OrderRequestParam roundtrip") {
 
 TEST_CASE("Glaze boundary: Notional -> JSON -> OrderRequestParam roundtrip") {
   auto req = base_req();
-  req.amt = alpaca::Notional{250.50L};
+  req.amt = alpaca::Notional{alpaca::Decimal{250.50L}};
 
   const auto json = write_json_or_fail(req);
   const auto back = read_json_or_fail(json);
@@ -110,7 +112,8 @@ TEST_CASE("Glaze boundary: trail_price and trail_percent mapping roundtrips") {
   SECTION("trail_price") {
     auto req = base_req();
     req.amt = alpaca::Quantity{1};
-    req.trailAmt = alpaca::TrailAmount{alpaca::TrailPrice{0.25L}};
+    req.trailAmt =
+        alpaca::TrailAmount{alpaca::TrailPrice{alpaca::Decimal{0.25L}}};
 
     const auto json = write_json_or_fail(req);
     const auto back = read_json_or_fail(json);
@@ -128,7 +131,8 @@ TEST_CASE("Glaze boundary: trail_price and trail_percent mapping roundtrips") {
   SECTION("trail_percent") {
     auto req = base_req();
     req.amt = alpaca::Quantity{1};
-    req.trailAmt = alpaca::TrailAmount{alpaca::TrailPercent{1.5L}};
+    req.trailAmt =
+        alpaca::TrailAmount{alpaca::TrailPercent{alpaca::Decimal{1.5L}}};
 
     const auto json = write_json_or_fail(req);
     const auto back = read_json_or_fail(json);
@@ -143,3 +147,64 @@ TEST_CASE("Glaze boundary: trail_price and trail_percent mapping roundtrips") {
     REQUIRE(json.find("\"trail_price\"") == std::string::npos);
   }
 }
+
+TEST_CASE("OrderTemplate renders the same order as glaze") {
+  auto base = base_req();
+  base.type = alpaca::OrderType::limit;
+  base.timeInForce = alpaca::OrderTimeInForce::ioc;
+  base.extendedHours = true;
+  // Per-order fields of the base are not part of the template.
+  base.amt = alpaca::Notional{100};
+  base.clientOrderID = "ignored";
+
+  auto tmpl = alpaca::OrderTemplate::Make(base);
+  REQUIRE(tmpl.has_value());
+  REQUIRE(tmpl->Prefix().find("notional") == std::string_view::npos);
+  REQUIRE(tmpl->Prefix().find("ignored") == std::string_view::npos);
+
+  alpaca::OrderPatch patch;
+  patch.qty = *alpaca::Decimal::Parse("12");
+  patch.limitPrice = *alpaca::Decimal::Parse("187.35");
+  patch.clientOrderID = "mm-1";
+  const auto back = read_json_or_fail(tmpl->Render(patch));
+
+  REQUIRE(back.symbol == "AAPL");
+  REQUIRE(back.side == alpaca::OrderSide::buy);
+  REQUIRE(back.type == alpaca::OrderType::limit);
+  REQUIRE(back.timeInForce == alpaca::OrderTimeInForce::ioc);
+  REQUIRE(back.extendedHours == true);
+  REQUIRE(std::get<alpaca::Quantity>(back.amt).v == patch.qty);
+  REQUIRE(back.limitPrice == patch.limitPrice);
+  REQUIRE_FALSE(back.stopPrice.has_value());
+  REQUIRE(back.clientOrderID == "mm-1");
+}
+
+TEST_CASE("OrderTemplate reuses its buffer across renders") {
+  auto tmpl = alpaca::OrderTemplate::Make(base_req());
+  REQUIRE(tmpl.has_value());
+
+  alpaca::OrderPatch patch;
+  patch.qty = 1;
+  const auto *data = tmpl->Render(patch).data();
+  patch.qty = 2;
+  patch.stopPrice = *alpaca::Decimal::Parse("99.5");
+  const auto &json = tmpl->Render(patch);
+
+  REQUIRE(json.data() == data);
+  REQUIRE(json.find("\"client_order_id\"") == std::string::npos);
+  const auto back = read_json_or_fail(json);
+  REQUIRE(std::get<alpaca::Quantity>(back.amt).v == 2);
+  REQUIRE(back.stopPrice == patch.stopPrice);
+}
+
+TEST_CASE("OrderTemplate escapes the client order id") {
+  auto tmpl = alpaca::OrderTemplate::Make(base_req());
+  REQUIRE(tmpl.has_value());
+
+  alpaca::OrderPatch patch;
+  patch.qty = 1;
+  patch.clientOrderID = "a\"b\\c\n";
+  const auto back = read_json_or_fail(tmpl->Render(patch));
+
+  REQUIRE(back.clientOrderID == "a\"b\\c\n");
+}
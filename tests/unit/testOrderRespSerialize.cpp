@@ -44,7 +44,7 @@ TEST_CASE(
   REQUIRE(r.updatedAt == "2026-01-07T10:00:01Z");
   REQUIRE(r.submittedAt == "2026-01-07T10:00:02Z");
 
-  REQUIRE(r.filledQty == "0");
+  REQUIRE(r.filledQty.ToString() == "0");
   REQUIRE(r.orderType == "market");
   REQUIRE(r.type == alpaca::OrderType::market);
   REQUIRE(r.side == alpaca::OrderSide::buy);
@@ -118,13 +118,13 @@ TEST_CASE("Glaze OrderResponse: optionals parse when present") {
   REQUIRE(*r.assetClass == "us_equity");
 
   REQUIRE(r.notional.has_value());
-  REQUIRE(*r.notional == "250.50");
+  REQUIRE(r.notional->ToString() == "250.50");
   REQUIRE(r.qty.has_value());
-  REQUIRE(*r.qty == "10");
+  REQUIRE(r.qty->ToString() == "10");
 
-  REQUIRE(r.filledQty == "10");
+  REQUIRE(r.filledQty.ToString() == "10");
   REQUIRE(r.filledAvgPrice.has_value());
-  REQUIRE(*r.filledAvgPrice == "251.01");
+  REQUIRE(r.filledAvgPrice->ToString() == "251.01");
 
   REQUIRE(r.orderClass.has_value());
   REQUIRE(*r.orderClass == "simple");
@@ -135,9 +135,9 @@ TEST_CASE("Glaze OrderResponse: optionals parse when present") {
   REQUIRE(r.timeInForce == alpaca::OrderTimeInForce::day);
 
   REQUIRE(r.limitPrice.has_value());
-  REQUIRE(*r.limitPrice == "0");
+  REQUIRE(r.limitPrice->ToString() == "0");
   REQUIRE(r.stopPrice.has_value());
-  REQUIRE(*r.stopPrice == "0");
+  REQUIRE(r.stopPrice->ToString() == "0");
 
   REQUIRE(r.status == "filled");
 
@@ -147,11 +147,11 @@ TEST_CASE("Glaze OrderResponse: optionals parse when present") {
   REQUIRE(r.extendedHours == true);
 
   REQUIRE(r.trailPercent.has_value());
-  REQUIRE(*r.trailPercent == "1.5");
+  REQUIRE(r.trailPercent->ToString() == "1.5");
   REQUIRE(r.trailPrice.has_value());
-  REQUIRE(*r.trailPrice == "0.25");
+  REQUIRE(r.trailPrice->ToString() == "0.25");
   REQUIRE(r.hwm.has_value());
-  REQUIRE(*r.hwm == "123.45");
+  REQUIRE(r.hwm->ToString() == "123.45");
 
   REQUIRE(r.subtag.has_value());
   REQUIRE(*r.subtag == "test");
@@ -172,8 +172,8 @@ TEST_CASE("Glaze OrderResponse: serialize then deserialize preserves fields "
   in.submittedAt = "2026-01-07T10:00:02Z";
 
   in.symbol = "AAPL";
-  in.qty = "10";
-  in.filledQty = "10";
+  in.qty = alpaca::Decimal{10};
+  in.filledQty = alpaca::Decimal{10};
 
   in.orderType = "market";
   in.type = alpaca::OrderType::market;
@@ -229,3 +229,20 @@ TEST_CASE("Glaze OrderResponse: missing required fields fails parsing") {
   REQUIRE(ec);
   REQUIRE(ec.ec == glz::error_code::missing_key);
 }
+
+TEST_CASE("Glaze OrderResponseT<Timestamp>: times decode to time points") {
+  alpaca::OrderResponseT<alpaca::Timestamp> r{};
+  auto ec = glz::read_json(r, minimal_order_response_json());
+  REQUIRE(!ec);
+
+  REQUIRE(r.createdAt == *alpaca::Timestamp::Parse("2026-01-07T10:00:00Z"));
+  REQUIRE(r.submittedAt.EpochNanos() - r.createdAt.EpochNanos() ==
+          2'000'000'000);
+  REQUIRE_FALSE(r.filledAt.has_value());
+
+  std::string json;
+  REQUIRE(!glz::write_json(r, json));
+  alpaca::OrderResponseT<alpaca::Timestamp> back{};
+  REQUIRE(!glz::read_json(back, json));
+  REQUIRE(back.updatedAt == r.updatedAt);
+}
@@ -0,0 +1,251 @@
+#include <alpaca/client/orderStateCache.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <expected>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+alpaca::OrderResponse
+MakeOrder(std::string id, std::string status,
+          std::string updatedAt = "2024-01-02T10:00:00Z") {
+  alpaca::OrderResponse o;
+  o.id = id;
+  o.clientOrderID = "c_" + id;
+  o.status = std::move(status);
+  o.updatedAt = std::move(updatedAt);
+  return o;
+}
+
+alpaca::TradeUpdate MakeUpdate(alpaca::TradeUpdateEvent e,
+                               alpaca::OrderResponse o) {
+  alpaca::TradeUpdate u;
+  u.event = e;
+  u.order = std::move(o);
+  return u;
+}
+
+// Stands in for TradingClientT: serves `open` (in submission order) from
+// GetAllOrders, honouring `after` and `limit`, and `byID` from GetOrderByID.
+struct FakeTradingClient {
+  std::vector<alpaca::OrderResponse> open;
+  std::map<std::string, alpaca::OrderResponse> byID;
+  std::vector<alpaca::OrderListParam> listed;
+  std::vector<std::string> fetched;
+
+  std::expected<std::vector<alpaca::OrderResponse>, alpaca::APIError>
+  GetAllOrders(const alpaca::OrderListParam &p) {
+    listed.push_back(p);
+    std::vector<alpaca::OrderResponse> page;
+    for (const auto &o : open) {
+      if (p.limit && page.size() == *p.limit) {
+        break;
+      }
+      if (!p.after || o.submittedAt > *p.after) {
+        page.push_back(o);
+      }
+    }
+    return page;
+  }
+
+  std::expected<alpaca::OrderResponse, alpaca::APIError>
+  GetOrderByID(std::string_view id) {
+    fetched.emplace_back(id);
+    auto it = byID.find(std::string(id));
+    if (it == byID.end()) {
+      return std::unexpected(
+          alpaca::APIError{alpaca::ErrorCode::HTTPCode, "not found"});
+    }
+    return it->second;
+  }
+};
+
+} // namespace
+
+TEST_CASE("OrderStateCache: seeds open orders and indexes both ids") {
+  FakeTradingClient cli;
+  cli.open = {MakeOrder("a", "new"), MakeOrder("b", "partially_filled")};
+  alpaca::OrderStateCache cache;
+
+  auto n = cache.Seed(cli);
+  REQUIRE(n.has_value());
+  REQUIRE(*n == 2);
+  REQUIRE(cli.listed.size() == 1);
+  REQUIRE(cli.listed[0].status == alpaca::OrderStatus::open);
+  REQUIRE(cli.listed[0].limit == 500u);
+
+  REQUIRE(cache.Find("a")->status == "new");
+  REQUIRE(cache.FindByClientID("c_b")->id == "b");
+  REQUIRE(cache.Find("zzz") == nullptr);
+  REQUIRE(cache.FindByClientID("c_zzz") == nullptr);
+}
+
+TEST_CASE("OrderStateCache: trade updates move orders through their life") {
+  alpaca::OrderStateCache cache;
+  using E = alpaca::TradeUpdateEvent;
+
+  cache.Apply(MakeUpdate(E::new_order, MakeOrder("a", "new")));
+  REQUIRE(cache.OpenCount() == 1);
+
+  auto held = cache.Find("a");
+  cache.Apply(MakeUpdate(
+      E::partial_fill,
+      MakeOrder("a", "partially_filled", "2024-01-02T10:00:01Z")));
+  REQUIRE(cache.OpenCount() == 1);
+  REQUIRE(cache.Find("a")->status == "partially_filled");
+  // A pointer taken earlier still shows the state it was taken in.
+  REQUIRE(held->status == "new");
+
+  cache.Apply(
+      MakeUpdate(E::fill, MakeOrder("a", "filled", "2024-01-02T10:00:02Z")));
+  REQUIRE(cache.OpenCount() == 0);
+  REQUIRE(cache.Open().empty());
+  REQUIRE(cache.Find("a")->status == "filled");
+  REQUIRE(cache.Snapshot().size() == 1);
+}
+
+TEST_CASE("OrderStateCache: replace closes the old order, new opens its "
+          "successor") {
+  alpaca::OrderStateCache cache;
+  using E = alpaca::TradeUpdateEvent;
+
+  cache.Apply(MakeUpdate(E::new_order, MakeOrder("a", "new")));
+  auto old = MakeOrder("a", "replaced", "2024-01-02T10:00:01Z");
+  old.replacedBy = "b";
+  cache.Apply(MakeUpdate(E::replaced, old));
+  cache.Apply(MakeUpdate(E::new_order,
+                         MakeOrder("b", "new", "2024-01-02T10:00:01Z")));
+
+  REQUIRE(cache.OpenCount() == 1);
+  REQUIRE(cache.Open().front()->id == "b");
+  REQUIRE(cache.Find("a")->replacedBy == "b");
+}
+
+TEST_CASE("OrderStateCache: seed does not roll back newer stream state") {
+  FakeTradingClient cli;
+  cli.open = {MakeOrder("a", "new", "2024-01-02T10:00:00Z")};
+  alpaca::OrderStateCache cache;
+
+  cache.Apply(MakeUpdate(alpaca::TradeUpdateEvent::canceled,
+                         MakeOrder("a", "canceled", "2024-01-02T10:00:05Z")));
+  REQUIRE(cache.Seed(cli).value() == 0);
+  REQUIRE(cache.Find("a")->status == "canceled");
+}
+
+TEST_CASE("OrderStateCache: reseed fetches orders that closed unseen") {
+  FakeTradingClient cli;
+  cli.open = {MakeOrder("a", "new"), MakeOrder("b", "new")};
+  alpaca::OrderStateCache cache;
+  REQUIRE(cache.Seed(cli).value() == 2);
+
+  // "a" filled while the stream was down.
+  cli.open = {MakeOrder("b", "new")};
+  cli.byID["a"] = MakeOrder("a", "filled", "2024-01-02T10:00:09Z");
+  REQUIRE(cache.Seed(cli).value() == 1);
+  REQUIRE(cli.fetched == std::vector<std::string>{"a"});
+  REQUIRE(cache.Find("a")->status == "filled");
+}
+
+TEST_CASE("OrderStateCache: seed pages through every open order") {
+  FakeTradingClient cli;
+  for (int i = 0; i < 1100; ++i) {
+    auto o = MakeOrder("o" + std::to_string(i), "new");
+    const auto ns = std::to_string(i);
+    o.submittedAt =
+        "2024-01-02T10:00:00." + std::string(9 - ns.size(), '0') + ns + "Z";
+    cli.open.push_back(std::move(o));
+  }
+  alpaca::OrderStateCache cache;
+
+  REQUIRE(cache.Seed(cli).value() == 1100);
+  REQUIRE(cli.listed.size() == 3);
+  REQUIRE(cli.listed[0].direction == alpaca::OrderDirection::asc);
+  REQUIRE_FALSE(cli.listed[0].after.has_value());
+  REQUIRE(cli.listed[1].after == "2024-01-02T10:00:00.000000499Z");
+  REQUIRE(cli.listed[2].after == "2024-01-02T10:00:00.000000999Z");
+}
+
+TEST_CASE("OrderStateCache: one failed lookup does not stop the others") {
+  FakeTradingClient cli;
+  cli.open = {MakeOrder("a", "new"), MakeOrder("b", "new"),
+              MakeOrder("c", "new")};
+  alpaca::OrderStateCache cache;
+  REQUIRE(cache.Seed(cli).value() == 3);
+
+  // All three closed unseen, but "a" cannot be fetched.
+  cli.open.clear();
+  cli.byID["b"] = MakeOrder("b", "filled", "2024-01-02T10:00:09Z");
+  cli.byID["c"] = MakeOrder("c", "canceled", "2024-01-02T10:00:09Z");
+  auto n = cache.Seed(cli);
+  REQUIRE_FALSE(n.has_value());
+  REQUIRE(n.error().code == alpaca::ErrorCode::HTTPCode);
+  REQUIRE(cli.fetched.size() == 3);
+  REQUIRE(cache.Find("b")->status == "filled");
+  REQUIRE(cache.Find("c")->status == "canceled");
+  REQUIRE(cache.OpenCount() == 1);
+}
+
+TEST_CASE("OrderStateCache: seed reports REST errors") {
+  struct Failing {
+    std::expected<std::vector<alpaca::OrderResponse>, alpaca::APIError>
+    GetAllOrders(const alpaca::OrderListParam &) {
+      return std::unexpected(
+          alpaca::APIError{alpaca::ErrorCode::Connection, "down"});
+    }
+    std::expected<alpaca::OrderResponse, alpaca::APIError>
+    GetOrderByID(std::string_view) {
+      return std::unexpected(
+          alpaca::APIError{alpaca::ErrorCode::Connection, "down"});
+    }
+  } cli;
+  alpaca::OrderStateCache cache;
+
+  auto n = cache.Seed(cli);
+  REQUIRE_FALSE(n.has_value());
+  REQUIRE(n.error().code == alpaca::ErrorCode::Connection);
+}
+
+TEST_CASE("OrderStateCache: closed orders beyond the retention are evicted") {
+  alpaca::OrderStateCache cache(2);
+  using E = alpaca::TradeUpdateEvent;
+
+  cache.Apply(MakeUpdate(E::new_order, MakeOrder("open", "new")));
+  for (const auto *id : {"x", "y", "z"}) {
+    cache.Apply(MakeUpdate(E::fill, MakeOrder(id, "filled")));
+  }
+
+  REQUIRE(cache.Size() == 3);
+  REQUIRE(cache.Find("x") == nullptr);
+  REQUIRE(cache.FindByClientID("c_x") == nullptr);
+  REQUIRE(cache.Find("z") != nullptr);
+  REQUIRE(cache.Find("open") != nullptr);
+}
+
+TEST_CASE("OrderStateCache: readers run alongside the writer") {
+  alpaca::OrderStateCache cache;
+  using E = alpaca::TradeUpdateEvent;
+  constexpr int kOrders = 2000;
+
+  std::thread writer([&] {
+    for (int i = 0; i < kOrders; ++i) {
+      const auto id = std::to_string(i);
+      cache.Apply(MakeUpdate(E::new_order, MakeOrder(id, "new")));
+      cache.Apply(MakeUpdate(E::fill, MakeOrder(id, "filled",
+                                                "2024-01-02T10:00:01Z")));
+    }
+  });
+  std::size_t seen = 0;
+  while (seen < 100) {
+    for (const auto &o : cache.Open()) {
+      REQUIRE(o->status == "new");
+    }
+    ++seen;
+  }
+  writer.join();
+
+  REQUIRE(cache.OpenCount() == 0);
+}
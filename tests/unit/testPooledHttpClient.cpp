@@ -0,0 +1,221 @@
+#include <alpaca/client/pooledHttpClient.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// What the fake connections share; reset by each test.
+struct FakeServer {
+  std::atomic<int> opened{0};
+  std::atomic<bool> failNext{false};
+  std::atomic<bool> throwOnOpen{false};
+  std::function<void()> during;
+};
+
+FakeServer &Server() {
+  static FakeServer s;
+  return s;
+}
+
+void ResetServer() {
+  Server().opened = 0;
+  Server().failNext = false;
+  Server().throwOnOpen = false;
+  Server().during = nullptr;
+}
+
+// Stands in for httplib::SSLClient. Every response is {"conn": <n>}, n being
+// the order in which the connection was opened.
+class FakeConnection {
+public:
+  FakeConnection(const std::string &, int) {
+    if (Server().throwOnOpen) {
+      throw std::runtime_error("no TLS context");
+    }
+    id_ = ++Server().opened;
+  }
+
+  void set_keep_alive(bool) {}
+  void set_ca_cert_path(const std::string &) {}
+  bool is_valid() const { return true; }
+  bool is_socket_open() const { return used_; }
+
+  httplib::Result Get(const std::string &, const httplib::Headers &,
+                      httplib::ContentReceiver receive) {
+    return Respond(&receive);
+  }
+  httplib::Result Get(const std::string &, const httplib::Headers &) {
+    return Respond(nullptr);
+  }
+  httplib::Result Post(const std::string &, const httplib::Headers &,
+                       const char *, std::size_t, const std::string &) {
+    return Respond(nullptr);
+  }
+  httplib::Result Delete(const std::string &, const httplib::Headers &) {
+    return Respond(nullptr);
+  }
+  httplib::Result Patch(const std::string &, const httplib::Headers &,
+                        const char *, std::size_t, const std::string &) {
+    return Respond(nullptr);
+  }
+
+private:
+  httplib::Result Respond(httplib::ContentReceiver *receive) {
+    used_ = true;
+    if (Server().during) {
+      Server().during();
+    }
+    if (Server().failNext.exchange(false)) {
+      return httplib::Result(nullptr, httplib::Error::Read);
+    }
+    auto res = std::make_unique<httplib::Response>();
+    res->status = 200;
+    const auto body = "{\"conn\":" + std::to_string(id_) + "}";
+    if (receive) {
+      (*receive)(body.data(), body.size());
+    } else {
+      res->body = body;
+    }
+    return httplib::Result(std::move(res), httplib::Error::Success);
+  }
+
+  int id_{};
+  bool used_{false};
+};
+
+using Pool = alpaca::PooledHttpClientT<FakeConnection>;
+using Reply = std::map<std::string, int>;
+
+int ConnectionOf(Pool &pool) {
+  auto r = pool.Request<Reply>(alpaca::Req::GET, "/v2/clock");
+  REQUIRE(r.has_value());
+  return r->at("conn");
+}
+
+} // namespace
+
+TEST_CASE("PooledHttpClient: a checked-in connection is reused") {
+  ResetServer();
+  Pool pool("unit.test", {});
+
+  REQUIRE(ConnectionOf(pool) == 1);
+  REQUIRE(pool.IdleConnections() == 1);
+  REQUIRE(pool.InFlight() == 0);
+  REQUIRE(ConnectionOf(pool) == 1);
+  REQUIRE(Server().opened == 1);
+
+  auto posted = pool.Request<Reply>(alpaca::Req::POST, "/v2/orders", "{}",
+                                    "application/json");
+  REQUIRE(posted.has_value());
+  REQUIRE(posted->at("conn") == 1);
+}
+
+TEST_CASE("PooledHttpClient: idle connections past the timeout are dropped") {
+  ResetServer();
+  Pool pool("unit.test", {}, {.idleTimeout = std::chrono::milliseconds{0}});
+
+  REQUIRE(ConnectionOf(pool) == 1);
+  REQUIRE(ConnectionOf(pool) == 2);
+}
+
+TEST_CASE("PooledHttpClient: a transport error drops the connection") {
+  ResetServer();
+  Pool pool("unit.test", {});
+  REQUIRE(ConnectionOf(pool) == 1);
+
+  Server().failNext = true;
+  auto r = pool.Request<Reply>(alpaca::Req::GET, "/v2/clock");
+  REQUIRE_FALSE(r.has_value());
+  REQUIRE(r.error().code == alpaca::ErrorCode::Transport);
+  REQUIRE(pool.IdleConnections() == 0);
+  REQUIRE(pool.InFlight() == 0);
+
+  REQUIRE(ConnectionOf(pool) == 2);
+}
+
+TEST_CASE("PooledHttpClient: in-flight and idle counts stay within limits") {
+  ResetServer();
+  Pool pool("unit.test", {}, {.poolSize = 1, .maxInFlight = 2});
+
+  std::atomic<int> active{0};
+  std::atomic<int> peak{0};
+  Server().during = [&] {
+    const int now = ++active;
+    int seen = peak.load();
+    while (now > seen && !peak.compare_exchange_weak(seen, now)) {
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds{5});
+    --active;
+  };
+
+  std::atomic<int> failed{0};
+  std::vector<std::thread> callers;
+  for (int i = 0; i < 6; ++i) {
+    callers.emplace_back([&] {
+      if (!pool.Request<Reply>(alpaca::Req::GET, "/v2/clock")) {
+        ++failed;
+      }
+    });
+  }
+  for (auto &t : callers) {
+    t.join();
+  }
+
+  REQUIRE(failed == 0);
+  REQUIRE(peak <= 2);
+  REQUIRE(pool.InFlight() == 0);
+  // Only poolSize connections are kept; the rest were closed after use.
+  REQUIRE(pool.IdleConnections() == 1);
+}
+
+TEST_CASE("PooledHttpClient: a connection that cannot be built is an error") {
+  ResetServer();
+  Pool pool("unit.test", {}, {.maxInFlight = 1});
+  Server().throwOnOpen = true;
+
+  auto r = pool.Request<Reply>(alpaca::Req::GET, "/v2/clock");
+  REQUIRE_FALSE(r.has_value());
+  REQUIRE(r.error().code == alpaca::ErrorCode::Connection);
+  REQUIRE(pool.InFlight() == 0);
+
+  // The slot was given back, so the single-slot pool still works.
+  Server().throwOnOpen = false;
+  REQUIRE(ConnectionOf(pool) == 1);
+}
+
+TEST_CASE("PooledHttpClient: instrumentation records each phase once") {
+  ResetServer();
+  alpaca::Instrumentation in;
+  Pool pool("unit.test", {});
+  pool.SetInstrumentation(&in);
+
+  ConnectionOf(pool);
+  ConnectionOf(pool);
+  auto order = pool.Request<Reply>(
+      alpaca::Req::DELETE, "/v2/orders/61e69015-8549-4bfd-b9c3-01e75843f47d");
+  REQUIRE(order.has_value());
+
+  const auto snap = in.Snapshot();
+  REQUIRE(snap.at("http.request_cold GET /v2/clock").count == 1);
+  REQUIRE(snap.at("http.request GET /v2/clock").count == 1);
+  REQUIRE(snap.at("http.first_byte GET /v2/clock").count == 2);
+  REQUIRE(snap.at("http.parse GET /v2/clock").count == 2);
+  REQUIRE(snap.at("http.request DELETE /v2/orders/:id").count == 1);
+  REQUIRE_FALSE(snap.contains("http.first_byte DELETE /v2/orders/:id"));
+
+  pool.SetInstrumentation(nullptr);
+  ConnectionOf(pool);
+  REQUIRE(in.Snapshot().at("http.parse GET /v2/clock").count == 2);
+}
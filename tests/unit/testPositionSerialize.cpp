@@ -4,9 +4,16 @@
 #include <glaze/glaze.hpp>
 
 #include <string>
+#include <string_view>
 
 namespace {
 
+alpaca::Decimal dec(std::string_view s) {
+  auto d = alpaca::Decimal::Parse(s);
+  REQUIRE(d.has_value());
+  return *d;
+}
+
 std::string minimal_position_json() {
   return R"json(
   {
@@ -44,22 +51,22 @@ alpaca::Position make_position_full() {
   p.assetClass = "us_equity";
   p.assetMarginable = true;
 
-  p.qty = "10";
-  p.avgEntryPrice = "150.00";
+  p.qty = dec("10");
+  p.avgEntryPrice = dec("150.00");
   p.side = "long";
-  p.marketValue = "1550.00";
-  p.costBasis = "1500.00";
+  p.marketValue = dec("1550.00");
+  p.costBasis = dec("1500.00");
 
-  p.unrealizedPL = "50.00";
-  p.unrealizedPLPC = "0.0333";
-  p.unrealizedIntradayPL = "10.00";
-  p.unrealizedIntradayPLPC = "0.0066";
+  p.unrealizedPL = dec("50.00");
+  p.unrealizedPLPC = dec("0.0333");
+  p.unrealizedIntradayPL = dec("10.00");
+  p.unrealizedIntradayPLPC = dec("0.0066");
 
-  p.currentPrice = "155.00";
-  p.lastDayPrice = "154.00";
-  p.changeToday = "0.0065";
+  p.currentPrice = dec("155.00");
+  p.lastDayPrice = dec("154.00");
+  p.changeToday = dec("0.0065");
 
-  p.qtyAvailable = "10";
+  p.qtyAvailable = dec("10");
   return p;
 }
 
@@ -78,22 +85,22 @@ TEST_CASE("Glaze Position: minimal JSON parses and populates fields") {
   REQUIRE(p.assetClass == "us_equity");
   REQUIRE(p.assetMarginable == true);
 
-  REQUIRE(p.qty == "10");
-  REQUIRE(p.avgEntryPrice == "150.00");
+  REQUIRE(p.qty.ToString() == "10");
+  REQUIRE(p.avgEntryPrice.ToString() == "150.00");
   REQUIRE(p.side == "long");
-  REQUIRE(p.marketValue == "1550.00");
-  REQUIRE(p.costBasis == "1500.00");
+  REQUIRE(p.marketValue.ToString() == "1550.00");
+  REQUIRE(p.costBasis.ToString() == "1500.00");
 
-  REQUIRE(p.unrealizedPL == "50.00");
-  REQUIRE(p.unrealizedPLPC == "0.0333");
-  REQUIRE(p.unrealizedIntradayPL == "10.00");
-  REQUIRE(p.unrealizedIntradayPLPC == "0.0066");
+  REQUIRE(p.unrealizedPL.ToString() == "50.00");
+  REQUIRE(p.unrealizedPLPC.ToString() == "0.0333");
+  REQUIRE(p.unrealizedIntradayPL.ToString() == "10.00");
+  REQUIRE(p.unrealizedIntradayPLPC.ToString() == "0.0066");
 
-  REQUIRE(p.currentPrice == "155.00");
-  REQUIRE(p.lastDayPrice == "154.00");
-  REQUIRE(p.changeToday == "0.0065");
+  REQUIRE(p.currentPrice.ToString() == "155.00");
+  REQUIRE(p.lastDayPrice.ToString() == "154.00");
+  REQUIRE(p.changeToday.ToString() == "0.0065");
 
-  REQUIRE(p.qtyAvailable == "10");
+  REQUIRE(p.qtyAvailable.ToString() == "10");
 }
 
 TEST_CASE(
@@ -0,0 +1,131 @@
+#include <alpaca/client/reconnect.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+TEST_CASE("Reconnector: retries with backoff until restored") {
+  alpaca::ReconnectPolicy policy;
+  policy.baseBackoff = 20ms;
+  policy.maxBackoff = 20ms;
+  alpaca::Reconnector r(policy);
+  std::atomic<int> attempts{0};
+
+  auto attempt = [&] { ++attempts; };
+  REQUIRE(r.Schedule(attempt));
+  REQUIRE(r.Schedule(attempt)); // already queued: no second attempt
+  while (attempts < 1) {
+    std::this_thread::yield();
+  }
+  std::this_thread::sleep_for(30ms);
+  REQUIRE(attempts == 1);
+
+  // The first attempt failed.
+  REQUIRE(r.Schedule(attempt));
+  while (attempts < 2) {
+    std::this_thread::yield();
+  }
+
+  const auto gap = r.Restored();
+  REQUIRE(gap.has_value());
+  REQUIRE(gap->attempts == 2);
+  REQUIRE(gap->duration > 0ns);
+  REQUIRE_FALSE(r.Restored().has_value());
+
+  const auto st = r.Stats();
+  REQUIRE(st.disconnects == 1);
+  REQUIRE(st.reconnects == 1);
+  REQUIRE(st.failedAttempts == 1);
+  REQUIRE(st.maxGap == gap->duration);
+  REQUIRE(st.totalGap == gap->duration);
+}
+
+TEST_CASE("Reconnector: honours maxAttempts and Cancel") {
+  alpaca::ReconnectPolicy policy;
+  policy.baseBackoff = 1ms;
+  policy.maxAttempts = 1;
+  alpaca::Reconnector r(policy);
+  std::atomic<int> attempts{0};
+  auto attempt = [&] { ++attempts; };
+
+  REQUIRE(r.Schedule(attempt));
+  while (attempts < 1) {
+    std::this_thread::yield();
+  }
+  REQUIRE_FALSE(r.Schedule(attempt));
+
+  r.Cancel();
+  REQUIRE_FALSE(r.Schedule(attempt));
+  r.Arm();
+  policy.baseBackoff = 1000ms;
+  r.SetPolicy(policy);
+  REQUIRE(r.Schedule(attempt));
+  r.Cancel(); // drops the queued attempt
+  std::this_thread::sleep_for(5ms);
+  REQUIRE(attempts == 1);
+}
+
+TEST_CASE("Reconnector: only running out of attempts is giving up") {
+  alpaca::ReconnectPolicy policy;
+  policy.baseBackoff = 1ms;
+  policy.maxAttempts = 1;
+  alpaca::Reconnector r(policy);
+  std::atomic<int> attempts{0};
+  auto attempt = [&] { ++attempts; };
+
+  REQUIRE(r.Schedule(attempt));
+  while (attempts < 1) {
+    std::this_thread::yield();
+  }
+  REQUIRE_FALSE(r.Stats().gaveUp);
+  REQUIRE_FALSE(r.Schedule(attempt));
+  REQUIRE(r.Stats().gaveUp);
+
+  // Connecting again starts a fresh budget.
+  r.Arm();
+  REQUIRE_FALSE(r.Stats().gaveUp);
+  REQUIRE(r.Schedule(attempt));
+  while (attempts < 2) {
+    std::this_thread::yield();
+  }
+
+  r.Cancel();
+  REQUIRE_FALSE(r.Schedule(attempt));
+  REQUIRE_FALSE(r.Stats().gaveUp);
+
+  policy.enabled = false;
+  alpaca::Reconnector disabled(policy);
+  REQUIRE_FALSE(disabled.Schedule(attempt));
+  REQUIRE_FALSE(disabled.Stats().gaveUp);
+}
+
+TEST_CASE("Reconnector: Cancel in a socket callback does not wait") {
+  alpaca::ReconnectPolicy policy;
+  policy.baseBackoff = 1ms;
+  alpaca::Reconnector r(policy);
+  std::atomic<bool> running{false};
+  std::atomic<bool> release{false};
+
+  REQUIRE(r.Schedule([&] {
+    running = true;
+    while (!release) {
+      std::this_thread::yield();
+    }
+  }));
+  while (!running) {
+    std::this_thread::yield();
+  }
+  {
+    alpaca::Reconnector::CallbackScope scope(r);
+    r.Cancel(); // would wait for the attempt outside the scope
+  }
+  REQUIRE(r.Cancelled());
+  release = true;
+  r.Cancel();
+  r.Arm();
+  REQUIRE_FALSE(r.Cancelled());
+}
@@ -0,0 +1,170 @@
+#include <alpaca/client/requestScheduler.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <expected>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+namespace {
+
+// Replays a scripted list of HTTP statuses, one per call.
+struct ScriptedHttpClient {
+  std::vector<int> statuses;
+  std::vector<alpaca::Req> calls;
+  std::vector<std::string> bodies;
+
+  template <class T>
+  std::expected<T, alpaca::APIError>
+  Request(alpaca::Req type, const std::string &,
+          std::optional<std::string_view> body = std::nullopt,
+          std::optional<std::string> = std::nullopt) {
+    const auto i = calls.size();
+    calls.push_back(type);
+    bodies.emplace_back(body.value_or(""));
+    const int status = i < statuses.size() ? statuses[i] : 200;
+    if (!alpaca::utils::IsSuccess(status)) {
+      return std::unexpected(
+          alpaca::APIError{alpaca::ErrorCode::HTTPCode, "err", status});
+    }
+    return T{};
+  }
+
+  void SetInstrumentation(alpaca::Instrumentation *) {}
+};
+
+// Fails every call by throwing, as a transport that runs out of memory would.
+struct ThrowingHttpClient {
+  template <class T>
+  std::expected<T, alpaca::APIError>
+  Request(alpaca::Req, const std::string &,
+          std::optional<std::string_view> = std::nullopt,
+          std::optional<std::string> = std::nullopt) {
+    throw std::runtime_error("out of sockets");
+  }
+};
+
+alpaca::RateLimitConfig fast_backoff() {
+  alpaca::RateLimitConfig cfg{};
+  cfg.baseBackoff = std::chrono::milliseconds{1};
+  cfg.maxBackoff = std::chrono::milliseconds{2};
+  return cfg;
+}
+
+} // namespace
+
+TEST_CASE("RequestScheduler: order mutations outrank data reads") {
+  using alpaca::ClassifyRequest;
+  using alpaca::Req;
+  using alpaca::RequestPriority;
+
+  REQUIRE(ClassifyRequest(Req::POST, "/v2/orders") == RequestPriority::High);
+  REQUIRE(ClassifyRequest(Req::DELETE, "/v2/orders/abc") ==
+          RequestPriority::High);
+  REQUIRE(ClassifyRequest(Req::GET, "/v2/orders?status=open") ==
+          RequestPriority::Normal);
+  REQUIRE(ClassifyRequest(Req::GET, "/v2/stocks/bars?symbols=AAPL") ==
+          RequestPriority::Low);
+}
+
+TEST_CASE("ScheduledHttpClient: 429 is retried with backoff until success") {
+  ScriptedHttpClient http{{429, 429, 200}, {}};
+  alpaca::ScheduledHttpClientT<ScriptedHttpClient> cli(std::move(http),
+                                                        fast_backoff());
+
+  auto res = cli.Request<std::monostate>(alpaca::Req::POST, "/v2/orders", "{}",
+                                         "application/json");
+  REQUIRE(res.has_value());
+  REQUIRE(cli.Inner().calls.size() == 3);
+}
+
+TEST_CASE("ScheduledHttpClient: a borrowed body is resent on every retry") {
+  ScriptedHttpClient http{{429, 200}, {}};
+  alpaca::ScheduledHttpClientT<ScriptedHttpClient> cli(std::move(http),
+                                                        fast_backoff());
+
+  const std::string order = R"({"symbol":"AAPL"})";
+  auto res = cli.Request<std::monostate>(alpaca::Req::POST, "/v2/orders",
+                                         std::string_view(order),
+                                         "application/json");
+  REQUIRE(res.has_value());
+  REQUIRE(cli.Inner().bodies == std::vector<std::string>{order, order});
+}
+
+TEST_CASE("ScheduledHttpClient: 5xx is not retried for order submission") {
+  ScriptedHttpClient http{{503, 200}, {}};
+  alpaca::ScheduledHttpClientT<ScriptedHttpClient> cli(std::move(http),
+                                                        fast_backoff());
+
+  auto res = cli.Request<std::monostate>(alpaca::Req::POST, "/v2/orders", "{}",
+                                         "application/json");
+  REQUIRE_FALSE(res.has_value());
+  REQUIRE(res.error().status.value() == 503);
+  REQUIRE(cli.Inner().calls.size() == 1);
+}
+
+TEST_CASE("ScheduledHttpClient: gives up after maxRetries") {
+  ScriptedHttpClient http{{500, 500, 500, 500, 500}, {}};
+  auto cfg = fast_backoff();
+  cfg.maxRetries = 2;
+  alpaca::ScheduledHttpClientT<ScriptedHttpClient> cli(std::move(http), cfg);
+
+  auto res = cli.Request<std::monostate>(alpaca::Req::GET, "/v2/account");
+  REQUIRE_FALSE(res.has_value());
+  REQUIRE(cli.Inner().calls.size() == 3);
+}
+
+TEST_CASE("ScheduledHttpClient: schedule wait is recorded once per request") {
+  ScriptedHttpClient http{{429, 429, 200, 200}, {}};
+  alpaca::ScheduledHttpClientT<ScriptedHttpClient> cli(std::move(http),
+                                                        fast_backoff());
+  alpaca::Instrumentation in;
+  cli.SetInstrumentation(&in);
+
+  REQUIRE(cli.Request<std::monostate>(alpaca::Req::GET, "/v2/account"));
+  REQUIRE(cli.Request<std::monostate>(alpaca::Req::GET, "/v2/account"));
+  REQUIRE(cli.Inner().calls.size() == 4);
+
+  const auto snap = in.Snapshot();
+  const auto &wait = snap.at("http.schedule_wait GET /v2/account");
+  REQUIRE(wait.count == 2);
+  // The first request waited out two backoffs of at least 1ms.
+  REQUIRE(wait.max >= 2'000'000);
+}
+
+TEST_CASE("RequestScheduler: server remaining budget caps local tokens") {
+  alpaca::RequestScheduler sched{};
+  REQUIRE(sched.Tokens() > 100.0);
+
+  sched.Observe(200, 5, std::nullopt);
+  REQUIRE(sched.Tokens() < 6.0);
+}
+
+TEST_CASE("RequestScheduler: a zero rate or burst falls back to the defaults") {
+  alpaca::RateLimitConfig cfg{};
+  cfg.requestsPerMinute = 0;
+  cfg.burst = 0;
+  alpaca::RequestScheduler sched(cfg);
+  REQUIRE(sched.Config().requestsPerMinute == 200.0);
+  REQUIRE(sched.Config().burst == 200);
+
+  // Would never return with an empty bucket that does not refill.
+  sched.Acquire(alpaca::RequestPriority::Low);
+  REQUIRE(sched.Tokens() < 200.0);
+}
+
+TEST_CASE("ScheduledHttpClient: an exception from the transport is an error") {
+  alpaca::ScheduledHttpClientT<ThrowingHttpClient> cli(ThrowingHttpClient{},
+                                                       fast_backoff());
+  const std::string path = "/v2/account";
+  STATIC_REQUIRE(noexcept(cli.Request<std::monostate>(alpaca::Req::GET, path)));
+
+  auto res = cli.Request<std::monostate>(alpaca::Req::GET, path);
+  REQUIRE_FALSE(res.has_value());
+  REQUIRE(res.error().code == alpaca::ErrorCode::Unknown);
+}
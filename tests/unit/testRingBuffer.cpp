@@ -0,0 +1,92 @@
+#include <alpaca/utils/ringBuffer.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <thread>
+
+TEST_CASE("RingBuffer: FIFO order and bounded capacity") {
+  alpaca::RingBuffer<int> r(3);
+  REQUIRE(r.Capacity() == 4);
+
+  for (int i = 0; i < 4; ++i) {
+    REQUIRE(r.TryPush(i));
+  }
+  REQUIRE_FALSE(r.TryPush(4));
+  REQUIRE(r.Size() == 4);
+
+  int v = -1;
+  REQUIRE(r.TryPop(v));
+  REQUIRE(v == 0);
+  REQUIRE(r.TryPush(4));
+
+  for (int want = 1; want <= 4; ++want) {
+    REQUIRE(r.TryPop(v));
+    REQUIRE(v == want);
+  }
+  REQUIRE_FALSE(r.TryPop(v));
+  REQUIRE(r.Size() == 0);
+}
+
+TEST_CASE("RingBuffer: consumer thread sees every value in order") {
+  constexpr std::uint64_t kCount = 200000;
+  alpaca::RingBuffer<std::uint64_t> r(64);
+
+  std::thread producer([&] {
+    for (std::uint64_t i = 0; i < kCount; ++i) {
+      while (!r.TryPush(i)) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  std::uint64_t next = 0;
+  bool ordered = true;
+  while (next < kCount) {
+    std::uint64_t v;
+    if (r.TryPop(v)) {
+      ordered = ordered && v == next;
+      ++next;
+    }
+  }
+  producer.join();
+  REQUIRE(ordered);
+}
+
+TEST_CASE("RingBuffer: producer can evict while the consumer pops") {
+  constexpr std::uint64_t kCount = 200000;
+  alpaca::RingBuffer<std::uint64_t> r(8);
+  std::uint64_t evicted = 0;
+
+  std::thread producer([&] {
+    for (std::uint64_t i = 0; i < kCount; ++i) {
+      std::uint64_t old;
+      while (!r.TryPush(i)) {
+        if (r.TryPop(old)) {
+          ++evicted;
+        }
+      }
+    }
+  });
+
+  std::uint64_t popped = 0;
+  std::uint64_t last = 0;
+  bool increasing = true;
+  std::uint64_t v;
+  while (true) {
+    if (r.TryPop(v)) {
+      increasing = increasing && (popped == 0 || v > last);
+      last = v;
+      ++popped;
+      if (v == kCount - 1) {
+        break;
+      }
+    }
+  }
+  producer.join();
+  while (r.TryPop(v)) {
+    ++popped;
+  }
+  REQUIRE(increasing);
+  REQUIRE(popped + evicted == kCount);
+}
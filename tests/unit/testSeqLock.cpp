@@ -0,0 +1,59 @@
+#include <alpaca/utils/seqLock.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+namespace {
+
+// Readers must never see a half-written value: every field equals `a`.
+struct Wide {
+  std::uint64_t a;
+  std::uint64_t b;
+  std::uint64_t c;
+  std::uint32_t d;
+};
+
+} // namespace
+
+TEST_CASE("SeqLock: starts value-initialized and returns the last store") {
+  alpaca::SeqLock<Wide> s;
+  REQUIRE(s.Load().a == 0);
+  REQUIRE(s.Load().d == 0);
+
+  s.Store({1, 2, 3, 4});
+  const auto v = s.Load();
+  REQUIRE(v.a == 1);
+  REQUIRE(v.b == 2);
+  REQUIRE(v.c == 3);
+  REQUIRE(v.d == 4);
+}
+
+TEST_CASE("SeqLock: readers never see a torn value") {
+  constexpr std::uint64_t kCount = 200000;
+  alpaca::SeqLock<Wide> s;
+  std::atomic<bool> done{false};
+  std::atomic<bool> torn{false};
+
+  std::thread reader([&] {
+    std::uint64_t last = 0;
+    while (!done.load(std::memory_order_acquire)) {
+      const auto v = s.Load();
+      if (v.b != v.a || v.c != v.a || v.d != static_cast<std::uint32_t>(v.a) ||
+          v.a < last) {
+        torn = true;
+      }
+      last = v.a;
+    }
+  });
+  for (std::uint64_t i = 1; i <= kCount; ++i) {
+    s.Store({i, i, i, static_cast<std::uint32_t>(i)});
+  }
+  done.store(true, std::memory_order_release);
+  reader.join();
+
+  REQUIRE_FALSE(torn);
+  REQUIRE(s.Load().a == kCount);
+}
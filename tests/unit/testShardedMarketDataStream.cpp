@@ -0,0 +1,263 @@
+#include <alpaca/client/shardedMarketDataStream.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_string.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
+
+// ── Test doubles ──────────────────────────────────────────────────────────────
+
+namespace {
+
+struct TestEnvironment {
+    std::string GetID()     const { return "TEST_KEY"; }
+    std::string GetSecret() const { return "TEST_SECRET"; }
+    std::string GetStreamDataUrl(const std::string& feed) const {
+        return "wss://stream.test/" + feed;
+    }
+};
+
+struct FakeWsState {
+    std::vector<std::string> sent;
+    alpaca::WsCallbacks      cbs;
+    std::map<std::string, std::string> headers;
+    bool                     connected = false;
+
+    void Inject(const std::string& msg) {
+        if (cbs.onMessage) cbs.onMessage(msg);
+    }
+    void Handshake() {
+        Inject(R"([{"T":"success","msg":"connected"}])");
+        Inject(R"([{"T":"success","msg":"authenticated"}])");
+    }
+};
+
+struct FakeWebSocket {
+    std::shared_ptr<FakeWsState> state = std::make_shared<FakeWsState>();
+
+    void Connect(const std::string& /*url*/, alpaca::WsCallbacks c) {
+        state->cbs       = std::move(c);
+        state->connected = true;
+    }
+    void Disconnect() {
+        state->connected = false;
+        if (state->cbs.onClose) state->cbs.onClose();
+    }
+    void Send(const std::string& m) { state->sent.push_back(m); }
+    void SendBinary(const std::string& m) { state->sent.push_back(m); }
+    void SetHeader(const std::string& name, const std::string& value) {
+        state->headers[name] = value;
+    }
+    bool IsConnected() const { return state->connected; }
+};
+
+using TestStream =
+    alpaca::ShardedMarketDataStreamT<TestEnvironment, FakeWebSocket>;
+
+struct ShardedHandle {
+    std::unique_ptr<TestStream>               stream;
+    std::vector<std::shared_ptr<FakeWsState>> ws;
+};
+
+ShardedHandle MakeSharded(std::size_t shards, alpaca::SymbolTable& table) {
+    ShardedHandle h;
+    h.ws.resize(shards);
+    h.stream = std::make_unique<TestStream>(
+        TestEnvironment{}, shards, [&h](std::size_t i) {
+            FakeWebSocket ws;
+            h.ws[i] = ws.state;
+            return ws;
+        });
+    h.stream->UseSymbolTable(table);
+    return h;
+}
+
+} // namespace
+
+// ── Tests ─────────────────────────────────────────────────────────────────────
+
+TEST_CASE("[ShardedMarketDataStream] symbols are spread evenly and kept together", "[ShardedMarketDataStream]") {
+    alpaca::SymbolTable table;
+    auto h = MakeSharded(3, table);
+
+    alpaca::MarketDataSubscription sub;
+    sub.trades = {"AAPL", "MSFT"};
+    sub.quotes = {"AAPL", "MSFT", "NVDA", "TSLA"};
+    h.stream->Connect(sub, {});
+
+    REQUIRE(h.stream->ShardCount() == 3);
+    REQUIRE(h.stream->ShardOf("AAPL") == 0u);
+    REQUIRE(h.stream->ShardOf("MSFT") == 1u);
+    REQUIRE(h.stream->ShardOf("NVDA") == 2u);
+    REQUIRE(h.stream->ShardOf("TSLA") == 0u);
+    REQUIRE_FALSE(h.stream->ShardOf("SPY").has_value());
+
+    for (auto& ws : h.ws) {
+        REQUIRE(ws->connected);
+        ws->Handshake();
+    }
+    REQUIRE(h.ws[0]->sent.back() ==
+            R"({"action":"subscribe","trades":["AAPL"],"quotes":["AAPL","TSLA"],"bars":[]})");
+    REQUIRE(h.ws[1]->sent.back() ==
+            R"({"action":"subscribe","trades":["MSFT"],"quotes":["MSFT"],"bars":[]})");
+    REQUIRE(h.ws[2]->sent.back() ==
+            R"({"action":"subscribe","trades":[],"quotes":["NVDA"],"bars":[]})");
+
+    const auto health = h.stream->Health();
+    REQUIRE(health.size() == 3);
+    REQUIRE(health[0].symbols == 2);
+    REQUIRE(health[1].symbols == 1);
+    REQUIRE(health[0].connected);
+    REQUIRE(health[0].frames == 2);
+}
+
+TEST_CASE("[ShardedMarketDataStream] queued events from all shards merge into one Drain", "[ShardedMarketDataStream]") {
+    alpaca::SymbolTable table;
+    auto h = MakeSharded(2, table);
+
+    alpaca::MarketDataSubscription sub;
+    sub.trades = {"AAPL", "MSFT"};
+    alpaca::MarketDataDelivery delivery;
+    delivery.mode = alpaca::DeliveryMode::Queued;
+    h.stream->Connect(sub, {}, delivery);
+
+    h.ws[0]->Inject(R"([{"T":"t","S":"AAPL","p":1,"s":1,"t":"2024-01-02T10:00:00Z"},)"
+                    R"({"T":"t","S":"AAPL","p":2,"s":1,"t":"2024-01-02T10:00:01Z"}])");
+    h.ws[1]->Inject(R"([{"T":"t","S":"MSFT","p":3,"s":1,"t":"2024-01-02T10:00:00Z"}])");
+
+    std::vector<std::string> seen;
+    const auto n = h.stream->Drain([&](const alpaca::MarketDataEvent& e) {
+        const auto& t = std::get<alpaca::TradeEvent>(e);
+        seen.emplace_back(table.Name(t.symbolId));
+    });
+    REQUIRE(n == 3);
+    REQUIRE(std::count(seen.begin(), seen.end(), "AAPL") == 2);
+    REQUIRE(std::count(seen.begin(), seen.end(), "MSFT") == 1);
+    REQUIRE_FALSE(h.stream->Poll().has_value());
+
+    const auto health = h.stream->Health();
+    REQUIRE(health[0].delivery.enqueued == 2);
+    REQUIRE(health[1].delivery.enqueued == 1);
+}
+
+TEST_CASE("[ShardedMarketDataStream] Subscribe wakes idle shards and Unsubscribe routes to the owner", "[ShardedMarketDataStream]") {
+    alpaca::SymbolTable table;
+    auto h = MakeSharded(2, table);
+
+    alpaca::MarketDataSubscription sub;
+    sub.quotes = {"AAPL"};
+    h.stream->Connect(sub, {});
+    REQUIRE(h.ws[0]->connected);
+    REQUIRE_FALSE(h.ws[1]->connected);
+    h.ws[0]->Handshake();
+
+    alpaca::MarketDataSubscription add;
+    add.quotes = {"AAPL", "MSFT"};
+    REQUIRE(h.stream->Subscribe(add));
+    REQUIRE(h.ws[1]->connected);
+    REQUIRE(h.ws[0]->sent.size() == 2); // AAPL was already there
+    h.ws[1]->Handshake();
+    REQUIRE_THAT(h.ws[1]->sent.back(),
+                 Catch::Matchers::ContainsSubstring(R"("quotes":["MSFT"])"));
+
+    alpaca::MarketDataSubscription remove;
+    remove.quotes = {"MSFT"};
+    REQUIRE(h.stream->Unsubscribe(remove));
+    REQUIRE(h.ws[1]->sent.back() ==
+            R"({"action":"unsubscribe","trades":[],"quotes":["MSFT"],"bars":[]})");
+    REQUIRE(h.ws[0]->sent.size() == 2);
+    REQUIRE_FALSE(h.stream->ShardOf("MSFT").has_value());
+    REQUIRE(h.stream->Health()[1].symbols == 0);
+}
+
+TEST_CASE("[ShardedMarketDataStream] a shard over the connection limit folds into the live ones", "[ShardedMarketDataStream]") {
+    alpaca::SymbolTable table;
+    auto h = MakeSharded(4, table);
+
+    std::vector<alpaca::APIError> errors;
+    alpaca::MarketDataCallbacks cbs;
+    cbs.onError = [&](const alpaca::APIError& e) { errors.push_back(e); };
+
+    alpaca::MarketDataSubscription sub;
+    sub.quotes = {"AAPL", "MSFT"};
+    h.stream->Connect(sub, cbs);
+    REQUIRE(h.stream->ShardOf("MSFT") == 1u);
+    h.ws[0]->Handshake();
+    h.ws[1]->Inject(R"([{"T":"success","msg":"connected"}])");
+    h.ws[1]->Inject(R"([{"T":"error","code":406,"msg":"connection limit exceeded"}])");
+
+    REQUIRE(errors.size() == 1);
+    REQUIRE(errors[0].status == alpaca::kConnectionLimitExceeded);
+    REQUIRE(h.stream->ShardOf("MSFT") == 0u);
+    REQUIRE(h.ws[0]->sent.back() ==
+            R"({"action":"subscribe","trades":[],"quotes":["MSFT"],"bars":[]})");
+
+    // The server closes the refused connection; it is not retried.
+    h.ws[1]->connected = false;
+    h.ws[1]->cbs.onClose();
+
+    // New symbols stay on the shard that is up instead of opening more.
+    alpaca::MarketDataSubscription add;
+    add.quotes = {"NVDA", "TSLA"};
+    REQUIRE(h.stream->Subscribe(add));
+    REQUIRE(h.stream->ShardOf("NVDA") == 0u);
+    REQUIRE(h.stream->ShardOf("TSLA") == 0u);
+    REQUIRE_FALSE(h.ws[2]->connected);
+    REQUIRE_FALSE(h.ws[3]->connected);
+
+    const auto health = h.stream->Health();
+    REQUIRE(health[0].symbols == 4);
+    REQUIRE(health[1].symbols == 0);
+    REQUIRE(health[1].refused);
+    REQUIRE_FALSE(health[1].connected);
+    REQUIRE(health[1].reconnects.disconnects == 0);
+    REQUIRE_FALSE(health[0].refused);
+}
+
+TEST_CASE("[ShardedMarketDataStream] the only shard up keeps its symbols when refused", "[ShardedMarketDataStream]") {
+    alpaca::SymbolTable table;
+    auto h = MakeSharded(2, table);
+
+    alpaca::MarketDataSubscription sub;
+    sub.quotes = {"AAPL"};
+    h.stream->Connect(sub, {});
+    h.ws[0]->Inject(R"([{"T":"error","code":406,"msg":"connection limit exceeded"}])");
+
+    REQUIRE(h.stream->ShardOf("AAPL") == 0u);
+    REQUIRE_FALSE(h.stream->Health()[0].refused);
+}
+
+TEST_CASE("[ShardedMarketDataStream] Connect after Disconnect retries refused shards", "[ShardedMarketDataStream]") {
+    alpaca::SymbolTable table;
+    auto h = MakeSharded(2, table);
+    alpaca::ReconnectPolicy policy;
+    policy.baseBackoff = std::chrono::seconds(10);
+    h.stream->SetReconnectPolicy(policy);
+
+    alpaca::MarketDataSubscription sub;
+    sub.quotes = {"AAPL", "MSFT"};
+    h.stream->Connect(sub, {});
+    h.ws[0]->Handshake();
+    h.ws[1]->Inject(R"([{"T":"error","code":406,"msg":"connection limit exceeded"}])");
+    REQUIRE(h.stream->Health()[1].refused);
+
+    h.stream->Disconnect();
+    h.stream->Connect(sub, {});
+
+    // Both shards take symbols again.
+    REQUIRE(h.stream->ShardOf("AAPL") == 0u);
+    REQUIRE(h.stream->ShardOf("MSFT") == 1u);
+    REQUIRE(h.ws[1]->connected);
+    REQUIRE_FALSE(h.stream->Health()[1].refused);
+
+    // And the shard reconnects after a drop with the caller's policy.
+    h.ws[1]->connected = false;
+    h.ws[1]->cbs.onClose();
+    REQUIRE(h.stream->Health()[1].reconnects.disconnects == 1);
+}
@@ -0,0 +1,66 @@
+#include <alpaca/utils/symbolTable.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("SymbolTable: ids are dense, stable and reversible") {
+  alpaca::SymbolTable t;
+
+  const auto aapl = t.Intern("AAPL");
+  const auto msft = t.Intern("MSFT");
+  REQUIRE(aapl == 0);
+  REQUIRE(msft == 1);
+  REQUIRE(t.Intern(std::string("AAPL")) == aapl);
+  REQUIRE(t.Size() == 2);
+
+  REQUIRE(t.Name(aapl) == "AAPL");
+  REQUIRE(t.Name(msft) == "MSFT");
+  REQUIRE(t.Name(7).empty());
+  REQUIRE(t.Name(alpaca::kNoSymbol).empty());
+
+  REQUIRE(t.Find("MSFT") == msft);
+  REQUIRE_FALSE(t.Find("TSLA").has_value());
+}
+
+TEST_CASE("SymbolTable: names survive growth past one storage chunk") {
+  alpaca::SymbolTable t;
+  for (int i = 0; i < 3000; ++i) {
+    REQUIRE(t.Intern("S" + std::to_string(i)) ==
+            static_cast<alpaca::SymbolId>(i));
+  }
+  REQUIRE(t.Name(0) == "S0");
+  REQUIRE(t.Name(1024) == "S1024");
+  REQUIRE(t.Name(2999) == "S2999");
+  REQUIRE(t.Find("S2048") == 2048u);
+}
+
+TEST_CASE("SymbolTable: concurrent interning agrees on one id per symbol") {
+  alpaca::SymbolTable t;
+  constexpr int kThreads = 4;
+  constexpr int kSymbols = 500;
+  std::vector<std::vector<alpaca::SymbolId>> seen(kThreads);
+
+  {
+    std::vector<std::jthread> threads;
+    for (int i = 0; i < kThreads; ++i) {
+      threads.emplace_back([&, i] {
+        alpaca::SymbolCache cache{t};
+        for (int s = 0; s < kSymbols; ++s) {
+          seen[i].push_back(cache.Intern("SYM" + std::to_string(s)));
+        }
+      });
+    }
+  }
+
+  REQUIRE(t.Size() == kSymbols);
+  for (int i = 1; i < kThreads; ++i) {
+    REQUIRE(seen[i] == seen[0]);
+  }
+  std::set<alpaca::SymbolId> unique(seen[0].begin(), seen[0].end());
+  REQUIRE(unique.size() == kSymbols);
+  REQUIRE(*unique.rbegin() == kSymbols - 1);
+}
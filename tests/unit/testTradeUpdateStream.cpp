@@ -3,8 +3,11 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_string.hpp>
 
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 // ── Test doubles ──────────────────────────────────────────────────────────────
@@ -21,10 +24,20 @@ struct FakeWsState {
     std::vector<std::string> sent;
     alpaca::WsCallbacks      cbs;
     bool                     connected = false;
+    std::atomic<int>         connects{0};
 
     void Inject(const std::string& msg) {
         if (cbs.onMessage) cbs.onMessage(msg);
     }
+    // As a WebSocketClient does, with the time the frame was received.
+    void InjectAt(const std::string& msg, const alpaca::ReceiveTime& at) {
+        if (cbs.onTimedMessage) cbs.onTimedMessage(msg, at);
+    }
+    // Connection lost without the stream asking for it.
+    void Drop() {
+        connected = false;
+        if (cbs.onClose) cbs.onClose();
+    }
     void SimulateOpen() {
         if (cbs.onOpen) cbs.onOpen();
     }
@@ -37,6 +50,7 @@ struct FakeWebSocket {
         state->cbs       = std::move(c);
         state->connected = true;
         state->SimulateOpen(); // trade stream sends auth on open
+        ++state->connects;
     }
     void Disconnect() {
         state->connected = false;
@@ -164,6 +178,67 @@ TEST_CASE("[TradeUpdateStream] unknown event string maps to unknown", "[TradeUpd
     REQUIRE(received.event == alpaca::TradeUpdateEvent::unknown);
 }
 
+TEST_CASE("[TradeUpdateStream] execution fields are decoded", "[TradeUpdateStream]") {
+    TestEnvironment env;
+    alpaca::TradeUpdate received;
+    alpaca::TradeUpdateCallbacks cbs;
+    cbs.onUpdate = [&](alpaca::TradeUpdate u) { received = std::move(u); };
+
+    auto [stream, ws] = MakeStream(env, cbs);
+    ws->Inject(R"({"stream":"authorization","data":{"status":"authorized"}})");
+    ws->Inject(std::string(
+        R"({"stream":"trade_updates","data":{"event":"fill","at":"2024-01-02T10:00:03Z",)"
+        R"("price":"179.08","qty":"2","position_qty":"5","order":)")
+               + std::string(kMinimalOrder) + "}}");
+
+    REQUIRE(received.price == alpaca::Decimal::Parse("179.08"));
+    REQUIRE(received.qty == alpaca::Decimal::Parse("2"));
+    REQUIRE(received.positionQty == alpaca::Decimal::Parse("5"));
+}
+
+TEST_CASE("[TradeUpdateStream] onLeanUpdate alone decodes the fill subset", "[TradeUpdateStream]") {
+    TestEnvironment env;
+    alpaca::LeanTradeUpdate received;
+    int fired = 0;
+    alpaca::TradeUpdateCallbacks cbs;
+    cbs.onLeanUpdate = [&](alpaca::LeanTradeUpdate u) { received = std::move(u); ++fired; };
+
+    auto [stream, ws] = MakeStream(env, cbs);
+    ws->Inject(R"({"stream":"authorization","data":{"status":"authorized"}})");
+    ws->Inject(R"({"stream":"trade_updates","data":{"event":"partial_fill",)"
+               R"("at":"2024-01-02T10:00:03Z","price":"10.5","qty":"3","order":{)"
+               R"("id":"order_1","client_order_id":"c_1","symbol":"AAPL",)"
+               R"("filled_qty":"3","filled_avg_price":"10.5","status":"partially_filled",)"
+               R"("legs":null,"side":"buy","type":"limit"}}})");
+
+    REQUIRE(fired == 1);
+    REQUIRE(received.event == alpaca::TradeUpdateEvent::partial_fill);
+    REQUIRE(received.at == "2024-01-02T10:00:03Z");
+    REQUIRE(received.orderID == "order_1");
+    REQUIRE(received.clientOrderID == "c_1");
+    REQUIRE(received.symbol == "AAPL");
+    REQUIRE(received.status == "partially_filled");
+    REQUIRE(received.filledQty == alpaca::Decimal::Parse("3"));
+    REQUIRE(received.filledAvgPrice == alpaca::Decimal::Parse("10.5"));
+    REQUIRE(received.price == alpaca::Decimal::Parse("10.5"));
+    REQUIRE(!received.positionQty);
+}
+
+TEST_CASE("[TradeUpdateStream] onLeanUpdate fires before onUpdate", "[TradeUpdateStream]") {
+    TestEnvironment env;
+    std::vector<std::string> order;
+    alpaca::TradeUpdateCallbacks cbs;
+    cbs.onLeanUpdate = [&](alpaca::LeanTradeUpdate u) { order.push_back("lean:" + u.orderID); };
+    cbs.onUpdate = [&](alpaca::TradeUpdate u) { order.push_back("full:" + u.order.id); };
+
+    auto [stream, ws] = MakeStream(env, cbs);
+    ws->Inject(R"({"stream":"authorization","data":{"status":"authorized"}})");
+    ws->Inject(std::string(R"({"stream":"trade_updates","data":{"event":"fill","at":"2024-01-02T10:00:03Z","order":)")
+               + std::string(kMinimalOrder) + "}}");
+
+    REQUIRE(order == std::vector<std::string>{"lean:order_1", "full:order_1"});
+}
+
 TEST_CASE("[TradeUpdateStream] unauthorized auth fires onError", "[TradeUpdateStream]") {
     TestEnvironment env;
     alpaca::APIError received{alpaca::ErrorCode::Unknown, ""};
@@ -177,3 +252,85 @@ TEST_CASE("[TradeUpdateStream] unauthorized auth fires onError", "[TradeUpdateSt
     REQUIRE(fired);
     REQUIRE(received.code == alpaca::ErrorCode::Connection);
 }
+
+TEST_CASE("[TradeUpdateStream] reconnects, re-authenticates and listens again", "[TradeUpdateStream]") {
+    TestEnvironment env;
+    std::vector<alpaca::ReconnectGap> gaps;
+    alpaca::TradeUpdateCallbacks cbs;
+    cbs.onReconnected = [&](const alpaca::ReconnectGap& g) { gaps.push_back(g); };
+
+    FakeWebSocket fakeWs;
+    auto ws = fakeWs.state;
+    TestStream stream(env, std::move(fakeWs));
+    alpaca::ReconnectPolicy policy;
+    policy.baseBackoff = std::chrono::milliseconds{1};
+    stream.SetReconnectPolicy(policy);
+    stream.Connect(cbs);
+    ws->Inject(R"({"stream":"authorization","data":{"status":"authorized"}})");
+    ws->Inject(R"({"stream":"listening","data":{"streams":["trade_updates"]}})");
+    REQUIRE(gaps.empty());
+
+    ws->Drop();
+    while (ws->connects < 2) std::this_thread::yield();
+
+    REQUIRE(ws->sent.size() == 3);
+    REQUIRE_THAT(ws->sent[2], Catch::Matchers::ContainsSubstring("auth"));
+    ws->Inject(R"({"stream":"authorization","data":{"status":"authorized"}})");
+    REQUIRE_THAT(ws->sent.back(), Catch::Matchers::ContainsSubstring("listen"));
+    ws->Inject(R"({"stream":"listening","data":{"streams":["trade_updates"]}})");
+
+    REQUIRE(gaps.size() == 1);
+    REQUIRE(gaps[0].attempts == 1);
+    REQUIRE(stream.GetReconnectStats().reconnects == 1);
+}
+
+TEST_CASE("[TradeUpdateStream] receive time reaches both callbacks and the lag histograms", "[TradeUpdateStream]") {
+    using namespace std::chrono_literals;
+    TestEnvironment env;
+    alpaca::TradeUpdate update;
+    alpaca::LeanTradeUpdate lean;
+    alpaca::TradeUpdateCallbacks cbs;
+    cbs.onUpdate = [&](alpaca::TradeUpdate u) { update = std::move(u); };
+    cbs.onLeanUpdate = [&](alpaca::LeanTradeUpdate u) { lean = std::move(u); };
+
+    FakeWebSocket fakeWs;
+    auto ws = fakeWs.state;
+    TestStream stream(env, std::move(fakeWs));
+    alpaca::Instrumentation in;
+    stream.SetInstrumentation(&in);
+    stream.Connect(cbs);
+    ws->Inject(R"({"stream":"authorization","data":{"status":"authorized"}})");
+
+    // Received 2ms after the server's "at".
+    alpaca::ReceiveTime at;
+    at.mono = std::chrono::steady_clock::now();
+    at.wall = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
+        alpaca::Timestamp::Parse("2024-01-02T10:00:03Z")->time + 2ms);
+    ws->InjectAt(std::string(R"({"stream":"trade_updates","data":{"event":"fill","at":"2024-01-02T10:00:03Z","order":)")
+                 + std::string(kMinimalOrder) + "}}", at);
+
+    REQUIRE(update.received.mono == at.mono);
+    REQUIRE(update.received.wall == at.wall);
+    REQUIRE(lean.received.mono == at.mono);
+
+    auto snap = in.Snapshot();
+    REQUIRE(snap.at("tu.lag.exchange").count == 1);
+    REQUIRE(snap.at("tu.lag.exchange").max >= 2000000);
+    REQUIRE(snap.at("tu.lag.exchange").max <= 2000000 + 2000000 / 32);
+    REQUIRE(snap.at("tu.lag.callback").count == 1);
+}
+
+TEST_CASE("[TradeUpdateStream] destroying a connected stream closes the socket first", "[TradeUpdateStream]") {
+    TestEnvironment env;
+    int disconnects = 0;
+    alpaca::TradeUpdateCallbacks cbs;
+    cbs.onDisconnected = [&] { ++disconnects; };
+
+    auto [stream, ws] = MakeStream(env, cbs);
+    ws->Inject(R"({"stream":"authorization","data":{"status":"authorized"}})");
+    stream.reset();
+
+    REQUIRE_FALSE(ws->connected);
+    REQUIRE(disconnects == 1);
+    REQUIRE(ws->connects == 1);
+}
@@ -129,6 +129,25 @@ struct FakeHttpClient {
 
     return obj;
   }
+
+  // GET only; decodes into `out` like HttpClient::RequestInto.
+  template <class T>
+  std::expected<std::monostate, alpaca::APIError>
+  RequestInto(T &out, alpaca::Req type, const std::string &path,
+              std::optional<std::string> = std::nullopt,
+              std::optional<std::string> = std::nullopt) {
+    REQUIRE(type == alpaca::Req::GET);
+    auto raw = Get(path, headers);
+    if (!raw) {
+      return std::unexpected(
+          alpaca::APIError{alpaca::ErrorCode::Transport, raw.error()});
+    }
+    if (auto err = glz::read_json(out, raw->body)) {
+      return std::unexpected(alpaca::APIError{
+          alpaca::ErrorCode::JSONParsing, glz::format_error(err, raw->body)});
+    }
+    return std::monostate{};
+  }
 };
 
 std::string account_json_minimal() {
@@ -264,6 +283,65 @@ TEST_CASE("TradingClient.SubmitOrder: sends wire JSON (qty/notional), not "
   REQUIRE(res->clientOrderID == "client_1");
 }
 
+TEST_CASE("TradingClient.SubmitOrder: template sends the rendered body") {
+  TestEnvironment env{};
+  FakeHttpClient http{env.GetBaseUrl(), env.GetAuthHeaders()};
+
+  http.onPost = [&](std::string_view path, const TestEnvironment::Headers &,
+                    std::string_view body, std::string_view contentType) {
+    REQUIRE(path == "/v2/orders");
+    REQUIRE(contentType == "application/json");
+    REQUIRE(body.find("\"symbol\":\"AAPL\"") != std::string_view::npos);
+    REQUIRE(body.find("\"qty\":\"5\"") != std::string_view::npos);
+    REQUIRE(body.find("\"client_order_id\":\"q-7\"") !=
+            std::string_view::npos);
+    return FakeHttpClient::Response{200, order_response_json_minimal()};
+  };
+
+  alpaca::TradingClientT<TestEnvironment, FakeHttpClient> cli(env,
+                                                              std::move(http));
+
+  alpaca::OrderRequestParam base{};
+  base.symbol = "AAPL";
+  base.side = alpaca::OrderSide::sell;
+  base.type = alpaca::OrderType::limit;
+  base.timeInForce = alpaca::OrderTimeInForce::day;
+  auto tmpl = alpaca::OrderTemplate::Make(base);
+  REQUIRE(tmpl.has_value());
+
+  alpaca::OrderPatch patch;
+  patch.qty = 5;
+  patch.limitPrice = 101;
+  patch.clientOrderID = "q-7";
+  auto res = cli.SubmitOrder(*tmpl, patch);
+  REQUIRE(res.has_value());
+  REQUIRE(res->id == "order_1");
+}
+
+TEST_CASE("TradingClient.GetAllOrders: decodes into a caller-owned vector") {
+  TestEnvironment env{};
+  FakeHttpClient http{env.GetBaseUrl(), env.GetAuthHeaders()};
+
+  http.onGet = [&](std::string_view path, const TestEnvironment::Headers &) {
+    REQUIRE(path == "/v2/orders?status=open");
+    return FakeHttpClient::Response{
+        200, "[" + order_response_json_minimal() + "]"};
+  };
+
+  alpaca::TradingClientT<TestEnvironment, FakeHttpClient> cli(env,
+                                                              std::move(http));
+
+  std::vector<alpaca::OrderResponse> orders(3);
+  alpaca::OrderListParam p;
+  p.status = alpaca::OrderStatus::open;
+  for (int poll = 0; poll < 2; ++poll) {
+    auto res = cli.GetAllOrders(orders, p);
+    REQUIRE(res.has_value());
+    REQUIRE(orders.size() == 1);
+    REQUIRE(orders[0].id == "order_1");
+  }
+}
+
 TEST_CASE(
     "TradingClient.GetAllOpenPositions: success parses Positions via glaze") {
   TestEnvironment env{};